@@ -96,6 +96,7 @@ GetConsoleKeyboardLayoutNameW(
 
 #define CONSOLE_REGISTRY_COPYCOLOR                      L"CopyColor"
 #define CONSOLE_REGISTRY_USEDX                          L"UseDx"
+#define CONSOLE_REGISTRY_SCROLLBACKCOMPRESSION          L"ScrollbackCompressionThreshold"
 
 #define CONSOLE_REGISTRY_DEFAULTFOREGROUND             L"DefaultForeground"
 #define CONSOLE_REGISTRY_DEFAULTBACKGROUND             L"DefaultBackground"
@@ -186,6 +186,13 @@ bool ATTR_ROW::SetAttrToEnd(const UINT iStart, const TextAttribute attr)
 {
     size_t const length = _cchRowWidth - iStart;
 
+    // Writing cell by cell with the same color keeps landing in the final run.
+    // If it already covers everything from iStart on, there's nothing to do.
+    if (!_list.empty() && _list.back().GetLength() >= length && _list.back().GetAttributes() == attr)
+    {
+        return true;
+    }
+
     const TextAttributeRun run(length, attr);
     return SUCCEEDED(InsertAttrRuns({ &run, 1 }, iStart, _cchRowWidth - 1, _cchRowWidth));
 }
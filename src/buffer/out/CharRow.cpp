@@ -19,6 +19,8 @@ CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
     _wrapForced{ false },
     _doubleBytePadded{ false },
     _data(rowWidth, value_type()),
+    _compressed{},
+    _unicodeStorage{},
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
@@ -75,7 +77,7 @@ bool CharRow::WasDoubleBytePadded() const noexcept
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return IsCompressed() ? _compressed.front() : _data.size();
 }
 
 // Routine Description:
@@ -84,13 +86,24 @@ size_t CharRow::size() const noexcept
 // - sRowWidth - The width of the row.
 // Return Value:
 // - <none>
+// Note: a compressed row stays compressed, as a row of blanks. Its cells are
+//   only allocated again once something is written to it.
 void CharRow::Reset() noexcept
 {
+    if (IsCompressed())
+    {
+        // Only the width and the (now zero) attribute count are kept, which never grows the string.
+        til::at(_compressed, 1) = 0;
+        _compressed.resize(2);
+    }
+
     for (auto& cell : _data)
     {
         cell.Reset();
     }
 
+    _unicodeStorage.Reset();
+
     _wrapForced = false;
     _doubleBytePadded = false;
 }
@@ -105,31 +118,49 @@ void CharRow::Reset() noexcept
 {
     try
     {
+        Decompress();
+
+        const bool shrinking = newSize < _data.size();
+
         const value_type insertVals;
         _data.resize(newSize, insertVals);
+
+        // glyphs stored for the columns we just cut off are no longer reachable
+        if (shrinking && !_unicodeStorage.empty())
+        {
+            _CompactUnicodeStorage();
+        }
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
-typename CharRow::iterator CharRow::begin() noexcept
+// Note: the cells of a compressed row are restored first, which may throw
+typename CharRow::iterator CharRow::begin()
 {
+    Decompress();
     return _data.begin();
 }
 
+// Note: a compressed row has no cells to iterate, read it through GlyphAt and DbcsAttrAt instead
 typename CharRow::const_iterator CharRow::cbegin() const noexcept
 {
+    FAIL_FAST_IF(IsCompressed());
     return _data.cbegin();
 }
 
-typename CharRow::iterator CharRow::end() noexcept
+// Note: the cells of a compressed row are restored first, which may throw
+typename CharRow::iterator CharRow::end()
 {
+    Decompress();
     return _data.end();
 }
 
+// Note: a compressed row has no cells to iterate, read it through GlyphAt and DbcsAttrAt instead
 typename CharRow::const_iterator CharRow::cend() const noexcept
 {
+    FAIL_FAST_IF(IsCompressed());
     return _data.cend();
 }
 
@@ -141,6 +172,19 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const
 {
+    if (IsCompressed())
+    {
+        const auto chars = _CompressedChars();
+        for (size_t i = 0; i < chars.size(); ++i)
+        {
+            if (!_CompressedIsSpace(i))
+            {
+                return i;
+            }
+        }
+        return size();
+    }
+
     std::vector<value_type>::const_iterator it = _data.cbegin();
     while (it != _data.cend() && it->IsSpace())
     {
@@ -157,6 +201,19 @@ size_t CharRow::MeasureLeft() const
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const noexcept
 {
+    if (IsCompressed())
+    {
+        // Everything after the stored characters is blank.
+        for (auto i = _CompressedChars().size(); i > 0; --i)
+        {
+            if (!_CompressedIsSpace(i - 1))
+            {
+                return i;
+            }
+        }
+        return 0;
+    }
+
     std::vector<value_type>::const_reverse_iterator it = _data.crbegin();
     while (it != _data.crend() && it->IsSpace())
     {
@@ -167,6 +224,7 @@ size_t CharRow::MeasureRight() const noexcept
 
 void CharRow::ClearCell(const size_t column)
 {
+    Decompress();
     _data.at(column).Reset();
 }
 
@@ -178,6 +236,11 @@ void CharRow::ClearCell(const size_t column)
 // - True if there is valid text in this row. False otherwise.
 bool CharRow::ContainsText() const noexcept
 {
+    if (IsCompressed())
+    {
+        return MeasureRight() != 0;
+    }
+
     for (const value_type& cell : _data)
     {
         if (!cell.IsSpace())
@@ -195,8 +258,13 @@ bool CharRow::ContainsText() const noexcept
 // Return Value:
 // - the attribute
 // Note: will throw exception if column is out of bounds
-const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
+DbcsAttribute CharRow::DbcsAttrAt(const size_t column) const
 {
+    if (IsCompressed())
+    {
+        THROW_HR_IF(E_INVALIDARG, column >= size());
+        return _CompressedAttrAt(column);
+    }
     return _data.at(column).DbcsAttr();
 }
 
@@ -209,6 +277,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 {
+    Decompress();
     return _data.at(column).DbcsAttr();
 }
 
@@ -221,6 +290,7 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
+    Decompress();
     _data.at(column).EraseChars();
 }
 
@@ -233,7 +303,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= size());
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -246,6 +316,7 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
+    Decompress();
     THROW_HR_IF(E_INVALIDARG, column >= _data.size());
     return { *this, column };
 }
@@ -253,9 +324,9 @@ CharRow::reference CharRow::GlyphAt(const size_t column)
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(size());
 
-    for (size_t i = 0; i < _data.size(); ++i)
+    for (size_t i = 0; i < size(); ++i)
     {
         const auto glyph = GlyphAt(i);
         if (!DbcsAttrAt(i).IsTrailing())
@@ -271,23 +342,238 @@ std::wstring CharRow::GetText() const
 
 UnicodeStorage& CharRow::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
 }
 
 const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _unicodeStorage;
+}
+
+// Routine Description:
+// - Encodes the cells of the row into a compact form and releases the cells.
+// - Trailing default cells are dropped, and only cells with a non-default dbcs attribute
+//   keep their attribute. Scrollback that has long since scrolled by is mostly plain text,
+//   so this is typically a small fraction of the full width row.
+// - Does nothing if the row is already compressed.
+void CharRow::Compress()
+{
+    if (IsCompressed())
+    {
+        return;
+    }
+
+    if (!_unicodeStorage.empty())
+    {
+        _CompactUnicodeStorage();
+    }
+
+    // Drop everything after the last cell that isn't a plain blank.
+    auto last = _data.size();
+    while (last > 0 && _data.at(last - 1).IsSpace() && _data.at(last - 1).DbcsAttr().IsSingle())
+    {
+        --last;
+    }
+
+    std::wstring encoded;
+    encoded.push_back(gsl::narrow<wchar_t>(_data.size()));
+    encoded.push_back(0);
+    for (size_t i = 0; i < last; ++i)
+    {
+        const auto& attr = _data.at(i).DbcsAttr();
+        if (!attr.IsSingle() || attr.IsGlyphStored())
+        {
+            wchar_t flags = 0;
+            WI_SetFlagIf(flags, 0x1, attr.IsLeading());
+            WI_SetFlagIf(flags, 0x2, attr.IsTrailing());
+            WI_SetFlagIf(flags, 0x4, attr.IsGlyphStored());
+
+            encoded.push_back(gsl::narrow_cast<wchar_t>(i));
+            encoded.push_back(flags);
+            ++encoded.at(1);
+        }
+    }
+    for (size_t i = 0; i < last; ++i)
+    {
+        encoded.push_back(_data.at(i).Char());
+    }
+    encoded.shrink_to_fit();
+
+    _compressed = std::move(encoded);
+    std::vector<value_type>{}.swap(_data);
+}
+
+// Routine Description:
+// - Restores the cells of a row compressed with Compress.
+// - Does nothing if the row isn't compressed.
+void CharRow::Decompress()
+{
+    if (!IsCompressed())
+    {
+        return;
+    }
+
+    std::vector<value_type> data(_compressed.at(0), value_type());
+
+    const size_t attrCount = _compressed.at(1);
+    const auto attrs = std::wstring_view{ _compressed }.substr(2, attrCount * 2);
+    const auto chars = std::wstring_view{ _compressed }.substr(2 + attrCount * 2);
+
+    for (size_t i = 0; i < chars.size(); ++i)
+    {
+        data.at(i).Char() = chars.at(i);
+    }
+    for (size_t i = 0; i < attrs.size(); i += 2)
+    {
+        data.at(attrs.at(i)).DbcsAttr() = _DecodeAttr(attrs.at(i + 1));
+    }
+
+    _data.swap(data);
+    _compressed.clear();
+    _compressed.shrink_to_fit();
+}
+
+bool CharRow::IsCompressed() const noexcept
+{
+    return !_compressed.empty();
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - turns the flags kept for a cell of a compressed row back into its dbcs attribute
 // Arguments:
-// - column - the column to generate the key for
+// - flags - the flags written by Compress
 // Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - the dbcs attribute of the cell
+DbcsAttribute CharRow::_DecodeAttr(const wchar_t flags) noexcept
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    DbcsAttribute attr;
+    if (WI_IsFlagSet(flags, 0x1))
+    {
+        attr.SetLeading();
+    }
+    else if (WI_IsFlagSet(flags, 0x2))
+    {
+        attr.SetTrailing();
+    }
+    attr.SetGlyphStored(WI_IsFlagSet(flags, 0x4));
+    return attr;
+}
+
+// Routine Description:
+// - the characters kept by a compressed row. every column past them is a plain blank.
+std::wstring_view CharRow::_CompressedChars() const noexcept
+{
+    const size_t attrCount = til::at(_compressed, 1);
+    return std::wstring_view{ _compressed }.substr(2 + attrCount * 2);
+}
+
+// Routine Description:
+// - reads the character field of a cell of a compressed row without restoring the cells
+// Arguments:
+// - column - the column to read, which must be within the row
+// Return Value:
+// - the character of the cell, or the key of its glyph if the glyph is stored
+const wchar_t& CharRow::_CompressedCharAt(const size_t column) const noexcept
+{
+    static constexpr wchar_t blank = UNICODE_SPACE;
+
+    const auto chars = _CompressedChars();
+    return column < chars.size() ? til::at(chars, column) : blank;
+}
+
+// Routine Description:
+// - reads the dbcs attribute of a cell of a compressed row without restoring the cells
+// Arguments:
+// - column - the column to read
+// Return Value:
+// - the dbcs attribute of the cell
+DbcsAttribute CharRow::_CompressedAttrAt(const size_t column) const noexcept
+{
+    // The (column, flags) pairs are kept in column order.
+    const size_t attrCount = til::at(_compressed, 1);
+    size_t low = 0;
+    size_t high = attrCount;
+    while (low < high)
+    {
+        const auto middle = low + (high - low) / 2;
+        const size_t middleColumn = til::at(_compressed, 2 + middle * 2);
+        if (middleColumn == column)
+        {
+            return _DecodeAttr(til::at(_compressed, 3 + middle * 2));
+        }
+        else if (middleColumn < column)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return {};
+}
+
+// Routine Description:
+// - tells whether a cell of a compressed row is blank, like CharRowCell::IsSpace
+// Arguments:
+// - column - the column to check
+// Return Value:
+// - true if the cell holds a space and no stored glyph
+bool CharRow::_CompressedIsSpace(const size_t column) const noexcept
+{
+    return _CompressedCharAt(column) == UNICODE_SPACE && !_CompressedAttrAt(column).IsGlyphStored();
+}
+
+// Routine Description:
+// - stores a glyph that doesn't fit in a single cell and points the cell at it
+// Arguments:
+// - column - the column the glyph is written to
+// - chars - the glyph data to store
+// Note: will throw exception if column is out of bounds or the storage is full
+void CharRow::_StoreGlyph(const size_t column, const std::wstring_view chars)
+{
+    auto& cell = _data.at(column);
+
+    // Whatever the cell held before is being overwritten, so it doesn't need to survive a compaction.
+    cell.DbcsAttr().SetGlyphStored(false);
+
+    if (_unicodeStorage.NeedsCompaction(chars))
+    {
+        _CompactUnicodeStorage();
+    }
+
+    cell.Char() = _unicodeStorage.StoreGlyph(chars);
+    cell.DbcsAttr().SetGlyphStored(true);
+}
+
+// Routine Description:
+// - drops glyphs that are no longer referenced by any cell from the storage
+//   and re-keys the cells that still reference one.
+void CharRow::_CompactUnicodeStorage()
+{
+    UnicodeStorage compacted;
+    std::vector<UnicodeStorage::key_type> keys;
+
+    // Build the new storage first so that the cells are left untouched if we fail.
+    for (const auto& cell : _data)
+    {
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            keys.push_back(compacted.StoreGlyph(_unicodeStorage.GetText(cell.Char())));
+        }
+    }
+
+    auto key = keys.cbegin();
+    for (auto& cell : _data)
+    {
+        if (cell.DbcsAttr().IsGlyphStored())
+        {
+            cell.Char() = *key++;
+        }
+    }
+
+    compacted.MarkCompacted();
+    _unicodeStorage = std::move(compacted);
 }
 
 // Routine Description:
@@ -298,3 +584,59 @@ void CharRow::UpdateParent(ROW* const pParent) noexcept
 {
     _pParent = FAIL_FAST_IF_NULL(pParent);
 }
+
+// Routine Description:
+// - exchanges the contents of two char rows. each keeps its parent pointer,
+//   since that belongs to the ROW the char row is embedded in, not to the text.
+// Arguments:
+// - a, b - the char rows to exchange
+void swap(CharRow& a, CharRow& b) noexcept
+{
+    using std::swap;
+    swap(a._wrapForced, b._wrapForced);
+    swap(a._doubleBytePadded, b._doubleBytePadded);
+    swap(a._data, b._data);
+    swap(a._compressed, b._compressed);
+    swap(a._unicodeStorage, b._unicodeStorage);
+}
+
+// Routine Description:
+// - compares two rows cell by cell. glyphs kept in the unicode storage are compared by
+//   their text since the same glyph may be stored under different keys in each row.
+bool operator==(const CharRow& a, const CharRow& b)
+{
+    if (a.IsCompressed() || b.IsCompressed())
+    {
+        auto hotA = a;
+        auto hotB = b;
+        hotA.Decompress();
+        hotB.Decompress();
+        return hotA == hotB;
+    }
+
+    if (a._wrapForced != b._wrapForced ||
+        a._doubleBytePadded != b._doubleBytePadded ||
+        a._data.size() != b._data.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < a._data.size(); ++i)
+    {
+        const auto& cellA = a._data[i];
+        const auto& cellB = b._data[i];
+        if (cellA.DbcsAttr().IsGlyphStored() && cellB.DbcsAttr().IsGlyphStored())
+        {
+            if (!(cellA.DbcsAttr() == cellB.DbcsAttr()) ||
+                a._unicodeStorage.GetText(cellA.Char()) != b._unicodeStorage.GetText(cellB.Char()))
+            {
+                return false;
+            }
+        }
+        else if (!(cellA == cellB))
+        {
+            return false;
+        }
+    }
+    return true;
+}
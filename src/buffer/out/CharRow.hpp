@@ -59,7 +59,7 @@ public:
     size_t MeasureRight() const noexcept;
     void ClearCell(const size_t column);
     bool ContainsText() const noexcept;
-    const DbcsAttribute& DbcsAttrAt(const size_t column) const;
+    DbcsAttribute DbcsAttrAt(const size_t column) const;
     DbcsAttribute& DbcsAttrAt(const size_t column);
     void ClearGlyph(const size_t column);
     std::wstring GetText() const;
@@ -69,20 +69,26 @@ public:
     reference GlyphAt(const size_t column);
 
     // iterators
-    iterator begin() noexcept;
+    iterator begin();
     const_iterator cbegin() const noexcept;
 
-    iterator end() noexcept;
+    iterator end();
     const_iterator cend() const noexcept;
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
+
+    // cold scrollback. the const accessors read a compressed row as it is, everything that
+    // can change a cell restores the cells first.
+    void Compress();
+    void Decompress();
+    bool IsCompressed() const noexcept;
 
     void UpdateParent(ROW* const pParent) noexcept;
 
     friend CharRowCellReference;
-    friend constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept;
+    friend bool operator==(const CharRow& a, const CharRow& b);
+    friend void swap(CharRow& a, CharRow& b) noexcept;
 
 protected:
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
@@ -94,16 +100,29 @@ protected:
     // storage for glyph data and dbcs attributes
     std::vector<value_type> _data;
 
+    // compact form of _data while the row is compressed, empty otherwise. holds the row width,
+    // the count and list of non-default dbcs attributes (column, flags) and then the
+    // characters of the row trimmed after the last non-default cell.
+    std::wstring _compressed;
+
+    // storage for glyphs that don't fit in a single cell. cells holding one of these
+    // keep the glyph's storage key in place of their character.
+    UnicodeStorage _unicodeStorage;
+
     // ROW that this CharRow belongs to
     ROW* _pParent;
+
+    void _StoreGlyph(const size_t column, const std::wstring_view chars);
+    void _CompactUnicodeStorage();
+
+    static DbcsAttribute _DecodeAttr(const wchar_t flags) noexcept;
+    std::wstring_view _CompressedChars() const noexcept;
+    const wchar_t& _CompressedCharAt(const size_t column) const noexcept;
+    DbcsAttribute _CompressedAttrAt(const size_t column) const noexcept;
+    bool _CompressedIsSpace(const size_t column) const noexcept;
 };
 
-constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
-{
-    return (a._wrapForced == b._wrapForced &&
-            a._doubleBytePadded == b._doubleBytePadded &&
-            a._data == b._data);
-}
+bool operator==(const CharRow& a, const CharRow& b);
 
 template<typename InputIt1, typename InputIt2>
 void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow::iterator outIt)
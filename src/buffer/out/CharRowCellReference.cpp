@@ -19,10 +19,7 @@ void CharRowCellReference::operator=(const std::wstring_view chars)
     }
     else
     {
-        auto& storage = _parent.GetUnicodeStorage();
-        const auto key = _parent.GetStorageKey(_index);
-        storage.StoreGlyph(key, { chars.cbegin(), chars.cend() });
-        _cellData().DbcsAttr().SetGlyphStored(true);
+        _parent._StoreGlyph(_index, chars);
     }
 }
 
@@ -53,21 +50,39 @@ const CharRowCell& CharRowCellReference::_cellData() const
     return _parent._data.at(_index);
 }
 
+// Routine Description:
+// - The character field of the referenced cell, read without restoring the
+//   cells of a compressed row
+// Return Value:
+// - ref to the character, or to the key of the glyph if it's stored
+const wchar_t& CharRowCellReference::_char() const
+{
+    return _parent.IsCompressed() ? _parent._CompressedCharAt(_index) : _cellData().Char();
+}
+
+// Routine Description:
+// - The dbcs attribute of the referenced cell, read without restoring the
+//   cells of a compressed row
+// Return Value:
+// - the dbcs attribute
+DbcsAttribute CharRowCellReference::_dbcsAttr() const
+{
+    return _parent.IsCompressed() ? _parent._CompressedAttrAt(_index) : _cellData().DbcsAttr();
+}
+
 // Routine Description:
 // - the glyph data of the referenced cell
 // Return Value:
 // - the glyph data
 std::wstring_view CharRowCellReference::_glyphData() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
+    if (_dbcsAttr().IsGlyphStored())
     {
-        const auto& text = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
-
-        return { text.data(), text.size() };
+        return _parent.GetUnicodeStorage().GetText(_char());
     }
     else
     {
-        return { &_cellData().Char(), 1 };
+        return { &_char(), 1 };
     }
 }
 
@@ -77,14 +92,7 @@ std::wstring_view CharRowCellReference::_glyphData() const
 // - iterator of the glyph data
 CharRowCellReference::const_iterator CharRowCellReference::begin() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
-    {
-        return _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index)).data();
-    }
-    else
-    {
-        return &_cellData().Char();
-    }
+    return _glyphData().data();
 }
 
 // Routine Description:
@@ -96,21 +104,14 @@ CharRowCellReference::const_iterator CharRowCellReference::begin() const
 // TODO GH 2672: eliminate using pointers raw as begin/end markers in this class
 CharRowCellReference::const_iterator CharRowCellReference::end() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
-    {
-        const auto& chars = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
-        return chars.data() + chars.size();
-    }
-    else
-    {
-        return &_cellData().Char() + 1;
-    }
+    const auto chars = _glyphData();
+    return chars.data() + chars.size();
 }
 #pragma warning(pop)
 
 bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& glyph)
 {
-    const DbcsAttribute& dbcsAttr = ref._cellData().DbcsAttr();
+    const auto dbcsAttr = ref._dbcsAttr();
     if (glyph.size() == 1 && dbcsAttr.IsGlyphStored())
     {
         return false;
@@ -121,12 +122,12 @@ bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& gly
     }
     else if (glyph.size() == 1 && !dbcsAttr.IsGlyphStored())
     {
-        return ref._cellData().Char() == glyph.front();
+        return ref._char() == glyph.front();
     }
     else
     {
-        const auto& chars = ref._parent.GetUnicodeStorage().GetText(ref._parent.GetStorageKey(ref._index));
-        return chars == glyph;
+        const auto chars = ref._glyphData();
+        return std::equal(chars.cbegin(), chars.cend(), glyph.cbegin(), glyph.cend());
     }
 }
 
@@ -56,6 +56,9 @@ private:
     CharRowCell& _cellData();
     const CharRowCell& _cellData() const;
 
+    const wchar_t& _char() const;
+    DbcsAttribute _dbcsAttr() const;
+
     std::wstring_view _glyphData() const;
 };
 
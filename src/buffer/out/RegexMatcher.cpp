@@ -0,0 +1,833 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "RegexMatcher.hpp"
+
+// Patterns can't nest groups deeper than this, so parsing can't run out of stack.
+static constexpr size_t s_MaxDepth = 100;
+// Bounded repeats are expanded into copies, so their counts and the whole NFA are capped.
+// The NFA holds the pattern both forwards and reversed.
+static constexpr size_t s_MaxRepeat = 1000;
+static constexpr size_t s_MaxNodes = 20000;
+// Once a DFA has built this many states, they're thrown away and built again as needed.
+static constexpr size_t s_MaxDfaStates = 4096;
+
+// Routine Description:
+// - Adds the ranges of one of the \d, \w or \s escapes to a character class.
+// Arguments:
+// - ranges - The ranges of the class
+// - wch - The (lower case) letter of the escape
+// Return Value:
+// - True if it was one of those escapes. False otherwise.
+static bool _AppendShorthandRanges(std::vector<std::pair<wchar_t, wchar_t>>& ranges, const wchar_t wch)
+{
+    switch (wch)
+    {
+    case L'd':
+        ranges.emplace_back(L'0', L'9');
+        return true;
+    case L'w':
+        ranges.emplace_back(L'0', L'9');
+        ranges.emplace_back(L'A', L'Z');
+        ranges.emplace_back(L'_', L'_');
+        ranges.emplace_back(L'a', L'z');
+        return true;
+    case L's':
+        ranges.emplace_back(L'\t', L'\r');
+        ranges.emplace_back(L' ', L' ');
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - Gets the character an escape other than a class shorthand stands for.
+// Arguments:
+// - wch - The character following the backslash
+// Return Value:
+// - The character to match. Throws for unknown escapes of letters and digits.
+static wchar_t _UnescapeChar(const wchar_t wch)
+{
+    switch (wch)
+    {
+    case L't':
+        return L'\t';
+    case L'n':
+        return L'\n';
+    case L'r':
+        return L'\r';
+    default:
+        // Leave letters and digits free for escapes that may be supported later.
+        THROW_HR_IF(E_INVALIDARG, ::iswalnum(wch));
+        return wch;
+    }
+}
+
+// Routine Description:
+// - Compiles a pattern.
+// Arguments:
+// - pattern - The regular expression
+// - caseInsensitive - Whether the text the matcher is given has been folded
+//   to lower case, so the pattern has to be folded the same way.
+// - Throws E_INVALIDARG if the pattern is malformed or too big.
+RegexMatcher::RegexMatcher(const std::wstring_view pattern, const bool caseInsensitive) :
+    _caseInsensitive(caseInsensitive)
+{
+    size_t pos = 0;
+    const auto term = _ParseAlternation(pattern, pos, 0);
+
+    // The only thing that stops the outermost alternation early is an unbalanced ')'.
+    THROW_HR_IF(E_INVALIDARG, pos != pattern.size());
+
+    const auto match = _AddNode(NodeKind::Match);
+    auto fragment = _Compile(term);
+    _Patch(fragment, match);
+    _anchored.start = fragment.start;
+
+    fragment = _Compile(_Reverse(term));
+    _Patch(fragment, match);
+    _reversed.start = fragment.start;
+    _reversed.unanchored = true;
+}
+
+// Routine Description:
+// - Finds every offset of the line that a match starts at, looking at each
+//   character once, from the end of the line backwards.
+// - This ignores where cells start and counts empty matches, so it may mark
+//   an offset where LongestMatchAt then finds nothing, but it never misses an
+//   offset where a match starts.
+// Arguments:
+// - line - The text to search
+// - starts - Receives one entry per offset of the line plus one for its end,
+//   true where a match starts.
+// Return Value:
+// - True if the pattern matches somewhere. False otherwise.
+bool RegexMatcher::FindMatchStarts(const std::wstring_view line, std::vector<bool>& starts)
+{
+    starts.assign(line.size() + 1, false);
+
+    bool found = false;
+    auto state = _Start(_reversed, true);
+    for (auto i = line.size();; i--)
+    {
+        // The end of the reversed text is the start of the line.
+        const auto& current = til::at(_reversed.states, state);
+        if (i == 0 ? current.acceptingAtEnd : current.accepting)
+        {
+            starts.at(i) = true;
+            found = true;
+        }
+        if (i == 0)
+        {
+            return found;
+        }
+        state = _Step(_reversed, state, til::at(line, i - 1));
+    }
+}
+
+// Routine Description:
+// - Finds the longest match that starts at the given offset of the line.
+// Arguments:
+// - line - The text to search
+// - start - The offset the match has to start at
+// - boundaries - One entry per offset of the line plus one for its end. A match
+//   may only end at offsets that are true.
+// Return Value:
+// - The offset the longest non-empty match ends at, or npos if there is none.
+size_t RegexMatcher::LongestMatchAt(const std::wstring_view line, const size_t start, const std::vector<bool>& boundaries)
+{
+    size_t longest = std::wstring_view::npos;
+    auto state = _Start(_anchored, start == 0);
+    for (auto i = start; i <= line.size(); i++)
+    {
+        const auto& current = til::at(_anchored.states, state);
+        if (i > start && boundaries.at(i) && (i == line.size() ? current.acceptingAtEnd : current.accepting))
+        {
+            longest = i;
+        }
+        if (i == line.size() || current.nodes.empty())
+        {
+            break;
+        }
+        state = _Step(_anchored, state, til::at(line, i));
+    }
+    return longest;
+}
+
+// Routine Description:
+// - Reverses a parsed pattern, so it matches the reversed text of whatever
+//   the original matches. The anchors trade places.
+// Arguments:
+// - term - The term
+// Return Value:
+// - The reversed term.
+RegexMatcher::Term RegexMatcher::_Reverse(const Term& term)
+{
+    Term reversed{ term.kind, term.ch, term.charClass, {}, term.min, term.max };
+    switch (term.kind)
+    {
+    case TermKind::LineStart:
+        reversed.kind = TermKind::LineEnd;
+        break;
+    case TermKind::LineEnd:
+        reversed.kind = TermKind::LineStart;
+        break;
+    case TermKind::Sequence:
+        std::transform(term.terms.crbegin(), term.terms.crend(), std::back_inserter(reversed.terms), _Reverse);
+        break;
+    case TermKind::Group:
+        std::transform(term.terms.cbegin(), term.terms.cend(), std::back_inserter(reversed.terms), _Reverse);
+        break;
+    default:
+        break;
+    }
+    return reversed;
+}
+
+// Routine Description:
+// - Parses alternatives separated by '|', up to the end of the pattern or a ')'.
+// Arguments:
+// - pattern - The regular expression
+// - pos - The offset to parse from. Updated to where parsing stopped.
+// - depth - How many groups this one is nested in
+// Return Value:
+// - A group of the alternatives.
+RegexMatcher::Term RegexMatcher::_ParseAlternation(const std::wstring_view pattern, size_t& pos, const size_t depth)
+{
+    THROW_HR_IF(E_INVALIDARG, depth > s_MaxDepth);
+
+    Term group{ TermKind::Group };
+    group.terms.push_back(_ParseSequence(pattern, pos, depth));
+    while (pos < pattern.size() && til::at(pattern, pos) == L'|')
+    {
+        pos++;
+        group.terms.push_back(_ParseSequence(pattern, pos, depth));
+    }
+    return group;
+}
+
+// Routine Description:
+// - Parses the quantified atoms of one alternative.
+// Arguments:
+// - pattern - The regular expression
+// - pos - The offset to parse from. Updated to where parsing stopped.
+// - depth - How many groups this one is nested in
+// Return Value:
+// - A sequence of the atoms.
+RegexMatcher::Term RegexMatcher::_ParseSequence(const std::wstring_view pattern, size_t& pos, const size_t depth)
+{
+    Term sequence{ TermKind::Sequence };
+    while (pos < pattern.size() && til::at(pattern, pos) != L'|' && til::at(pattern, pos) != L')')
+    {
+        auto atom = _ParseAtom(pattern, pos, depth);
+        _ParseQuantifier(pattern, pos, atom);
+        sequence.terms.push_back(std::move(atom));
+    }
+    return sequence;
+}
+
+// Routine Description:
+// - Parses a single character, class, anchor or group.
+// Arguments:
+// - pattern - The regular expression
+// - pos - The offset to parse from. Updated to where parsing stopped.
+// - depth - How many groups this one is nested in
+// Return Value:
+// - The atom.
+RegexMatcher::Term RegexMatcher::_ParseAtom(const std::wstring_view pattern, size_t& pos, const size_t depth)
+{
+    const auto wch = til::at(pattern, pos++);
+    switch (wch)
+    {
+    case L'(':
+    {
+        // Groups don't capture, so (?: ) is just another way to write one.
+        if (pattern.substr(pos, 2) == L"?:")
+        {
+            pos += 2;
+        }
+        auto group = _ParseAlternation(pattern, pos, depth + 1);
+        THROW_HR_IF(E_INVALIDARG, pos >= pattern.size() || til::at(pattern, pos) != L')');
+        pos++;
+        return group;
+    }
+    case L'.':
+        return Term{ TermKind::Any };
+    case L'^':
+        return Term{ TermKind::LineStart };
+    case L'$':
+        return Term{ TermKind::LineEnd };
+    case L'[':
+    {
+        Term term{ TermKind::Class };
+        term.charClass = _ParseClass(pattern, pos);
+        return term;
+    }
+    case L'*':
+    case L'+':
+    case L'?':
+    case L'{':
+        // There's nothing for the quantifier to repeat.
+        THROW_HR(E_INVALIDARG);
+    case L'\\':
+    {
+        THROW_HR_IF(E_INVALIDARG, pos >= pattern.size());
+        const auto escaped = til::at(pattern, pos++);
+        const auto shorthand = _AddShorthandClass(escaped);
+        if (shorthand != s_None)
+        {
+            Term term{ TermKind::Class };
+            term.charClass = shorthand;
+            return term;
+        }
+        Term term{ TermKind::Char };
+        term.ch = _FoldCase(_UnescapeChar(escaped));
+        return term;
+    }
+    default:
+    {
+        Term term{ TermKind::Char };
+        term.ch = _FoldCase(wch);
+        return term;
+    }
+    }
+}
+
+// Routine Description:
+// - Parses the quantifier following an atom, if there is one.
+// Arguments:
+// - pattern - The regular expression
+// - pos - The offset to parse from. Updated to where parsing stopped.
+// - term - The atom the quantifier applies to. Updated with the repeat counts.
+void RegexMatcher::_ParseQuantifier(const std::wstring_view pattern, size_t& pos, Term& term)
+{
+    if (pos >= pattern.size())
+    {
+        return;
+    }
+
+    const auto parseCount = [&]() {
+        size_t count = 0;
+        const auto first = pos;
+        while (pos < pattern.size() && ::iswdigit(til::at(pattern, pos)))
+        {
+            count = count * 10 + (til::at(pattern, pos++) - L'0');
+            THROW_HR_IF(E_INVALIDARG, count > s_MaxRepeat);
+        }
+        return pos == first ? s_None : count;
+    };
+
+    switch (til::at(pattern, pos))
+    {
+    case L'*':
+        term.min = 0;
+        term.max = s_None;
+        pos++;
+        break;
+    case L'+':
+        term.min = 1;
+        term.max = s_None;
+        pos++;
+        break;
+    case L'?':
+        term.min = 0;
+        term.max = 1;
+        pos++;
+        break;
+    case L'{':
+        pos++;
+        term.min = parseCount();
+        THROW_HR_IF(E_INVALIDARG, term.min == s_None || pos >= pattern.size());
+        term.max = term.min;
+        if (til::at(pattern, pos) == L',')
+        {
+            pos++;
+            term.max = parseCount();
+        }
+        THROW_HR_IF(E_INVALIDARG, pos >= pattern.size() || til::at(pattern, pos) != L'}');
+        THROW_HR_IF(E_INVALIDARG, term.max < term.min);
+        pos++;
+        break;
+    default:
+        return;
+    }
+
+    // Lazy and possessive quantifiers mean nothing to a longest match, so they aren't accepted.
+    if (pos < pattern.size())
+    {
+        const auto next = til::at(pattern, pos);
+        THROW_HR_IF(E_INVALIDARG, next == L'*' || next == L'+' || next == L'?' || next == L'{');
+    }
+}
+
+// Routine Description:
+// - Parses a character class. The opening '[' has already been consumed.
+// Arguments:
+// - pattern - The regular expression
+// - pos - The offset to parse from. Updated to just past the closing ']'.
+// Return Value:
+// - The index of the class.
+size_t RegexMatcher::_ParseClass(const std::wstring_view pattern, size_t& pos)
+{
+    CharClass charClass{};
+    if (pos < pattern.size() && til::at(pattern, pos) == L'^')
+    {
+        charClass.negated = true;
+        pos++;
+    }
+
+    // Reads one member of the class, or returns false for a shorthand that was added already.
+    const auto parseChar = [&](wchar_t& wch) {
+        THROW_HR_IF(E_INVALIDARG, pos >= pattern.size());
+        wch = til::at(pattern, pos++);
+        if (wch == L'\\')
+        {
+            THROW_HR_IF(E_INVALIDARG, pos >= pattern.size());
+            const auto escaped = til::at(pattern, pos++);
+            if (_AppendShorthandRanges(charClass.ranges, escaped))
+            {
+                return false;
+            }
+            wch = _UnescapeChar(escaped);
+        }
+        return true;
+    };
+
+    // A ']' right at the start is a member rather than the end of the class.
+    for (auto first = true;; first = false)
+    {
+        THROW_HR_IF(E_INVALIDARG, pos >= pattern.size());
+        if (til::at(pattern, pos) == L']' && !first)
+        {
+            pos++;
+            break;
+        }
+
+        wchar_t low;
+        if (!parseChar(low))
+        {
+            continue;
+        }
+
+        wchar_t high = low;
+        if (pos + 1 < pattern.size() && til::at(pattern, pos) == L'-' && til::at(pattern, pos + 1) != L']')
+        {
+            pos++;
+            THROW_HR_IF(E_INVALIDARG, !parseChar(high) || high < low);
+        }
+        charClass.ranges.emplace_back(low, high);
+    }
+
+    _classes.push_back(std::move(charClass));
+    return _classes.size() - 1;
+}
+
+// Routine Description:
+// - Adds the class for one of the \d \D \w \W \s \S escapes.
+// Arguments:
+// - wch - The character following the backslash
+// Return Value:
+// - The index of the class, or s_None if it isn't one of those escapes.
+size_t RegexMatcher::_AddShorthandClass(const wchar_t wch)
+{
+    CharClass charClass{};
+    if (!_AppendShorthandRanges(charClass.ranges, ::towlower(wch)))
+    {
+        return s_None;
+    }
+    charClass.negated = ::iswupper(wch) != 0;
+    _classes.push_back(std::move(charClass));
+    return _classes.size() - 1;
+}
+
+// Routine Description:
+// - Folds a character of the pattern the same way the text is folded.
+// Arguments:
+// - wch - The character
+// Return Value:
+// - The character to compare with the text.
+wchar_t RegexMatcher::_FoldCase(const wchar_t wch) const noexcept
+{
+    return _caseInsensitive ? ::towlower(wch) : wch;
+}
+
+// Routine Description:
+// - Compiles a term with its quantifier into NFA nodes.
+// - Bounded repeats are expanded: a{2,4} is compiled as aaa?a?.
+// Arguments:
+// - term - The term
+// Return Value:
+// - The fragment the term was compiled into.
+RegexMatcher::Fragment RegexMatcher::_Compile(const Term& term)
+{
+    if (term.min == 1 && term.max == 1)
+    {
+        return _CompileOnce(term);
+    }
+
+    std::optional<Fragment> result;
+    const auto append = [&](Fragment&& fragment) {
+        if (result.has_value())
+        {
+            _Patch(*result, fragment.start);
+            result->exits = std::move(fragment.exits);
+        }
+        else
+        {
+            result = std::move(fragment);
+        }
+    };
+
+    for (size_t i = 0; i < term.min; i++)
+    {
+        append(_CompileOnce(term));
+    }
+
+    if (term.max == s_None)
+    {
+        // Loop back to a split that either runs the term again or leaves.
+        auto body = _CompileOnce(term);
+        const auto split = _AddNode(NodeKind::Split);
+        til::at(_nodes, split).next = body.start;
+        _Patch(body, split);
+        append(Fragment{ split, { { split, true } } });
+    }
+    else
+    {
+        for (auto i = term.min; i < term.max; i++)
+        {
+            auto body = _CompileOnce(term);
+            const auto split = _AddNode(NodeKind::Split);
+            til::at(_nodes, split).next = body.start;
+            body.exits.emplace_back(split, true);
+            body.start = split;
+            append(std::move(body));
+        }
+    }
+
+    if (!result.has_value())
+    {
+        // a{0} matches nothing but the empty string.
+        const auto jump = _AddNode(NodeKind::Jump);
+        return Fragment{ jump, { { jump, false } } };
+    }
+    return std::move(*result);
+}
+
+// Routine Description:
+// - Compiles a term into NFA nodes, ignoring its quantifier.
+// Arguments:
+// - term - The term
+// Return Value:
+// - The fragment the term was compiled into.
+RegexMatcher::Fragment RegexMatcher::_CompileOnce(const Term& term)
+{
+    const auto single = [this](const NodeKind kind, const wchar_t ch = 0, const size_t charClass = 0) {
+        const auto node = _AddNode(kind, ch, charClass);
+        return Fragment{ node, { { node, false } } };
+    };
+
+    switch (term.kind)
+    {
+    case TermKind::Char:
+        return single(NodeKind::Char, term.ch);
+    case TermKind::Any:
+        return single(NodeKind::Any);
+    case TermKind::Class:
+        return single(NodeKind::Class, 0, term.charClass);
+    case TermKind::LineStart:
+        return single(NodeKind::LineStart);
+    case TermKind::LineEnd:
+        return single(NodeKind::LineEnd);
+    case TermKind::Sequence:
+    {
+        if (term.terms.empty())
+        {
+            return single(NodeKind::Jump);
+        }
+        auto result = _Compile(term.terms.front());
+        for (size_t i = 1; i < term.terms.size(); i++)
+        {
+            auto next = _Compile(til::at(term.terms, i));
+            _Patch(result, next.start);
+            result.exits = std::move(next.exits);
+        }
+        return result;
+    }
+    case TermKind::Group:
+    {
+        auto result = _Compile(term.terms.front());
+        for (size_t i = 1; i < term.terms.size(); i++)
+        {
+            auto alternative = _Compile(til::at(term.terms, i));
+            const auto split = _AddNode(NodeKind::Split);
+            til::at(_nodes, split).next = result.start;
+            til::at(_nodes, split).alt = alternative.start;
+            result.start = split;
+            result.exits.insert(result.exits.end(), alternative.exits.cbegin(), alternative.exits.cend());
+        }
+        return result;
+    }
+    default:
+        THROW_HR(E_UNEXPECTED);
+    }
+}
+
+// Routine Description:
+// - Adds a node to the NFA, with its exits still unconnected.
+// Arguments:
+// - kind - What the node does
+// - ch - The character a Char node matches
+// - charClass - The class a Class node matches
+// Return Value:
+// - The index of the node.
+size_t RegexMatcher::_AddNode(const NodeKind kind, const wchar_t ch, const size_t charClass)
+{
+    THROW_HR_IF(E_INVALIDARG, _nodes.size() >= s_MaxNodes);
+    _nodes.push_back(Node{ kind, ch, charClass, s_None, s_None });
+    return _nodes.size() - 1;
+}
+
+// Routine Description:
+// - Connects the unconnected exits of a fragment to a node.
+// Arguments:
+// - fragment - The fragment
+// - target - The node its exits lead to
+void RegexMatcher::_Patch(const Fragment& fragment, const size_t target)
+{
+    for (const auto& [node, alt] : fragment.exits)
+    {
+        auto& exit = til::at(_nodes, node);
+        (alt ? exit.alt : exit.next) = target;
+    }
+}
+
+// Routine Description:
+// - Checks whether a node that consumes a character accepts the given one.
+// Arguments:
+// - node - The node
+// - wch - The character of the text
+// Return Value:
+// - True if the node moves on past this character. False otherwise.
+bool RegexMatcher::_Matches(const Node& node, const wchar_t wch) const
+{
+    switch (node.kind)
+    {
+    case NodeKind::Char:
+        return node.ch == wch;
+    case NodeKind::Any:
+        return true;
+    case NodeKind::Class:
+    {
+        const auto& charClass = til::at(_classes, node.charClass);
+        const auto contains = [&](const wchar_t test) {
+            return std::any_of(charClass.ranges.cbegin(), charClass.ranges.cend(), [test](const auto& range) {
+                return range.first <= test && test <= range.second;
+            });
+        };
+        // The text is folded to lower case, so upper case ranges have to be tried too.
+        const bool found = contains(wch) || (_caseInsensitive && contains(::towupper(wch)));
+        return found != charClass.negated;
+    }
+    default:
+        return false;
+    }
+}
+
+// Routine Description:
+// - Follows the nodes that don't consume characters to the ones that do.
+// Arguments:
+// - nodes - The nodes to start from. Replaced with the sorted set of nodes that
+//   consume characters, the Match node, and the '$' nodes that wait for the end
+//   of the line unless atLineEnd is set.
+// - atLineStart - Whether '^' nodes can be passed
+// - atLineEnd - Whether '$' nodes can be passed
+void RegexMatcher::_Close(std::vector<size_t>& nodes, const bool atLineStart, const bool atLineEnd) const
+{
+    std::vector<size_t> pending;
+    pending.swap(nodes);
+    std::vector<bool> seen(_nodes.size(), false);
+
+    while (!pending.empty())
+    {
+        const auto index = pending.back();
+        pending.pop_back();
+        if (seen.at(index))
+        {
+            continue;
+        }
+        seen.at(index) = true;
+
+        const auto& node = til::at(_nodes, index);
+        switch (node.kind)
+        {
+        case NodeKind::Split:
+            pending.push_back(node.alt);
+            pending.push_back(node.next);
+            break;
+        case NodeKind::Jump:
+            pending.push_back(node.next);
+            break;
+        case NodeKind::LineStart:
+            if (atLineStart)
+            {
+                pending.push_back(node.next);
+            }
+            break;
+        case NodeKind::LineEnd:
+            if (atLineEnd)
+            {
+                pending.push_back(node.next);
+            }
+            else
+            {
+                nodes.push_back(index);
+            }
+            break;
+        default:
+            nodes.push_back(index);
+            break;
+        }
+    }
+
+    std::sort(nodes.begin(), nodes.end());
+}
+
+// Routine Description:
+// - Gets the DFA state for a closed set of NFA nodes, making it if it's new.
+// Arguments:
+// - dfa - The DFA the state belongs to
+// - nodes - The sorted set of nodes
+// Return Value:
+// - The index of the state.
+size_t RegexMatcher::_Intern(Dfa& dfa, std::vector<size_t> nodes)
+{
+    const auto existing = dfa.index.find(nodes);
+    if (existing != dfa.index.end())
+    {
+        return existing->second;
+    }
+
+    // Rather than growing without bound for patterns with a huge number of states,
+    // start over. Only the states that are still being used will be built again.
+    if (dfa.states.size() >= s_MaxDfaStates)
+    {
+        dfa.states.clear();
+        dfa.index.clear();
+        dfa.starts.fill(s_None);
+        dfa.generation++;
+    }
+
+    const auto isMatch = [this](const size_t index) {
+        return til::at(_nodes, index).kind == NodeKind::Match;
+    };
+
+    DfaState state{};
+    state.accepting = std::any_of(nodes.cbegin(), nodes.cend(), isMatch);
+    if (state.accepting)
+    {
+        state.acceptingAtEnd = true;
+    }
+    else
+    {
+        std::vector<size_t> atEnd{ nodes };
+        _Close(atEnd, false, true);
+        state.acceptingAtEnd = std::any_of(atEnd.cbegin(), atEnd.cend(), isMatch);
+    }
+    state.asciiNext.fill(s_None);
+    state.nodes = nodes;
+
+    const auto index = dfa.states.size();
+    dfa.states.push_back(std::move(state));
+    dfa.index.emplace(std::move(nodes), index);
+    return index;
+}
+
+// Routine Description:
+// - Gets the state a DFA starts matching in.
+// Arguments:
+// - dfa - The DFA
+// - atLineStart - Whether the match starts at the beginning of the line
+// Return Value:
+// - The index of the state.
+size_t RegexMatcher::_Start(Dfa& dfa, const bool atLineStart)
+{
+    const size_t which = atLineStart ? 0 : 1;
+    if (til::at(dfa.starts, which) == s_None)
+    {
+        std::vector<size_t> nodes{ dfa.start };
+        _Close(nodes, atLineStart, false);
+        const auto state = _Intern(dfa, std::move(nodes));
+        til::at(dfa.starts, which) = state;
+    }
+    return til::at(dfa.starts, which);
+}
+
+// Routine Description:
+// - Gets the state a DFA moves to from the given state on a character.
+// - The transition is built the first time it's taken, and remembered after.
+// Arguments:
+// - dfa - The DFA
+// - state - The state it's in
+// - wch - The next character of the text
+// Return Value:
+// - The index of the state it moves to.
+size_t RegexMatcher::_Step(Dfa& dfa, const size_t state, const wchar_t wch)
+{
+    {
+        const auto& current = til::at(dfa.states, state);
+        if (wch < current.asciiNext.size())
+        {
+            const auto cached = til::at(current.asciiNext, wch);
+            if (cached != s_None)
+            {
+                return cached;
+            }
+        }
+        else
+        {
+            const auto cached = current.next.find(wch);
+            if (cached != current.next.end())
+            {
+                return cached->second;
+            }
+        }
+    }
+
+    std::vector<size_t> nodes;
+    for (const auto index : til::at(dfa.states, state).nodes)
+    {
+        const auto& node = til::at(_nodes, index);
+        if (_Matches(node, wch))
+        {
+            nodes.push_back(node.next);
+        }
+    }
+    if (dfa.unanchored)
+    {
+        // A match could also start at the next character.
+        nodes.push_back(dfa.start);
+    }
+    _Close(nodes, false, false);
+
+    const auto generation = dfa.generation;
+    const auto next = _Intern(dfa, std::move(nodes));
+
+    // If the states were thrown away, the one we came from is gone.
+    if (generation == dfa.generation)
+    {
+        auto& current = til::at(dfa.states, state);
+        if (wch < current.asciiNext.size())
+        {
+            til::at(current.asciiNext, wch) = next;
+        }
+        else
+        {
+            current.next.emplace(wch, next);
+        }
+    }
+    return next;
+}
@@ -0,0 +1,149 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RegexMatcher.hpp
+
+Abstract:
+- A small regular expression engine for searching the text buffer.
+- The pattern is compiled into a Thompson NFA, which is run as a DFA whose
+  states are built lazily the first time a character leads to them, so no
+  pattern can make a search take exponential time like a backtracking engine.
+- The pattern is also compiled reversed. Running that backwards over a line
+  finds every offset a match starts at in one pass, so the longest match is
+  only looked for at offsets where there is one.
+- Matching is leftmost-longest and works on lines of UTF-16 code units.
+- Supported syntax: literal characters, `.`, character classes (`[a-z]`,
+  `[^...]`), the escapes `\d \D \w \W \s \S \t \n \r` and escaped punctuation,
+  grouping `( )`, alternation `|`, the quantifiers `* + ? {m} {m,} {m,n}` and
+  the anchors `^` and `$`, which match at the start and end of the line.
+--*/
+
+#pragma once
+
+#include <array>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class RegexMatcher final
+{
+public:
+    RegexMatcher(const std::wstring_view pattern, const bool caseInsensitive);
+
+    bool FindMatchStarts(const std::wstring_view line, std::vector<bool>& starts);
+    size_t LongestMatchAt(const std::wstring_view line, const size_t start, const std::vector<bool>& boundaries);
+
+private:
+    static constexpr size_t s_None = std::numeric_limits<size_t>::max();
+
+    enum class NodeKind
+    {
+        Char,
+        Any,
+        Class,
+        Split,
+        Jump,
+        LineStart,
+        LineEnd,
+        Match
+    };
+
+    // One state of the NFA. Split follows both next and alt, everything else only next.
+    struct Node
+    {
+        NodeKind kind;
+        wchar_t ch;
+        size_t charClass;
+        size_t next;
+        size_t alt;
+    };
+
+    struct CharClass
+    {
+        std::vector<std::pair<wchar_t, wchar_t>> ranges;
+        bool negated;
+    };
+
+    enum class TermKind
+    {
+        Char,
+        Any,
+        Class,
+        LineStart,
+        LineEnd,
+        Group,
+        Sequence
+    };
+
+    // The parsed pattern, before it's compiled into nodes.
+    struct Term
+    {
+        TermKind kind;
+        wchar_t ch = 0;
+        size_t charClass = 0;
+        std::vector<Term> terms; // the alternatives of a group, or the parts of a sequence
+        size_t min = 1;
+        size_t max = 1;
+    };
+
+    // A piece of the NFA whose exits still need to be connected to what follows it.
+    struct Fragment
+    {
+        size_t start;
+        std::vector<std::pair<size_t, bool>> exits; // node, and whether its alt (rather than next) is the exit
+    };
+
+    // A DFA state: the set of NFA nodes that are live, and the states each character leads to.
+    struct DfaState
+    {
+        std::vector<size_t> nodes;
+        bool accepting;
+        bool acceptingAtEnd;
+        std::array<size_t, 128> asciiNext;
+        std::unordered_map<wchar_t, size_t> next;
+    };
+
+    // The DFA is built separately for anchored matches and for finding where
+    // matches start, which runs the reversed pattern from the end of the line.
+    struct Dfa
+    {
+        size_t start = 0; // the NFA node matches start at
+        bool unanchored = false;
+        std::vector<DfaState> states;
+        std::map<std::vector<size_t>, size_t> index;
+        std::array<size_t, 2> starts{ s_None, s_None }; // for a start at the beginning of the line, and anywhere else
+        size_t generation = 0; // counts how often the states were thrown away
+    };
+
+    Term _ParseAlternation(const std::wstring_view pattern, size_t& pos, const size_t depth);
+    Term _ParseSequence(const std::wstring_view pattern, size_t& pos, const size_t depth);
+    Term _ParseAtom(const std::wstring_view pattern, size_t& pos, const size_t depth);
+    void _ParseQuantifier(const std::wstring_view pattern, size_t& pos, Term& term);
+    size_t _ParseClass(const std::wstring_view pattern, size_t& pos);
+    size_t _AddShorthandClass(const wchar_t wch);
+    wchar_t _FoldCase(const wchar_t wch) const noexcept;
+    static Term _Reverse(const Term& term);
+
+    Fragment _Compile(const Term& term);
+    Fragment _CompileOnce(const Term& term);
+    size_t _AddNode(const NodeKind kind, const wchar_t ch = 0, const size_t charClass = 0);
+    void _Patch(const Fragment& fragment, const size_t target);
+
+    bool _Matches(const Node& node, const wchar_t wch) const;
+    void _Close(std::vector<size_t>& nodes, const bool atLineStart, const bool atLineEnd) const;
+    size_t _Intern(Dfa& dfa, std::vector<size_t> nodes);
+    size_t _Start(Dfa& dfa, const bool atLineStart);
+    size_t _Step(Dfa& dfa, const size_t state, const wchar_t wch);
+
+    const bool _caseInsensitive;
+    std::vector<CharClass> _classes;
+    std::vector<Node> _nodes;
+
+    Dfa _anchored;
+    Dfa _reversed;
+};
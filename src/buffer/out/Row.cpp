@@ -7,6 +7,9 @@
 #include "textBuffer.hpp"
 #include "../types/inc/convert.hpp"
 
+// The last revision given to any row. See ROW::GetRevision.
+static std::atomic<size_t> s_lastRevision{ 0 };
+
 // Routine Description:
 // - constructor
 // Arguments:
@@ -18,6 +21,7 @@
 // - constructed object
 ROW::ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) :
     _id{ rowId },
+    _revision{ ++s_lastRevision },
     _rowWidth{ gsl::narrow<size_t>(rowWidth) },
     _charRow{ gsl::narrow<size_t>(rowWidth), this },
     _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute },
@@ -37,6 +41,7 @@ const CharRow& ROW::GetCharRow() const noexcept
 
 CharRow& ROW::GetCharRow() noexcept
 {
+    _Touch();
     return _charRow;
 }
 
@@ -60,6 +65,40 @@ void ROW::SetId(const SHORT id) noexcept
     _id = id;
 }
 
+// Routine Description:
+// - gets a number that changes whenever the text of the row may have changed.
+// - no two states of any rows share a revision, and the revision moves with the text when
+//   rows are swapped, so it can be used to tell whether a row still holds what it held
+//   earlier, or where that went, without reading the text again.
+// Return Value:
+// - the revision of the text of this row
+size_t ROW::GetRevision() const noexcept
+{
+    return _revision;
+}
+
+// Routine Description:
+// - gives the row a new revision, before its text is changed or handed out for changing.
+void ROW::_Touch() noexcept
+{
+    _revision = ++s_lastRevision;
+}
+
+// Routine Description:
+// - exchanges the contents of two rows, text and attributes alike.
+// - the ID and the back pointers stay where they are: they name the slot in the text
+//   buffer a row sits in, so moving contents between slots never has to fix them up.
+// Arguments:
+// - a, b - the rows to exchange
+void swap(ROW& a, ROW& b) noexcept
+{
+    using std::swap;
+    swap(a._charRow, b._charRow);
+    swap(a._attrRow, b._attrRow);
+    swap(a._revision, b._revision);
+    swap(a._rowWidth, b._rowWidth);
+}
+
 // Routine Description:
 // - Sets all properties of the ROW to default values
 // Arguments:
@@ -68,6 +107,7 @@ void ROW::SetId(const SHORT id) noexcept
 // - <none>
 bool ROW::Reset(const TextAttribute Attr)
 {
+    _Touch();
     _charRow.Reset();
     try
     {
@@ -89,6 +129,7 @@ bool ROW::Reset(const TextAttribute Attr)
 // - S_OK if successful, otherwise relevant error
 [[nodiscard]] HRESULT ROW::Resize(const size_t width)
 {
+    _Touch();
     RETURN_IF_FAILED(_charRow.Resize(width));
     try
     {
@@ -110,6 +151,7 @@ bool ROW::Reset(const TextAttribute Attr)
 void ROW::ClearColumn(const size_t column)
 {
     THROW_HR_IF(E_INVALIDARG, column >= _charRow.size());
+    _Touch();
     _charRow.ClearCell(column);
 }
 
@@ -134,12 +176,13 @@ RowCellIterator ROW::AsCellIter(const size_t startIndex, const size_t count) con
 
 UnicodeStorage& ROW::GetUnicodeStorage() noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    _Touch();
+    return _charRow.GetUnicodeStorage();
 }
 
 const UnicodeStorage& ROW::GetUnicodeStorage() const noexcept
 {
-    return _pParent->GetUnicodeStorage();
+    return _charRow.GetUnicodeStorage();
 }
 
 // Routine Description:
@@ -156,6 +199,7 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
     THROW_HR_IF(E_INVALIDARG, index >= _charRow.size());
     THROW_HR_IF(E_INVALIDARG, limitRight.value_or(0) >= _charRow.size());
     size_t currentIndex = index;
+    _Touch();
 
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
@@ -224,3 +268,138 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - copies a span of cells, text and attributes alike, from a row onto this one as a block.
+// - the source may be this same row and the spans may overlap.
+// - a wide glyph that is left with only one of its halves at either edge of the target,
+//   because the span cut it in two or because the copy overwrote its other half, is cleared.
+// Arguments:
+// - source - the row to copy from
+// - sourceIndex - first column of the span in the source row
+// - targetIndex - first column of the span in this row
+// - count - number of columns to copy
+void ROW::CopyCells(const ROW& source, const size_t sourceIndex, const size_t targetIndex, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceIndex + count > source.size());
+    THROW_HR_IF(E_INVALIDARG, targetIndex + count > _charRow.size());
+
+    if (count == 0)
+    {
+        return;
+    }
+
+    _Touch();
+
+    // Getting at the cells of this row restores them if it was compressed, so
+    // from here on a source that is this same row isn't compressed either.
+    const auto target = _charRow.begin() + targetIndex;
+    const auto& sourceChars = source.GetCharRow();
+
+    // Stored glyphs are keyed into the storage of the row they came from,
+    // so they're carried over as text and stored again in this row.
+    if (sourceChars.IsCompressed())
+    {
+        // A compressed source has no cells to copy as a block. It's another
+        // row though, so its cells can be written straight into place.
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto dbcsAttr = sourceChars.DbcsAttrAt(sourceIndex + i);
+            const std::wstring_view glyph = sourceChars.GlyphAt(sourceIndex + i);
+            const bool stored = dbcsAttr.IsGlyphStored();
+            dbcsAttr.SetGlyphStored(false);
+            *(target + i) = CharRowCell{ glyph.front(), dbcsAttr };
+            if (stored)
+            {
+                _charRow.GlyphAt(targetIndex + i) = glyph;
+            }
+        }
+    }
+    else
+    {
+        const auto first = sourceChars.cbegin() + sourceIndex;
+        const auto last = first + count;
+
+        // The glyphs are taken out before anything is written, so a span that
+        // overlaps itself reads what was there before the copy. Most spans
+        // don't have any, and then this never allocates.
+        std::vector<std::pair<size_t, std::wstring>> glyphs;
+        for (auto it = first; it != last; ++it)
+        {
+            if (it->DbcsAttr().IsGlyphStored())
+            {
+                const auto i = gsl::narrow_cast<size_t>(it - first);
+                const std::wstring_view glyph = sourceChars.GlyphAt(sourceIndex + i);
+                glyphs.emplace_back(i, glyph);
+            }
+        }
+
+        // Copying in the direction away from the target keeps an overlapping span intact.
+        if (targetIndex <= sourceIndex)
+        {
+            std::copy(first, last, target);
+        }
+        else
+        {
+            std::copy_backward(first, last, target + count);
+        }
+
+        for (const auto& glyph : glyphs)
+        {
+            (target + glyph.first)->DbcsAttr().SetGlyphStored(false);
+            _charRow.GlyphAt(targetIndex + glyph.first) = glyph.second;
+        }
+    }
+
+    // Most spans are covered by a single run of attributes, which is inserted
+    // as it is. The runs are only collected into a list when there are more.
+    size_t applies = 0;
+    const auto firstAttr = source.GetAttrRow().GetAttrByColumn(sourceIndex, &applies);
+    if (applies >= count)
+    {
+        const TextAttributeRun run(count, firstAttr);
+        THROW_IF_FAILED(_attrRow.InsertAttrRuns({ &run, 1 },
+                                                targetIndex,
+                                                targetIndex + count - 1,
+                                                _charRow.size()));
+    }
+    else
+    {
+        std::vector<TextAttributeRun> runs;
+        runs.emplace_back(applies, firstAttr);
+        for (auto column = sourceIndex + applies; column < sourceIndex + count;)
+        {
+            const auto attr = source.GetAttrRow().GetAttrByColumn(column, &applies);
+            const auto length = std::min(applies, sourceIndex + count - column);
+            runs.emplace_back(length, attr);
+            column += length;
+        }
+
+        THROW_IF_FAILED(_attrRow.InsertAttrRuns({ runs.data(), runs.size() },
+                                                targetIndex,
+                                                targetIndex + count - 1,
+                                                _charRow.size()));
+    }
+
+    // Halves cut off by the edges of the span itself.
+    const auto first = targetIndex;
+    const auto last = targetIndex + count - 1;
+    if (_charRow.DbcsAttrAt(first).IsTrailing())
+    {
+        _charRow.ClearCell(first);
+    }
+    if (_charRow.DbcsAttrAt(last).IsLeading())
+    {
+        _charRow.ClearCell(last);
+    }
+
+    // Halves just outside of the span whose partner was overwritten.
+    if (first > 0 && _charRow.DbcsAttrAt(first - 1).IsLeading())
+    {
+        _charRow.ClearCell(first - 1);
+    }
+    if (last + 1 < _charRow.size() && _charRow.DbcsAttrAt(last + 1).IsTrailing())
+    {
+        _charRow.ClearCell(last + 1);
+    }
+}
@@ -45,6 +45,8 @@ public:
     SHORT GetId() const noexcept;
     void SetId(const SHORT id) noexcept;
 
+    size_t GetRevision() const noexcept;
+
     bool Reset(const TextAttribute Attr);
     [[nodiscard]] HRESULT Resize(const size_t width);
 
@@ -58,8 +60,10 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
+    void CopyCells(const ROW& source, const size_t sourceIndex, const size_t targetIndex, const size_t count);
 
-    friend bool operator==(const ROW& a, const ROW& b) noexcept;
+    friend bool operator==(const ROW& a, const ROW& b);
+    friend void swap(ROW& a, ROW& b) noexcept;
 
 #ifdef UNIT_TESTING
     friend class RowTests;
@@ -69,11 +73,14 @@ private:
     CharRow _charRow;
     ATTR_ROW _attrRow;
     SHORT _id;
+    size_t _revision; // see GetRevision
     size_t _rowWidth;
     TextBuffer* _pParent; // non ownership pointer
+
+    void _Touch() noexcept;
 };
 
-inline bool operator==(const ROW& a, const ROW& b) noexcept
+inline bool operator==(const ROW& a, const ROW& b)
 {
     return (a._charRow == b._charRow &&
             a._attrRow == b._attrRow &&
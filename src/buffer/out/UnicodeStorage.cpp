@@ -4,8 +4,13 @@
 #include "precomp.h"
 #include "UnicodeStorage.hpp"
 
+// Stale entries are only cleaned up once the buffer has grown past this many code units.
+static constexpr size_t MinimumCompactionSize = 256;
+
 UnicodeStorage::UnicodeStorage() noexcept :
-    _map{}
+    _buffer{},
+    _offsets{},
+    _compactedSize{ 0 }
 {
 }
 
@@ -16,83 +21,70 @@ UnicodeStorage::UnicodeStorage() noexcept :
 // Return Value:
 // - the glyph data associated with key
 // Note: will throw exception if key is not stored yet
-const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
+std::wstring_view UnicodeStorage::GetText(const key_type key) const
 {
-    return _map.at(key);
+    const size_t index = key;
+    const auto start = _offsets.at(index);
+    const auto end = index + 1 < _offsets.size() ? til::at(_offsets, index + 1) : _buffer.size();
+    return std::wstring_view{ _buffer }.substr(start, end - start);
 }
 
 // Routine Description:
-// - stores glyph data associated with key.
+// - stores glyph data at the end of the storage.
 // Arguments:
-// - key - the key into the storage
 // - glyph - the glyph data to store
-void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
+// Return Value:
+// - the key the glyph can be retrieved with
+// Note: will throw exception if the storage is out of keys
+UnicodeStorage::key_type UnicodeStorage::StoreGlyph(const std::wstring_view glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    const auto key = _offsets.size();
+    THROW_HR_IF(E_OUTOFMEMORY, key > std::numeric_limits<key_type>::max());
+
+    _offsets.push_back(_buffer.size());
+    _buffer.append(glyph);
+
+    return gsl::narrow_cast<key_type>(key);
 }
 
 // Routine Description:
-// - erases key and its associated data from the storage
+// - determines whether the owner should drop stale entries before storing another glyph.
 // Arguments:
-// - key - the key to remove
-void UnicodeStorage::Erase(const key_type key)
+// - glyph - the glyph data about to be stored
+// Return Value:
+// - true if the storage has grown to more than twice its size after the last
+//   compaction, or if it ran out of keys
+bool UnicodeStorage::NeedsCompaction(const std::wstring_view glyph) const noexcept
 {
-    _map.erase(key);
+    const auto limit = std::max(2 * _compactedSize, MinimumCompactionSize);
+    return _buffer.size() + glyph.size() > limit ||
+           _offsets.size() > std::numeric_limits<key_type>::max();
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
-// Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - records that the storage now only holds live entries.
+void UnicodeStorage::MarkCompacted() noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
-
-    // Walk through every stored item.
-    for (const auto& pair : _map)
-    {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
-
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
-
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
-
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
-
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
-        {
-            continue;
-        }
-
-        const auto newRowId = mapIter->second;
+    _compactedSize = _buffer.size();
+}
 
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
+// Routine Description:
+// - erases all stored glyphs
+void UnicodeStorage::Reset() noexcept
+{
+    _buffer.clear();
+    _offsets.clear();
+    _compactedSize = 0;
+}
 
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
-    }
+// Routine Description:
+// - gets the number of code units used by the storage, including stale entries
+size_t UnicodeStorage::size() const noexcept
+{
+    return _buffer.size();
+}
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+bool UnicodeStorage::empty() const noexcept
+{
+    return _buffer.empty();
 }
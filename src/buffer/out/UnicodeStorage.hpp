@@ -7,6 +7,13 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Every CharRow owns one of these. Glyphs are packed one after another into a single
+  UTF-16 buffer and the cell holding a glyph keeps the key (entry number) of its glyph
+  in place of its character. Since the storage moves with its row, scrolling or
+  rotating rows never has to re-key anything.
+- Keys count entries rather than code units, so a row can hold any amount of text.
+  Only the number of entries is limited to what a key can address, and a compacted
+  storage never has more entries than its row has cells.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -14,51 +21,40 @@ Author(s):
 
 #pragma once
 
+#include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
-#include <climits>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template<>
-    struct hash<COORD>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            size_t retVal = coord.Y;
-            const size_t xCoord = coord.X;
-            retVal |= xCoord << (sizeof(coord.Y) * CHAR_BIT);
-            return retVal;
-        }
-    };
-}
 
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
-    using mapped_type = typename std::vector<wchar_t>;
+    // The key is stored in the cell's character field, so it has to fit in a wchar_t.
+    using key_type = typename wchar_t;
 
     UnicodeStorage() noexcept;
 
-    const mapped_type& GetText(const key_type key) const;
+    std::wstring_view GetText(const key_type key) const;
+
+    key_type StoreGlyph(const std::wstring_view glyph);
 
-    void StoreGlyph(const key_type key, const mapped_type& glyph);
+    bool NeedsCompaction(const std::wstring_view glyph) const noexcept;
+    void MarkCompacted() noexcept;
 
-    void Erase(const key_type key);
+    void Reset() noexcept;
 
-    void Remap(const std::map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    size_t size() const noexcept;
+    bool empty() const noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    // The code units of every glyph, back to back.
+    std::wstring _buffer;
+
+    // Where each entry starts in _buffer. An entry ends where the next one starts.
+    std::vector<size_t> _offsets;
+
+    // The size of the buffer right after it was last compacted. Overwritten glyphs
+    // leave stale entries behind, this lets us bound how much of that we keep around.
+    size_t _compactedSize;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
@@ -22,15 +22,21 @@ using namespace Microsoft::Console::Types;
 // - str - The search term you want to find (the "needle")
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
+// - mode - Whether str is plain text or a regular expression
+// - Throws E_INVALIDARG if str is a malformed regular expression.
 Search::Search(IUiaData& uiaData,
                const std::wstring& str,
                const Direction direction,
-               const Sensitivity sensitivity) :
+               const Sensitivity sensitivity,
+               const Mode mode) :
     _direction(direction),
     _sensitivity(sensitivity),
     _needle(s_CreateNeedleFromString(str)),
     _uiaData(uiaData),
-    _coordAnchor(s_GetInitialAnchor(uiaData, direction))
+    _coordAnchor(s_GetInitialAnchor(uiaData, direction)),
+    _needleText(_CreateNeedleText()),
+    _needleCellStarts(_CreateNeedleCellStarts()),
+    _regex(s_CreateRegex(str, sensitivity, mode))
 {
     _coordNext = _coordAnchor;
 }
@@ -46,16 +52,22 @@ Search::Search(IUiaData& uiaData,
 // - direction - The direction to search (upward or downward)
 // - sensitivity - Whether or not you care about case
 // - anchor - starting search location in screenInfo
+// - mode - Whether str is plain text or a regular expression
+// - Throws E_INVALIDARG if str is a malformed regular expression.
 Search::Search(IUiaData& uiaData,
                const std::wstring& str,
                const Direction direction,
                const Sensitivity sensitivity,
-               const COORD anchor) :
+               const COORD anchor,
+               const Mode mode) :
     _direction(direction),
     _sensitivity(sensitivity),
     _needle(s_CreateNeedleFromString(str)),
     _coordAnchor(anchor),
-    _uiaData(uiaData)
+    _uiaData(uiaData),
+    _needleText(_CreateNeedleText()),
+    _needleCellStarts(_CreateNeedleCellStarts()),
+    _regex(s_CreateRegex(str, sensitivity, mode))
 {
     _coordNext = _coordAnchor;
 }
@@ -75,22 +87,173 @@ bool Search::FindNext()
         return false;
     }
 
-    do
+    if (!_indexed)
+    {
+        Refresh();
+    }
+
+    // Rather than trying the needle at every position on the way around
+    // the buffer, jump straight to the first match on the way.
+    const auto match = _NextMatchFrom(_coordNext);
+    if (match.has_value())
+    {
+        _coordSelStart = match->first;
+        _coordSelEnd = match->second;
+        _coordNext = _coordSelStart;
+        _UpdateNextPosition();
+        _reachedEnd = _coordNext == _coordAnchor;
+        return true;
+    }
+
+    _coordNext = _coordAnchor;
+    return false;
+}
+
+// Routine Description:
+// - Gets every instance of the search term within the screen buffer, as of the
+//   last time it was read. The buffer is read on the first call if FindNext or
+//   Refresh haven't already read it.
+// Return Value:
+// - The [start, end] coord positions of each match, in buffer order.
+const std::vector<std::pair<COORD, COORD>>& Search::FindAll()
+{
+    if (!_indexed)
+    {
+        Refresh();
+    }
+    return _matches;
+}
+
+// Routine Description:
+// - Updates the matches for the text that changed since the buffer was last
+//   read. Only the rows whose revision changed are read again, and only the
+//   logical lines with new or changed rows are matched again. The matches of
+//   all other lines are kept.
+// - Call this to pick up output that arrived after the search was started.
+void Search::Refresh()
+{
+    const auto& textBuffer = _uiaData.GetTextBuffer();
+    const COORD bufferEnd = _uiaData.GetTextBufferEndPosition();
+    const size_t rowCount = gsl::narrow<size_t>(bufferEnd.Y) + 1;
+
+    const bool scrolled = _indexed && _FollowScroll();
+
+    const size_t oldRowCount = _rows.size();
+    _rows.resize(rowCount);
+
+    auto& dirty = _dirty;
+    dirty.assign(rowCount, !_indexed);
+
+    // The top row may have been the rest of a line that wrapped from a row
+    // that's gone now. It starts a line of its own.
+    if (scrolled)
     {
-        if (_FindNeedleInHaystackAt(_coordNext, _coordSelStart, _coordSelEnd))
+        dirty.at(0) = true;
+    }
+
+    for (size_t y = 0; y < rowCount; y++)
+    {
+        const auto& bufferRow = textBuffer.GetRowByOffset(y);
+        auto& row = til::at(_rows, y);
+        if (row.revision == bufferRow.GetRevision())
         {
-            _UpdateNextPosition();
-            _reachedEnd = _coordNext == _coordAnchor;
-            return true;
+            continue;
         }
-        else
+
+        if (_ReadRow(bufferRow, row) || y >= oldRowCount)
         {
-            _UpdateNextPosition();
+            dirty.at(y) = true;
+            // The next row may start a line now, or no longer start one.
+            if (y + 1 < rowCount)
+            {
+                dirty.at(y + 1) = true;
+            }
         }
+    }
 
-    } while (_coordNext != _coordAnchor);
+    // Matches can only start up to the end position, so the rows it moved
+    // away from and to need to be matched again too.
+    if (_bufferEnd != bufferEnd)
+    {
+        if (_bufferEnd.Y >= 0 && gsl::narrow<size_t>(_bufferEnd.Y) < rowCount)
+        {
+            dirty.at(gsl::narrow<size_t>(_bufferEnd.Y)) = true;
+        }
+        dirty.at(rowCount - 1) = true;
+    }
+    _bufferEnd = bufferEnd;
 
-    return false;
+    // Walk the logical lines. A line starts at a row that doesn't continue
+    // a wrapped row, and runs until the first row that didn't wrap.
+    _matches.clear();
+    size_t lineStart = 0;
+    while (lineStart < rowCount)
+    {
+        size_t lineEnd = lineStart;
+        bool lineDirty = dirty.at(lineStart);
+        while (lineEnd + 1 < rowCount && til::at(_rows, lineEnd).wrapped)
+        {
+            lineEnd++;
+            lineDirty = lineDirty || dirty.at(lineEnd);
+            // a row that continues a line holds no matches of its own
+            til::at(_rows, lineEnd).matches.clear();
+        }
+
+        if (lineDirty)
+        {
+            _MatchLine(gsl::narrow<SHORT>(lineStart), gsl::narrow<SHORT>(lineEnd));
+        }
+
+        const auto& lineMatches = til::at(_rows, lineStart).matches;
+        _matches.insert(_matches.end(), lineMatches.cbegin(), lineMatches.cend());
+
+        lineStart = lineEnd + 1;
+    }
+
+    _indexed = true;
+}
+
+// Routine Description:
+// - Once the buffer is full, each new line pushes the top row out, and every
+//   other row moves up one. Rather than reading all of them again, find where
+//   the row that was read at the top has gone and move the cache along with it.
+// Return Value:
+// - True if the cache was moved. False otherwise.
+bool Search::_FollowScroll()
+{
+    if (_rows.empty())
+    {
+        return false;
+    }
+
+    const auto topRevision = _uiaData.GetTextBuffer().GetRowByOffset(0).GetRevision();
+    if (_rows.front().revision == topRevision)
+    {
+        return false;
+    }
+
+    const auto moved = std::find_if(_rows.cbegin() + 1, _rows.cend(), [=](const RowCache& row) {
+        return row.revision == topRevision;
+    });
+    if (moved == _rows.cend())
+    {
+        return false;
+    }
+
+    const auto distance = std::distance(_rows.cbegin(), moved);
+    _rows.erase(_rows.cbegin(), moved);
+
+    const auto delta = gsl::narrow<SHORT>(distance);
+    for (auto& row : _rows)
+    {
+        for (auto& match : row.matches)
+        {
+            match.first.Y -= delta;
+            match.second.Y -= delta;
+        }
+    }
+    _bufferEnd.Y -= delta;
+    return true;
 }
 
 // Routine Description:
@@ -170,72 +333,385 @@ COORD Search::s_GetInitialAnchor(IUiaData& uiaData, const Direction direction)
 }
 
 // Routine Description:
-// - Attempts to compare the search term (the needle) to the screen buffer (the haystack)
-//   at the given coordinate position of the screen buffer.
-// - Performs one comparison. Call again with new positions to check other spots.
+// - Reads one row of the buffer into the cache, folding the text the same way
+//   the needle was folded.
+// - For regular expressions, a row that ends its logical line is only read up
+//   to its last non-blank cell, so `$` matches right after the text and `.*`
+//   doesn't run on through the blank cells to the right edge.
 // Arguments:
-// - pos - The position in the haystack (screen buffer) to compare
-// - start - If we found it, this is filled with the coordinate of the first character of the needle.
-// - end - If we found it, this is filled with the coordinate of the last character of the needle.
+// - bufferRow - The row of the buffer to read
+// - row - The cache entry for that row. Updated with the current contents.
 // Return Value:
-// - True if we found it. False if not.
-bool Search::_FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const
+// - True if the row differs from what was cached. False otherwise.
+bool Search::_ReadRow(const ROW& bufferRow, RowCache& row)
 {
-    start = { 0 };
-    end = { 0 };
+    row.revision = bufferRow.GetRevision();
+
+    const auto& charRow = bufferRow.GetCharRow();
+    const bool wrapped = charRow.WasWrapForced();
+    const size_t width = _regex && !wrapped ? charRow.MeasureRight() : charRow.size();
 
-    COORD bufferPos = pos;
+    auto& text = _rowText;
+    auto& columns = _rowColumns;
+    text.clear();
+    columns.clear();
+    bool mapped = false;
 
-    for (const auto& needleCell : _needle)
+    for (size_t x = 0; x < width; x++)
     {
-        // Haystack is the buffer. Needle is the string we were given.
-        const auto hayIter = _uiaData.GetTextBuffer().GetTextDataAt(bufferPos);
-        const auto hayChars = *hayIter;
-        const auto needleChars = std::wstring_view(needleCell.data(), needleCell.size());
+        // Regular expressions see each glyph once, rather than once per cell.
+        const bool skip = _regex && charRow.DbcsAttrAt(x).IsTrailing();
+        const std::wstring_view glyph = skip ? std::wstring_view{} : static_cast<std::wstring_view>(charRow.GlyphAt(x));
 
-        // If we didn't match at any point of the needle, return false.
-        if (!_CompareChars(hayChars, needleChars))
+        // Only keep the column of every unit once a glyph takes more or less than one.
+        if (glyph.size() != 1 && !mapped)
         {
-            return false;
+            mapped = true;
+            for (size_t i = 0; i < text.size(); i++)
+            {
+                columns.push_back(gsl::narrow_cast<SHORT>(i));
+            }
         }
 
-        _IncrementCoord(bufferPos);
+        for (const auto wch : glyph)
+        {
+            text.push_back(_ApplySensitivity(wch));
+            if (mapped)
+            {
+                columns.push_back(gsl::narrow_cast<SHORT>(x));
+            }
+        }
     }
 
-    _DecrementCoord(bufferPos);
+    const auto end = gsl::narrow_cast<SHORT>(width);
+    if (row.text == text && row.columns == columns && row.end == end && row.wrapped == wrapped)
+    {
+        return false;
+    }
 
-    // If we made it the whole way through the needle, then it was in the haystack.
-    // Fill out the span that we found the result at and return true.
-    start = pos;
-    end = bufferPos;
+    // Trade buffers with the cache, so the scratch space keeps its capacity.
+    row.text.swap(text);
+    row.columns.swap(columns);
+    row.end = end;
+    row.wrapped = wrapped;
 
     return true;
 }
 
 // Routine Description:
-// - Provides an abstraction for comparing two spans of text.
-// - Internally handles case sensitivity based on object construction.
+// - Finds every instance of the needle in one logical line and stores them on
+//   the row the line starts at.
+// - Matches may start on one row and end on a later one, as long as the rows
+//   between them wrapped.
+// Arguments:
+// - firstRow - The row the logical line starts at
+// - lastRow - The last row of the logical line (inclusive)
+void Search::_MatchLine(const SHORT firstRow, const SHORT lastRow)
+{
+    auto& matches = til::at(_rows, gsl::narrow_cast<size_t>(firstRow)).matches;
+    matches.clear();
+
+    if (_needleText.empty())
+    {
+        return;
+    }
+
+    // Stitch the rows together and keep the position of every unit.
+    _lineText.clear();
+    _linePositions.clear();
+    bool simple = _needleText.size() == _needle.size();
+    for (SHORT y = firstRow; y <= lastRow; y++)
+    {
+        const auto& row = til::at(_rows, gsl::narrow_cast<size_t>(y));
+        _lineText.append(row.text);
+        simple = simple && row.columns.empty();
+        for (size_t i = 0; i < row.text.size(); i++)
+        {
+            const SHORT x = row.columns.empty() ? gsl::narrow_cast<SHORT>(i) : til::at(row.columns, i);
+            _linePositions.push_back({ x, y });
+        }
+    }
+
+    if (_regex)
+    {
+        _MatchLineRegex(matches, lastRow);
+        return;
+    }
+
+    const std::wstring_view line{ _lineText };
+    const size_t needleSize = _needleText.size();
+    for (auto offset = line.find(_needleText); offset != std::wstring_view::npos; offset = line.find(_needleText, offset + 1))
+    {
+        const COORD start = til::at(_linePositions, offset);
+
+        // Matches can't start past the end of the written text.
+        if (start.Y > _bufferEnd.Y || (start.Y == _bufferEnd.Y && start.X > _bufferEnd.X))
+        {
+            break;
+        }
+
+        // When either side has glyphs made of several units, the match has
+        // to line up with the cells of the buffer, not just the units.
+        if (!simple)
+        {
+            bool aligned = _IsCellStart(offset) && _IsCellStart(offset + needleSize);
+            for (size_t k = 1; aligned && k < needleSize; k++)
+            {
+                aligned = _IsCellStart(offset + k) == til::at(_needleCellStarts, k);
+            }
+            if (!aligned)
+            {
+                continue;
+            }
+        }
+
+        matches.emplace_back(start, til::at(_linePositions, offset + needleSize - 1));
+    }
+}
+
+// Routine Description:
+// - Finds the matches of the regular expression in the line last stitched
+//   together by _MatchLine. Matches don't overlap, and each one is the longest
+//   of those starting at the leftmost position.
 // Arguments:
-// - one - String view representing the first string of text
-// - two - String view representing the second string of text
+// - matches - Receives the [start, end] coord positions of each match
+// - lastRow - The last row of the logical line (inclusive)
+void Search::_MatchLineRegex(std::vector<std::pair<COORD, COORD>>& matches, const SHORT lastRow)
+{
+    // Find every offset a match starts at in one pass. Most lines don't have
+    // any, and the rest only need the longest match looked for at those.
+    if (!_regex->FindMatchStarts(_lineText, _lineStarts))
+    {
+        return;
+    }
+
+    auto& boundaries = _lineBoundaries;
+    boundaries.resize(_lineText.size() + 1);
+    for (size_t i = 0; i < boundaries.size(); i++)
+    {
+        boundaries.at(i) = _IsCellStart(i);
+    }
+
+    size_t offset = 0;
+    while (offset < _lineText.size())
+    {
+        const bool candidate = _lineStarts.at(offset) && boundaries.at(offset);
+        const auto end = candidate ? _regex->LongestMatchAt(_lineText, offset, boundaries) : std::wstring_view::npos;
+        if (end == std::wstring_view::npos)
+        {
+            offset++;
+            continue;
+        }
+
+        const COORD start = til::at(_linePositions, offset);
+        if (start.Y > _bufferEnd.Y || (start.Y == _bufferEnd.Y && start.X > _bufferEnd.X))
+        {
+            break;
+        }
+
+        // A match ends right before the cell the next unit is in, which also
+        // covers the trailing half of a wide glyph. At the end of the line,
+        // that's the cell after the last one that was read.
+        const auto& lastRowCache = til::at(_rows, gsl::narrow_cast<size_t>(lastRow));
+        COORD last{ _uiaData.GetTextBuffer().GetSize().RightInclusive(), lastRow };
+        if (end < _lineText.size())
+        {
+            last = til::at(_linePositions, end);
+            _DecrementCoord(last);
+        }
+        else if (lastRowCache.end <= last.X)
+        {
+            last.X = lastRowCache.end;
+            _DecrementCoord(last);
+        }
+
+        matches.emplace_back(start, last);
+        offset = end;
+    }
+}
+
+// Routine Description:
+// - Checks whether a unit of the current line is the first one of its cell.
+// Arguments:
+// - offset - The unit within the line last given to _MatchLine
 // Return Value:
-// - True if they are the same. False otherwise.
-bool Search::_CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept
+// - True if the unit starts a cell or is the end of the line. False otherwise.
+bool Search::_IsCellStart(const size_t offset) const noexcept
 {
-    if (one.size() != two.size())
+    if (offset == 0 || offset >= _linePositions.size())
     {
-        return false;
+        return true;
     }
+    return til::at(_linePositions, offset) != til::at(_linePositions, offset - 1);
+}
 
-    for (size_t i = 0; i < one.size(); i++)
+// Routine Description:
+// - Finds the match that the search lands on next, going from the given
+//   position in the search direction until the anchor is reached again.
+// Arguments:
+// - position - Where the search continues from
+// Return Value:
+// - The [start, end] coord positions of the match, if there is one.
+std::optional<std::pair<COORD, COORD>> Search::_NextMatchFrom(const COORD position) const
+{
+    if (_matches.empty())
     {
-        if (_ApplySensitivity(one.at(i)) != _ApplySensitivity(two.at(i)))
+        return std::nullopt;
+    }
+
+    const size_t current = _ToIndex(position);
+    const size_t anchor = _ToIndex(_coordAnchor);
+    const size_t end = _ToIndex(_bufferEnd);
+
+    const auto startsAt = [this](const std::pair<COORD, COORD>& match) {
+        return _ToIndex(match.first);
+    };
+    const auto lower = [&](const size_t index) {
+        return std::lower_bound(_matches.cbegin(), _matches.cend(), index, [&](const auto& match, const size_t i) {
+            return startsAt(match) < i;
+        });
+    };
+
+    // The first match in [first, last] in the search direction.
+    const auto firstIn = [&](const size_t first, const size_t last) -> std::optional<std::pair<COORD, COORD>> {
+        if (first > last)
+        {
+            return std::nullopt;
+        }
+        if (_direction == Direction::Forward)
+        {
+            const auto it = lower(first);
+            if (it != _matches.cend() && startsAt(*it) <= last)
+            {
+                return *it;
+            }
+        }
+        else
         {
-            return false;
+            const auto it = lower(last + 1);
+            if (it != _matches.cbegin() && startsAt(*std::prev(it)) >= first)
+            {
+                return *std::prev(it);
+            }
         }
+        return std::nullopt;
+    };
+
+    // The position we're at is always tried first.
+    if (const auto here = firstIn(current, current))
+    {
+        return here;
     }
 
-    return true;
+    if (_direction == Direction::Forward)
+    {
+        // Up to the end of the text, then around from the top to the anchor.
+        if (current < end)
+        {
+            if (anchor > current && anchor <= end)
+            {
+                return firstIn(current + 1, anchor - 1);
+            }
+            if (const auto match = firstIn(current + 1, end))
+            {
+                return match;
+            }
+        }
+        if (anchor == 0)
+        {
+            return std::nullopt;
+        }
+        return firstIn(0, std::min(anchor - 1, end));
+    }
+    else if (_direction == Direction::Backward)
+    {
+        // Up to the top of the buffer, then around from the end to the anchor.
+        if (current > 0)
+        {
+            const size_t last = std::min(current - 1, end);
+            if (anchor < current)
+            {
+                return firstIn(anchor + 1, last);
+            }
+            if (const auto match = firstIn(0, last))
+            {
+                return match;
+            }
+        }
+        if (anchor > end)
+        {
+            return firstIn(0, end);
+        }
+        return firstIn(anchor + 1, end);
+    }
+    else
+    {
+        THROW_HR(E_NOTIMPL);
+    }
+}
+
+// Routine Description:
+// - Converts a position in the buffer to an index that sorts in buffer order.
+// Arguments:
+// - position - The position in the buffer
+// Return Value:
+// - The index of the position.
+size_t Search::_ToIndex(const COORD position) const noexcept
+{
+    const size_t width = gsl::narrow_cast<size_t>(_uiaData.GetTextBuffer().GetSize().Width());
+    return gsl::narrow_cast<size_t>(position.Y) * width + gsl::narrow_cast<size_t>(position.X);
+}
+
+// Routine Description:
+// - Compiles the search term if it's a regular expression.
+// Arguments:
+// - wstr - String that will be our search term
+// - sensitivity - Whether or not you care about case
+// - mode - Whether wstr is plain text or a regular expression
+// Return Value:
+// - The compiled expression, or null for a plain text search.
+std::unique_ptr<RegexMatcher> Search::s_CreateRegex(const std::wstring& wstr, const Sensitivity sensitivity, const Mode mode)
+{
+    if (mode != Mode::RegularExpression)
+    {
+        return nullptr;
+    }
+    return std::make_unique<RegexMatcher>(wstr, sensitivity == Sensitivity::CaseInsensitive);
+}
+
+// Routine Description:
+// - Flattens the needle into the text that is looked for in each line,
+//   folded according to the case sensitivity.
+// Return Value:
+// - The text of the needle.
+std::wstring Search::_CreateNeedleText() const
+{
+    std::wstring text;
+    for (const auto& cell : _needle)
+    {
+        for (const auto wch : cell)
+        {
+            text.push_back(_ApplySensitivity(wch));
+        }
+    }
+    return text;
+}
+
+// Routine Description:
+// - Notes which units of the needle text start one of its cells.
+// Return Value:
+// - One entry per unit of the needle text, true where a cell starts.
+std::vector<bool> Search::_CreateNeedleCellStarts() const
+{
+    std::vector<bool> starts;
+    for (const auto& cell : _needle)
+    {
+        for (size_t i = 0; i < cell.size(); i++)
+        {
+            starts.push_back(i == 0);
+        }
+    }
+    return starts;
 }
 
 // Routine Description:
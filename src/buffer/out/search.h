@@ -7,6 +7,12 @@ Module Name:
 
 Abstract:
 - This module is used for searching through the screen for a substring
+- The text of the buffer is read once into a per-row cache, and the needle is
+  matched against whole logical lines (rows joined where they wrapped) with a
+  plain substring search. That yields every match at once, and a later
+  Refresh() only has to read and match again the rows that changed, which it
+  tells by their revision (see ROW::GetRevision).
+- In regular expression mode the lines are matched by a RegexMatcher instead.
 
 Author(s):
 - Michael Niksa (MiNiksa) 20-Apr-2018
@@ -20,6 +26,7 @@ Revision History:
 #include <WinConTypes.h>
 #include "TextAttribute.hpp"
 #include "textBuffer.hpp"
+#include "RegexMatcher.hpp"
 #include "../types/IUiaData.h"
 
 // This used to be in find.h.
@@ -40,16 +47,24 @@ public:
         CaseSensitive
     };
 
+    enum class Mode
+    {
+        PlainText,
+        RegularExpression
+    };
+
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
-           const Sensitivity sensitivity);
+           const Sensitivity sensitivity,
+           const Mode mode = Mode::PlainText);
 
     Search(Microsoft::Console::Types::IUiaData& uiaData,
            const std::wstring& str,
            const Direction dir,
            const Sensitivity sensitivity,
-           const COORD anchor);
+           const COORD anchor,
+           const Mode mode = Mode::PlainText);
 
     bool FindNext();
     void Select() const;
@@ -57,10 +72,29 @@ public:
 
     std::pair<COORD, COORD> GetFoundLocation() const noexcept;
 
+    const std::vector<std::pair<COORD, COORD>>& FindAll();
+    void Refresh();
+
 private:
+    // What we know about one row of the buffer from the last time it was read.
+    struct RowCache
+    {
+        std::wstring text; // the glyph of every cell, case folded if the search is case insensitive
+        std::vector<SHORT> columns; // the column of each code unit of text, only if some cell isn't exactly one unit
+        SHORT end = 0; // the column after the last cell that was read
+        bool wrapped = false;
+        size_t revision = 0; // the revision of the buffer row when it was read, 0 if it never was
+        std::vector<std::pair<COORD, COORD>> matches; // the matches in the logical line starting at this row
+    };
+
     wchar_t _ApplySensitivity(const wchar_t wch) const noexcept;
-    bool _FindNeedleInHaystackAt(const COORD pos, COORD& start, COORD& end) const;
-    bool _CompareChars(const std::wstring_view one, const std::wstring_view two) const noexcept;
+    bool _ReadRow(const ROW& bufferRow, RowCache& row);
+    bool _FollowScroll();
+    void _MatchLine(const SHORT firstRow, const SHORT lastRow);
+    void _MatchLineRegex(std::vector<std::pair<COORD, COORD>>& matches, const SHORT lastRow);
+    bool _IsCellStart(const size_t offset) const noexcept;
+    std::optional<std::pair<COORD, COORD>> _NextMatchFrom(const COORD position) const;
+    size_t _ToIndex(const COORD position) const noexcept;
     void _UpdateNextPosition();
 
     void _IncrementCoord(COORD& coord) const;
@@ -69,6 +103,10 @@ private:
     static COORD s_GetInitialAnchor(Microsoft::Console::Types::IUiaData& uiaData, const Direction dir);
 
     static std::vector<std::vector<wchar_t>> s_CreateNeedleFromString(const std::wstring& wstr);
+    static std::unique_ptr<RegexMatcher> s_CreateRegex(const std::wstring& wstr, const Sensitivity sensitivity, const Mode mode);
+
+    std::wstring _CreateNeedleText() const;
+    std::vector<bool> _CreateNeedleCellStarts() const;
 
     bool _reachedEnd = false;
     COORD _coordNext = { 0 };
@@ -81,6 +119,26 @@ private:
     const Sensitivity _sensitivity;
     Microsoft::Console::Types::IUiaData& _uiaData;
 
+    // The needle as one string, and for each of its code units whether a cell starts there.
+    const std::wstring _needleText;
+    const std::vector<bool> _needleCellStarts;
+    const std::unique_ptr<RegexMatcher> _regex; // only in regular expression mode
+
+    bool _indexed = false;
+    COORD _bufferEnd = { 0 };
+    std::vector<RowCache> _rows;
+    std::vector<std::pair<COORD, COORD>> _matches; // every match, in buffer order
+
+    // Scratch space for the row being read and the logical line being
+    // matched, reused between rows, lines and calls to Refresh.
+    std::wstring _rowText;
+    std::vector<SHORT> _rowColumns;
+    std::vector<bool> _dirty;
+    std::wstring _lineText;
+    std::vector<COORD> _linePositions; // the cell each code unit of _lineText came from
+    std::vector<bool> _lineStarts; // where regular expression matches start in _lineText
+    std::vector<bool> _lineBoundaries; // where cells start in _lineText
+
 #ifdef UNIT_TESTING
     friend class SearchTests;
 #endif
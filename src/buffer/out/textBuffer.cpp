@@ -30,12 +30,14 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
                        Microsoft::Console::Render::IRenderTarget& renderTarget) :
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
+    _compressionThreshold{},
+    _compressionSweep{ 0 },
     _cursor{ cursorSize, *this },
     _storage{},
-    _unicodeStorage{},
     _renderTarget{ renderTarget }
 {
     // initialize ROWs
+    _storage.reserve(static_cast<size_t>(screenBufferSize.Y));
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
         _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
@@ -52,6 +54,7 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
 void TextBuffer::CopyProperties(const TextBuffer& OtherBuffer) noexcept
 {
     GetCursor().CopyProperties(OtherBuffer.GetCursor());
+    _compressionThreshold = OtherBuffer._compressionThreshold;
 }
 
 // Routine Description:
@@ -72,8 +75,16 @@ UINT TextBuffer::TotalRowCount() const noexcept
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - const reference to the requested row. Asserts if out of bounds.
+// Note: a compressed scrollback row is handed out as it is, reading it doesn't expand it
+// Note: rows that a reflow left for later are written first, see Reflow
 const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 {
+    // Writing the rows a reflow left doesn't change what the buffer holds, only when it gets there.
+    if (_IsReflowPending(index))
+    {
+        const_cast<TextBuffer*>(this)->_FinishReflow();
+    }
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
@@ -88,8 +99,15 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // - Number of rows down from the first row of the buffer.
 // Return Value:
 // - reference to the requested row. Asserts if out of bounds.
+// Note: a compressed scrollback row only expands once one of its cells is written
+// Note: rows that a reflow left for later are written first, see Reflow
 ROW& TextBuffer::GetRowByOffset(const size_t index)
 {
+    if (_IsReflowPending(index))
+    {
+        _FinishReflow();
+    }
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
@@ -97,6 +115,72 @@ ROW& TextBuffer::GetRowByOffset(const size_t index)
     return _storage.at(offsetIndex);
 }
 
+// Routine Description:
+// - Sets how far above the cursor a row has to be before it is compressed. Rows are compressed
+//   as they scroll past the threshold. Reading a compressed row leaves it compressed, writing to
+//   it expands it until IncrementCircularBuffer sweeps by and compresses it again.
+// Arguments:
+// - rows - number of rows above the cursor that are kept uncompressed, or nullopt to
+//          keep every row uncompressed.
+void TextBuffer::SetScrollbackCompressionThreshold(const std::optional<size_t> rows)
+{
+    _compressionThreshold = rows;
+    CompressScrollback();
+}
+
+// Routine Description:
+// - Compresses every row beyond the compression threshold, including those that were
+//   expanded by being written to since they scrolled past it.
+void TextBuffer::CompressScrollback()
+{
+    if (_compressionThreshold.has_value())
+    {
+        // Rows a reflow hasn't written yet are compressed once it has.
+        const size_t cursorRow = GetCursor().GetPosition().Y;
+        const size_t firstRow = _pendingReflow ? gsl::narrow_cast<size_t>(_pendingReflow->written - _pendingReflow->scrolled) : 0;
+        for (size_t i = firstRow; i + _compressionThreshold.value() < cursorRow; ++i)
+        {
+            _CompressRow(i);
+        }
+    }
+}
+
+// Routine Description:
+// - Compresses the row at the given offset from the first row without touching any other row.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+void TextBuffer::_CompressRow(const size_t index)
+{
+    _storage.at((_firstRow + index) % TotalRowCount()).GetCharRow().Compress();
+}
+
+// Routine Description:
+// - Compresses the next two rows of the sweep through the rows beyond the compression threshold,
+//   so a row that was expanded by a write is compressed again within one pass over them.
+// - Every call the rows move up by one while the sweep moves down by one. Looking at two
+//   neighbouring rows each time is what keeps a row from slipping past the sweep between calls.
+void TextBuffer::_SweepCompression()
+{
+    const size_t cursorRow = GetCursor().GetPosition().Y;
+    if (cursorRow <= _compressionThreshold.value())
+    {
+        return;
+    }
+
+    const auto compressibleRows = cursorRow - _compressionThreshold.value();
+    if (_compressionSweep >= compressibleRows)
+    {
+        _compressionSweep = 0;
+    }
+
+    _CompressRow(_compressionSweep);
+    if (_compressionSweep + 1 < compressibleRows)
+    {
+        _CompressRow(_compressionSweep + 1);
+    }
+    ++_compressionSweep;
+}
+
 // Routine Description:
 // - Retrieves read-only text iterator at the given buffer location
 // Arguments:
@@ -178,16 +262,17 @@ TextBufferCellIterator TextBuffer::GetCellDataAt(const COORD at, const Viewport
 //Routine Description:
 // - Corrects and enforces consistent double byte character state (KAttrs line) within a row of the text buffer.
 // - This will take the given double byte information and check that it will be consistent when inserted into the buffer
-//   at the current cursor position.
-// - It will correct the buffer (by erasing the character prior to the cursor) if necessary to make a consistent state.
+//   at the given position.
+// - It will correct the buffer (by erasing the character prior to the position) if necessary to make a consistent state.
 //Arguments:
 // - dbcsAttribute - Double byte information associated with the character about to be inserted into the buffer
+// - position - where the character is about to be inserted
 //Return Value:
 // - True if it is valid to insert a character with the given double byte attributes. False otherwise.
-bool TextBuffer::_AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribute)
+bool TextBuffer::_AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribute, const COORD position)
 {
     // To figure out if the sequence is valid, we have to look at the character that comes before the current one
-    const COORD coordPrevPosition = _GetPreviousFromCursor();
+    const COORD coordPrevPosition = _GetPreviousFrom(position);
     ROW& prevRow = GetRowByOffset(coordPrevPosition.Y);
     DbcsAttribute prevDbcsAttr;
     try
@@ -274,7 +359,7 @@ bool TextBuffer::_PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute
 {
     // Assert the buffer state is ready for this character
     // This function corrects most errors. If this is false, we had an uncorrectable one.
-    FAIL_FAST_IF(!(_AssertValidDoubleByteSequence(dbcsAttribute))); // Shouldn't be uncorrectable sequences unless something is very wrong.
+    FAIL_FAST_IF(!(_AssertValidDoubleByteSequence(dbcsAttribute, GetCursor().GetPosition()))); // Shouldn't be uncorrectable sequences unless something is very wrong.
 
     bool fSuccess = true;
     // Now compensate if we don't have enough space for the upcoming double byte sequence
@@ -381,6 +466,55 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes a run of printable text that shares a single attribute onto one row of the buffer.
+// - As many glyphs as fit between the target column and the end of the row are
+//   written in one pass, then the attribute is applied to the whole span at once.
+// - Surrogate pairs and full width glyphs are handled like any other write. A full width
+//   glyph that doesn't fit in the last column pads it out and is left unconsumed.
+// - The row is only marked as wrapped if the text carries on past its last column.
+//   A run that ends exactly at the edge may be followed by a newline, so it isn't.
+// Arguments:
+// - text - Printable UTF-16 text to write. Control characters are not interpreted.
+// - attr - Color data to apply to every cell written
+// - target - Coordinate targeted within output buffer
+// Return Value:
+// - The number of code units consumed from text and the number of columns written.
+//   Both are 0 if target is out of bounds or the row has no room left for the next glyph.
+TextBuffer::WriteRunResult TextBuffer::WriteRun(const std::wstring_view text,
+                                                const TextAttribute attr,
+                                                const COORD target)
+{
+    if (text.empty() || !GetSize().IsInBounds(target))
+    {
+        return { 0, 0 };
+    }
+
+    ROW& row = GetRowByOffset(target.Y);
+
+    // Write the text only and leave the colors alone, we'll fill those in with a single run below.
+    const OutputCellIterator it{ text };
+    const auto newIt = row.WriteCells(it, target.X);
+    if (newIt)
+    {
+        row.GetCharRow().SetWrapForced(true);
+    }
+
+    const auto written = gsl::narrow<size_t>(newIt.GetCellDistance(it));
+    if (written > 0)
+    {
+        const TextAttributeRun attrRun{ written, attr };
+        LOG_IF_FAILED(row.GetAttrRow().InsertAttrRuns({ &attrRun, 1 },
+                                                      target.X,
+                                                      target.X + written - 1,
+                                                      row.size()));
+
+        _NotifyPaint(Viewport::FromDimensions(target, { gsl::narrow<SHORT>(written), 1 }));
+    }
+
+    return { gsl::narrow<size_t>(newIt.GetInputDistance(it)), written };
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -568,6 +702,28 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         {
             _firstRow = 0;
         }
+
+        // The rows a reflow left for later moved up along with everything else. Once the last of
+        // them has scrolled off there is nothing left to write.
+        if (_pendingReflow && ++_pendingReflow->scrolled >= _pendingReflow->written)
+        {
+            _pendingReflow.reset();
+        }
+
+        // Everything moved up a row, so one more row has scrolled past the compression threshold.
+        const size_t cursorRow = GetCursor().GetPosition().Y;
+        if (_compressionThreshold.has_value())
+        {
+            try
+            {
+                if (cursorRow > _compressionThreshold.value())
+                {
+                    _CompressRow(cursorRow - _compressionThreshold.value() - 1);
+                }
+                _SweepCompression();
+            }
+            CATCH_LOG();
+        }
     }
     return fSuccess;
 }
@@ -623,15 +779,15 @@ COORD TextBuffer::GetLastNonSpaceCharacter(const Microsoft::Console::Types::View
 }
 
 // Routine Description:
-// - Retrieves the position of the previous character relative to the current cursor position
+// - Retrieves the position of the previous character relative to the given position
 // Arguments:
-// - <none>
+// - position - the position to look before, usually the cursor's
 // Return Value:
-// - Coordinate position in screen coordinates of the character just before the cursor.
+// - Coordinate position in screen coordinates of the character just before the given position.
 // - NOTE: Will return 0,0 if already in the top left corner
-COORD TextBuffer::_GetPreviousFromCursor() const
+COORD TextBuffer::_GetPreviousFrom(const COORD position) const
 {
-    COORD coordPosition = GetCursor().GetPosition();
+    COORD coordPosition = position;
 
     // If we're not at the left edge, simply move the cursor to the left by one
     if (coordPosition.X > 0)
@@ -676,25 +832,16 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         return;
     }
 
-    // OK. We're about to play games by moving rows around within the deque to
+    // OK. We're about to play games by moving rows around within the storage to
     // scroll a massive region in a faster way than copying things.
-    // To make this easier, first correct the circular buffer to have the first row be 0 again.
-    if (_firstRow != 0)
-    {
-        // Rotate the buffer to put the first row at the front.
-        std::rotate(_storage.begin(), _storage.begin() + _firstRow, _storage.end());
-
-        // The first row is now at the top.
-        _firstRow = 0;
-    }
-
-    // Rotate just the subsection specified
+    // The rows are addressed by their logical position (relative to the circular buffer's first row),
+    // so only the rows in the affected region are swapped and the rest of the buffer stays untouched.
     if (delta < 0)
     {
         // The layout is like this:
         // delta is -2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move up 2 spots.
-        // --- (storage) ----
+        // --- (logical rows) ----
         // | 0 begin
         // | 1
         // | 2
@@ -710,7 +857,7 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // - end
         // We want B to slide up to A (the negative delta) and everything from [B,C) to slide up with it.
         // So the final layout will be
-        // --- (storage) ----
+        // --- (logical rows) ----
         // | 0 begin
         // | 1
         // | 2
@@ -724,14 +871,14 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow + delta, _storage.begin() + firstRow, _storage.begin() + firstRow + size);
+        _RotateRows(firstRow + delta, firstRow, firstRow + size);
     }
     else
     {
         // The layout is like this:
         // delta is 2, size is 3, firstRow is 5
         // We want 3 rows from 5 (5, 6, and 7) to move down 2 spots.
-        // --- (storage) ----
+        // --- (logical rows) ----
         // | 0 begin
         // | 1
         // | 2
@@ -747,7 +894,7 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // - end
         // We want B-1 to slide down to C-1 (the positive delta) and everything from [A, B) to slide down with it.
         // So the final layout will be
-        // --- (storage) ----
+        // --- (logical rows) ----
         // | 0 begin
         // | 1
         // | 2
@@ -761,12 +908,81 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         // | 10
         // | 11
         // - end
-        std::rotate(_storage.begin() + firstRow, _storage.begin() + firstRow + size, _storage.begin() + firstRow + size + delta);
+        _RotateRows(firstRow, firstRow + size, firstRow + size + delta);
     }
+}
 
-    // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
-    _RefreshRowIDs(std::nullopt);
+// Routine Description:
+// - Copies a rectangle of the buffer to another position, moving a whole span of each row at once.
+// - When the source and the target overlap, the rows are visited bottom up for a move down
+//   and top down otherwise, so no row of the source is overwritten before it has been copied.
+// Arguments:
+// - source - the rectangle to copy
+// - targetOrigin - the top left of where the copy lands. The whole target must fit in the buffer.
+void TextBuffer::CopyRectangle(const Viewport& source, const COORD targetOrigin)
+{
+    const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
+    const auto bufferSize = GetSize();
+    THROW_HR_IF(E_INVALIDARG, !bufferSize.IsInBounds(source) || !bufferSize.IsInBounds(target));
+
+    const auto width = gsl::narrow_cast<size_t>(source.Width());
+    const auto copyRow = [&](const SHORT offset) {
+        const ROW& sourceRow = GetRowByOffset(gsl::narrow_cast<size_t>(source.Top() + offset));
+        ROW& targetRow = GetRowByOffset(gsl::narrow_cast<size_t>(target.Top() + offset));
+        targetRow.CopyCells(sourceRow, source.Left(), target.Left(), width);
+    };
+
+    if (target.Top() > source.Top())
+    {
+        for (auto offset = gsl::narrow_cast<SHORT>(source.Height() - 1); offset >= 0; --offset)
+        {
+            copyRow(offset);
+        }
+    }
+    else
+    {
+        for (SHORT offset = 0; offset < source.Height(); ++offset)
+        {
+            copyRow(offset);
+        }
+    }
+
+    // A wide glyph cut in half just outside of the target is cleared as well, so repaint those columns too.
+    auto paint = target.ToInclusive();
+    if (paint.Left > bufferSize.Left())
+    {
+        --paint.Left;
+    }
+    if (paint.Right < bufferSize.RightInclusive())
+    {
+        ++paint.Right;
+    }
+    _NotifyPaint(Viewport::FromInclusive(paint));
+}
+
+// Routine Description:
+// - Rotates the logical rows [first, last) so that the row at middle becomes the row at first.
+// - This is std::rotate over the circular buffer: the rows are swapped in place by reversing
+//   [first, middle), [middle, last) and then [first, last), so no row is ever copied and
+//   nothing outside of the range is moved.
+// - Swapping rows only exchanges their contents. The IDs stay with the slots, so the cost
+//   is the number of rows moved no matter how much scrollback there is.
+// Arguments:
+// - first - logical index of the first row of the range
+// - middle - logical index of the row that should end up at first
+// - last - logical index one past the last row of the range
+void TextBuffer::_RotateRows(const SHORT first, const SHORT middle, const SHORT last)
+{
+    const auto reverse = [this](SHORT begin, SHORT end) {
+        while (begin < end && begin < --end)
+        {
+            swap(GetRowByOffset(begin++), GetRowByOffset(end));
+        }
+    };
+
+    reverse(first, middle);
+    reverse(middle, last);
+    reverse(first, last);
 }
 
 Cursor& TextBuffer::GetCursor() noexcept
@@ -796,6 +1012,9 @@ void TextBuffer::Reset()
 {
     const auto attr = GetCurrentAttributes();
 
+    // Every row is cleared, including any a reflow hasn't written yet.
+    _pendingReflow.reset();
+
     for (auto& row : _storage)
     {
         row.GetCharRow().Reset();
@@ -815,6 +1034,12 @@ void TextBuffer::Reset()
 
     try
     {
+        // The rows are moved around directly below, so anything a reflow left has to be there first.
+        if (_pendingReflow)
+        {
+            _FinishReflow();
+        }
+
         const auto currentSize = GetSize().Dimensions();
         const auto attributes = GetCurrentAttributes();
 
@@ -826,22 +1051,18 @@ void TextBuffer::Reset()
         const SHORT TopRowIndex = (GetFirstRowIndex() + TopRow) % currentSize.Y;
 
         // rotate rows until the top row is at index 0
-        const ROW& newTopRow = _storage.at(TopRowIndex);
-        while (&newTopRow != &_storage.front())
-        {
-            _storage.push_back(std::move(_storage.front()));
-            _storage.pop_front();
-        }
+        std::rotate(_storage.begin(), _storage.begin() + TopRowIndex, _storage.end());
 
         _SetFirstRowIndex(0);
 
         // realloc in the Y direction
         // remove rows if we're shrinking
-        while (_storage.size() > static_cast<size_t>(newSize.Y))
+        if (_storage.size() > static_cast<size_t>(newSize.Y))
         {
-            _storage.pop_back();
+            _storage.erase(_storage.begin() + newSize.Y, _storage.end());
         }
         // add rows if we're growing
+        _storage.reserve(static_cast<size_t>(newSize.Y));
         while (_storage.size() < static_cast<size_t>(newSize.Y))
         {
             _storage.emplace_back(static_cast<short>(_storage.size()), newSize.X, attributes, this);
@@ -849,7 +1070,6 @@ void TextBuffer::Reset()
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
         // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
         _RefreshRowIDs(newSize.X);
     }
     CATCH_RETURN();
@@ -857,34 +1077,21 @@ void TextBuffer::Reset()
     return S_OK;
 }
 
-const UnicodeStorage& TextBuffer::GetUnicodeStorage() const noexcept
-{
-    return _unicodeStorage;
-}
-
-UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
-{
-    return _unicodeStorage;
-}
-
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - Optionally takes a new row width if we're resizing to perform a resize operation
+//   while we're already looping through the rows. Each row drops its own high unicode
+//   (UnicodeStorage) glyphs that fall outside the new width.
 // Arguments:
 // - newRowWidth - Optional new value for the row width.
 void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
 {
-    std::map<SHORT, SHORT> rowMap;
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
         // Update the IDs
         it.SetId(i++);
 
@@ -898,9 +1105,6 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
             THROW_IF_FAILED(it.Resize(newRowWidth.value()));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -930,6 +1134,11 @@ ROW& TextBuffer::_GetFirstRow()
 // - will throw exception if called with the first row of the text buffer
 ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
 {
+    if (_pendingReflow)
+    {
+        _FinishReflow();
+    }
+
     int prevRowIndex = Row.GetId() - 1;
     if (prevRowIndex < 0)
     {
@@ -1065,6 +1274,7 @@ TextBuffer::DelimiterClass TextBuffer::_GetDelimiterClass(const std::wstring_vie
 
 // Routine Description:
 // - Retrieves the text data from the selected region and presents it in a clipboard-ready format (given little post-processing).
+// - The colors are gathered per attribute run rather than per cell, so each run's colors are only resolved once.
 // Arguments:
 // - lineSelection - true if entire line is being selected. False otherwise (box selection)
 // - trimTrailingWhitespace - setting flag removes trailing whitespace at the end of each row in selection
@@ -1072,7 +1282,7 @@ TextBuffer::DelimiterClass TextBuffer::_GetDelimiterClass(const std::wstring_vie
 // - GetForegroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
 // - GetBackgroundColor - function used to map TextAttribute to RGB COLORREF for foreground color
 // Return Value:
-// - The text, background color, and foreground color data of the selected region of the text buffer.
+// - The text of the selected region of the text buffer, with the runs of foreground and background colors it is drawn in.
 const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSelection,
                                                                const bool trimTrailingWhitespace,
                                                                const std::vector<SMALL_RECT>& selectionRects,
@@ -1084,64 +1294,76 @@ const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSe
     // preallocate our vectors to reduce reallocs
     size_t const rows = selectionRects.size();
     data.text.reserve(rows);
-    data.FgAttr.reserve(rows);
-    data.BkAttr.reserve(rows);
+    data.runs.reserve(rows);
 
     // for each row in the selection
     for (UINT i = 0; i < rows; i++)
     {
-        const UINT iRow = selectionRects.at(i).Top;
-
-        const Viewport highlight = Viewport::FromInclusive(selectionRects.at(i));
-
-        // retrieve the data from the screen buffer
-        auto it = GetCellDataAt(highlight.Origin(), highlight);
+        const SMALL_RECT& selection = selectionRects.at(i);
+        const ROW& row = GetRowByOffset(selection.Top);
+        const CharRow& charRow = row.GetCharRow();
+        const ATTR_ROW& attrRow = row.GetAttrRow();
 
         // allocate a string buffer
         std::wstring selectionText;
-        std::vector<COLORREF> selectionFgAttr;
-        std::vector<COLORREF> selectionBkAttr;
+        std::vector<TextAndColor::Run> selectionRuns;
 
         // preallocate to avoid reallocs
-        selectionText.reserve(gsl::narrow<size_t>(highlight.Width()) + 2); // + 2 for \r\n if we munged it
-        selectionFgAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
-        selectionBkAttr.reserve(gsl::narrow<size_t>(highlight.Width()) + 2);
+        selectionText.reserve(gsl::narrow<size_t>(selection.Right - selection.Left + 1) + 2); // + 2 for \r\n if we munged it
 
-        // copy char data into the string buffer, skipping trailing bytes
-        while (it)
+        // copy char data into the string buffer, skipping trailing bytes,
+        // and start a new color run wherever the attributes change
+        size_t applies = 0;
+        for (size_t col = gsl::narrow<size_t>(selection.Left); col <= gsl::narrow<size_t>(selection.Right); col++)
         {
-            const auto& cell = *it;
-            auto cellData = cell.TextAttr();
-            COLORREF const CellFgAttr = GetForegroundColor(cellData);
-            COLORREF const CellBkAttr = GetBackgroundColor(cellData);
-
-            if (!cell.DbcsAttr().IsTrailing())
+            if (applies == 0)
             {
-                selectionText.append(cell.Chars());
-                for (const wchar_t wch : cell.Chars())
+                auto attr = attrRow.GetAttrByColumn(col, &applies);
+                COLORREF const runFgAttr = GetForegroundColor(attr);
+                COLORREF const runBkAttr = GetBackgroundColor(attr);
+
+                // a run that only covered trailing bytes holds no text
+                if (!selectionRuns.empty() && selectionRuns.back().length == 0)
+                {
+                    selectionRuns.pop_back();
+                }
+
+                // different attributes can still resolve to the same colors
+                if (selectionRuns.empty() ||
+                    selectionRuns.back().foreground != runFgAttr ||
+                    selectionRuns.back().background != runBkAttr)
                 {
-                    selectionFgAttr.push_back(CellFgAttr);
-                    selectionBkAttr.push_back(CellBkAttr);
+                    selectionRuns.push_back({ 0, runFgAttr, runBkAttr });
                 }
             }
-#pragma warning(suppress : 26444)
-            // TODO GH 2675: figure out why there's custom construction/destruction happening here
-            it++;
+            applies--;
+
+            if (!charRow.DbcsAttrAt(col).IsTrailing())
+            {
+                const std::wstring_view glyph = charRow.GlyphAt(col);
+                selectionText.append(glyph);
+                selectionRuns.back().length += glyph.size();
+            }
+        }
+
+        if (!selectionRuns.empty() && selectionRuns.back().length == 0)
+        {
+            selectionRuns.pop_back();
         }
 
         // trim trailing spaces if SHIFT key not held
         if (trimTrailingWhitespace)
         {
-            const ROW& Row = GetRowByOffset(iRow);
-
             // FOR LINE SELECTION ONLY: if the row was wrapped, don't remove the spaces at the end.
-            if (!lineSelection || !Row.GetCharRow().WasWrapForced())
+            if (!lineSelection || !charRow.WasWrapForced())
             {
                 while (!selectionText.empty() && selectionText.back() == UNICODE_SPACE)
                 {
                     selectionText.pop_back();
-                    selectionFgAttr.pop_back();
-                    selectionBkAttr.pop_back();
+                    if (--selectionRuns.back().length == 0)
+                    {
+                        selectionRuns.pop_back();
+                    }
                 }
             }
 
@@ -1152,28 +1374,84 @@ const TextBuffer::TextAndColor TextBuffer::GetTextForClipboard(const bool lineSe
                 // FOR LINE SELECTION ONLY: if the row was wrapped, do not apply CR/LF.
                 // a.k.a. if the row was NOT wrapped, then we can assume a CR/LF is proper
                 // always apply \r\n for box selection
-                if (!lineSelection || !GetRowByOffset(iRow).GetCharRow().WasWrapForced())
+                if (!lineSelection || !charRow.WasWrapForced())
                 {
                     COLORREF const Blackness = RGB(0x00, 0x00, 0x00); // cant see CR/LF so just use black FG & BK
 
                     selectionText.push_back(UNICODE_CARRIAGERETURN);
                     selectionText.push_back(UNICODE_LINEFEED);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionFgAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
-                    selectionBkAttr.push_back(Blackness);
+                    selectionRuns.push_back({ 2, Blackness, Blackness });
                 }
             }
         }
 
         data.text.emplace_back(std::move(selectionText));
-        data.FgAttr.emplace_back(std::move(selectionFgAttr));
-        data.BkAttr.emplace_back(std::move(selectionBkAttr));
+        data.runs.emplace_back(std::move(selectionRuns));
     }
 
     return data;
 }
 
+// Routine Description:
+// - Calls the given function for each color run of each row, with the part of the row's text the run covers.
+// - Runs are cut short at the first \r or \n of a row, as those end the row and carry no colors.
+// Arguments:
+// - rows - the text and color data to walk
+// - newRow - called with the index of each row before its runs
+// - run - called with the text and colors of each run that has text left
+// Return Value:
+// - <none>
+template<typename NewRowFn, typename RunFn>
+static void _ForEachClipboardRun(const TextBuffer::TextAndColor& rows, NewRowFn newRow, RunFn run)
+{
+    for (size_t row = 0; row < rows.text.size(); row++)
+    {
+        newRow(row);
+
+        const std::wstring_view rowText{ rows.text.at(row) };
+        size_t startOffset = 0;
+        for (const auto& colorRun : rows.runs.at(row))
+        {
+            auto runText = rowText.substr(startOffset, colorRun.length);
+            startOffset += colorRun.length;
+
+            const auto lineEnd = runText.find_first_of(L"\r\n");
+            runText = runText.substr(0, lineEnd);
+            if (!runText.empty())
+            {
+                run(runText, colorRun.foreground, colorRun.background);
+            }
+
+            if (lineEnd != std::wstring_view::npos)
+            {
+                break;
+            }
+        }
+    }
+}
+
+// Routine Description:
+// - Counts the code units of text and the color runs over all of the rows, to size the output of the serializers.
+// Arguments:
+// - rows - the text and color data
+// - textLength - on exit, the total length of the text
+// - runCount - on exit, the total number of color runs
+// Return Value:
+// - <none>
+static void _MeasureClipboardRuns(const TextBuffer::TextAndColor& rows, size_t& textLength, size_t& runCount) noexcept
+{
+    textLength = 0;
+    runCount = 0;
+    for (const auto& text : rows.text)
+    {
+        textLength += text.size();
+    }
+    for (const auto& runs : rows.runs)
+    {
+        runCount += runs.size();
+    }
+}
+
 // Routine Description:
 // - Generates a CF_HTML compliant structure based on the passed in text and color data
 // Arguments:
@@ -1188,156 +1466,127 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows, const int fontHeightPo
 {
     try
     {
-        std::ostringstream htmlBuilder;
+        // Reserve the whole fragment up front: the text, a span for each
+        // color run and a line break for each row, plus the boiler plate.
+        size_t textLength;
+        size_t runCount;
+        _MeasureClipboardRuns(rows, textLength, runCount);
+
+        std::string htmlBuilder;
+        htmlBuilder.reserve(512 + htmlTitle.size() + textLength + runCount * 64 + rows.text.size() * 4);
 
         // First we have to add some standard
         // HTML boiler plate required for CF_HTML
         // as part of the HTML Clipboard format
         const std::string htmlHeader =
             "<!DOCTYPE><HTML><HEAD><TITLE>" + htmlTitle + "</TITLE></HEAD><BODY>";
-        htmlBuilder << htmlHeader;
+        htmlBuilder += htmlHeader;
 
-        htmlBuilder << "<!--StartFragment -->";
+        htmlBuilder += "<!--StartFragment -->";
 
         // apply global style in div element
         {
-            htmlBuilder << "<DIV STYLE=\"";
-            htmlBuilder << "display:inline-block;";
-            htmlBuilder << "white-space:pre;";
-
-            htmlBuilder << "background-color:";
-            htmlBuilder << Utils::ColorToHexString(backgroundColor);
-            htmlBuilder << ";";
-
-            htmlBuilder << "font-family:";
-            htmlBuilder << "'";
-            htmlBuilder << ConvertToA(CP_UTF8, fontFaceName);
-            htmlBuilder << "',";
+            htmlBuilder += "<DIV STYLE=\"";
+            htmlBuilder += "display:inline-block;";
+            htmlBuilder += "white-space:pre;";
+
+            htmlBuilder += "background-color:";
+            htmlBuilder += Utils::ColorToHexString(backgroundColor);
+            htmlBuilder += ";";
+
+            htmlBuilder += "font-family:";
+            htmlBuilder += "'";
+            htmlBuilder += ConvertToA(CP_UTF8, fontFaceName);
+            htmlBuilder += "',";
             // even with different font, add monospace as fallback
-            htmlBuilder << "monospace;";
+            htmlBuilder += "monospace;";
 
-            htmlBuilder << "font-size:";
-            htmlBuilder << fontHeightPoints;
-            htmlBuilder << "pt;";
+            htmlBuilder += "font-size:";
+            htmlBuilder += std::to_string(fontHeightPoints);
+            htmlBuilder += "pt;";
 
             // note: MS Word doesn't support padding (in this way at least)
-            htmlBuilder << "padding:";
-            htmlBuilder << 4; // todo: customizable padding
-            htmlBuilder << "px;";
+            htmlBuilder += "padding:";
+            htmlBuilder += "4"; // todo: customizable padding
+            htmlBuilder += "px;";
 
-            htmlBuilder << "\">";
+            htmlBuilder += "\">";
         }
 
         // copy text and info color from buffer
         bool hasWrittenAnyText = false;
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); row++)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                htmlBuilder << "<BR>";
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); col++)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '<':
-                                htmlBuilder << "&lt;";
-                                break;
-                            case '>':
-                                htmlBuilder << "&gt;";
-                                break;
-                            case '&':
-                                htmlBuilder << "&amp;";
-                                break;
-                            default:
-                                htmlBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
+        _ForEachClipboardRun(
+            rows,
+            [&](const size_t row) {
+                // \r and \n are not HTML friendly. For line break use '<BR>' instead.
+                if (row != 0)
                 {
-                    // do not include \r nor \n as they don't have color attributes
-                    // and are not HTML friendly. For line break use '<BR>' instead.
-                    writeAccumulatedChars(false);
-                    break;
+                    htmlBuilder += "<BR>";
                 }
-
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
+            },
+            [&](const std::wstring_view text, const COLORREF foreground, const COLORREF background) {
+                if (fgColor != foreground || bkColor != background)
                 {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
-                }
-
-                if (colorChanged)
-                {
-                    writeAccumulatedChars(false);
+                    fgColor = foreground;
+                    bkColor = background;
 
                     if (hasWrittenAnyText)
                     {
-                        htmlBuilder << "</SPAN>";
+                        htmlBuilder += "</SPAN>";
                     }
 
-                    htmlBuilder << "<SPAN STYLE=\"";
-                    htmlBuilder << "color:";
-                    htmlBuilder << Utils::ColorToHexString(fgColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "background-color:";
-                    htmlBuilder << Utils::ColorToHexString(bkColor.value());
-                    htmlBuilder << ";";
-                    htmlBuilder << "\">";
+                    htmlBuilder += "<SPAN STYLE=\"";
+                    htmlBuilder += "color:";
+                    htmlBuilder += Utils::ColorToHexString(foreground);
+                    htmlBuilder += ";";
+                    htmlBuilder += "background-color:";
+                    htmlBuilder += Utils::ColorToHexString(background);
+                    htmlBuilder += ";";
+                    htmlBuilder += "\">";
                 }
 
                 hasWrittenAnyText = true;
 
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
+                for (const auto c : ConvertToA(CP_UTF8, text))
                 {
-                    writeAccumulatedChars(true);
+                    switch (c)
+                    {
+                    case '<':
+                        htmlBuilder += "&lt;";
+                        break;
+                    case '>':
+                        htmlBuilder += "&gt;";
+                        break;
+                    case '&':
+                        htmlBuilder += "&amp;";
+                        break;
+                    default:
+                        htmlBuilder += c;
+                    }
                 }
-            }
-        }
+            });
 
         if (hasWrittenAnyText)
         {
             // last opened span wasn't closed in loop above, so close it now
-            htmlBuilder << "</SPAN>";
+            htmlBuilder += "</SPAN>";
         }
 
-        htmlBuilder << "</DIV>";
+        htmlBuilder += "</DIV>";
 
-        htmlBuilder << "<!--EndFragment -->";
+        htmlBuilder += "<!--EndFragment -->";
 
         constexpr std::string_view HtmlFooter = "</BODY></HTML>";
-        htmlBuilder << HtmlFooter;
+        htmlBuilder += HtmlFooter;
 
         // once filled with values, there will be exactly 157 bytes in the clipboard header
         constexpr size_t ClipboardHeaderSize = 157;
 
         // these values are byte offsets from start of clipboard
         const size_t htmlStartPos = ClipboardHeaderSize;
-        const size_t htmlEndPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlBuilder.tellp());
+        const size_t htmlEndPos = ClipboardHeaderSize + htmlBuilder.size();
         const size_t fragStartPos = ClipboardHeaderSize + gsl::narrow<size_t>(htmlHeader.length());
         const size_t fragEndPos = htmlEndPos - HtmlFooter.length();
 
@@ -1352,7 +1601,7 @@ std::string TextBuffer::GenHTML(const TextAndColor& rows, const int fontHeightPo
         clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
         clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
 
-        return clipHeaderBuilder.str() + htmlBuilder.str();
+        return clipHeaderBuilder.str() + htmlBuilder;
     }
     catch (...)
     {
@@ -1376,10 +1625,10 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
 {
     try
     {
-        std::ostringstream rtfBuilder;
+        std::string rtfBuilder;
 
         // start rtf
-        rtfBuilder << "{";
+        rtfBuilder += "{";
 
         // Standard RTF header.
         // This is similar to the header gnerated by WordPad.
@@ -1387,10 +1636,10 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
         // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
         // \deff0 - specifes that the default font for the document is the one at index 0 in the font table
         // \nouicompat - ?
-        rtfBuilder << "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
+        rtfBuilder += "\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat";
 
         // font table
-        rtfBuilder << "{\\fonttbl{\\f0\\fmodern\\fcharset0 " << ConvertToA(CP_UTF8, fontFaceName) << ";}}";
+        rtfBuilder += "{\\fonttbl{\\f0\\fmodern\\fcharset0 " + ConvertToA(CP_UTF8, fontFaceName) + ";}}";
 
         // map to keep track of colors:
         // keys are colors represented by COLORREF
@@ -1399,145 +1648,100 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
         int nextColorIndex = 1; // leave 0 for the default color and start from 1.
 
         // RTF color table
-        std::ostringstream colorTableBuilder;
-        colorTableBuilder << "{\\colortbl ;";
-        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(backgroundColor))
-                          << "\\green" << static_cast<int>(GetGValue(backgroundColor))
-                          << "\\blue" << static_cast<int>(GetBValue(backgroundColor))
-                          << ";";
-        colorMap[backgroundColor] = nextColorIndex++;
+        std::string colorTableBuilder;
+        colorTableBuilder += "{\\colortbl ;";
+
+        // looks up the index of a color in the color table, adding the color if it isn't there yet
+        const auto getColorIndex = [&](const COLORREF color) {
+            const auto found = colorMap.find(color);
+            if (found != colorMap.end())
+            {
+                // color already exists in the map, just retrieve the index
+                return found->second;
+            }
+
+            // color not present in the map, so add it
+            colorTableBuilder += "\\red" + std::to_string(GetRValue(color)) +
+                                 "\\green" + std::to_string(GetGValue(color)) +
+                                 "\\blue" + std::to_string(GetBValue(color)) +
+                                 ";";
+            colorMap.emplace(color, nextColorIndex);
+            return nextColorIndex++;
+        };
+        getColorIndex(backgroundColor);
 
         // content
-        std::ostringstream contentBuilder;
-        contentBuilder << "\\viewkind4\\uc4";
+        // Reserve it up front: the text plus a color switch for each run
+        // and a line break for each row.
+        size_t textLength;
+        size_t runCount;
+        _MeasureClipboardRuns(rows, textLength, runCount);
+
+        std::string contentBuilder;
+        contentBuilder.reserve(64 + textLength + runCount * 24 + rows.text.size() * 6);
+        contentBuilder += "\\viewkind4\\uc4";
 
         // paragraph styles
         // \fs specificies font size in half-points i.e. \fs20 results in a font size
         // of 10 pts. That's why, font size is multiplied by 2 here.
-        contentBuilder << "\\pard\\slmult1\\f0\\fs" << std::to_string(2 * fontHeightPoints)
-                       << "\\highlight1"
-                       << " ";
+        contentBuilder += "\\pard\\slmult1\\f0\\fs" + std::to_string(2 * fontHeightPoints) +
+                          "\\highlight1" +
+                          " ";
 
         std::optional<COLORREF> fgColor = std::nullopt;
         std::optional<COLORREF> bkColor = std::nullopt;
-        for (size_t row = 0; row < rows.text.size(); ++row)
-        {
-            size_t startOffset = 0;
-
-            if (row != 0)
-            {
-                contentBuilder << "\\line "; // new line
-            }
-
-            for (size_t col = 0; col < rows.text.at(row).length(); ++col)
-            {
-                const auto writeAccumulatedChars = [&](bool includeCurrent) {
-                    if (col >= startOffset)
-                    {
-                        const auto unescapedText = ConvertToA(CP_UTF8, std::wstring_view(rows.text.at(row)).substr(startOffset, col - startOffset + includeCurrent));
-                        for (const auto c : unescapedText)
-                        {
-                            switch (c)
-                            {
-                            case '\\':
-                            case '{':
-                            case '}':
-                                contentBuilder << "\\" << c;
-                                break;
-                            default:
-                                contentBuilder << c;
-                            }
-                        }
-
-                        startOffset = col;
-                    }
-                };
-
-                if (rows.text.at(row).at(col) == '\r' || rows.text.at(row).at(col) == '\n')
+        _ForEachClipboardRun(
+            rows,
+            [&](const size_t row) {
+                // \r and \n don't have color attributes. For line break use \line instead.
+                if (row != 0)
                 {
-                    // do not include \r nor \n as they don't have color attributes.
-                    // For line break use \line instead.
-                    writeAccumulatedChars(false);
-                    break;
+                    contentBuilder += "\\line "; // new line
                 }
-
-                bool colorChanged = false;
-                if (!fgColor.has_value() || rows.FgAttr.at(row).at(col) != fgColor.value())
+            },
+            [&](const std::wstring_view text, const COLORREF foreground, const COLORREF background) {
+                if (fgColor != foreground || bkColor != background)
                 {
-                    fgColor = rows.FgAttr.at(row).at(col);
-                    colorChanged = true;
-                }
+                    fgColor = foreground;
+                    bkColor = background;
 
-                if (!bkColor.has_value() || rows.BkAttr.at(row).at(col) != bkColor.value())
-                {
-                    bkColor = rows.BkAttr.at(row).at(col);
-                    colorChanged = true;
+                    const int bkColorIndex = getColorIndex(background);
+                    const int fgColorIndex = getColorIndex(foreground);
+
+                    contentBuilder += "\\highglight" + std::to_string(bkColorIndex) +
+                                      "\\cf" + std::to_string(fgColorIndex) +
+                                      " ";
                 }
 
-                if (colorChanged)
+                for (const auto c : ConvertToA(CP_UTF8, text))
                 {
-                    writeAccumulatedChars(false);
-
-                    int bkColorIndex = 0;
-                    if (colorMap.find(bkColor.value()) != colorMap.end())
+                    switch (c)
                     {
-                        // color already exists in the map, just retrieve the index
-                        bkColorIndex = colorMap[bkColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(bkColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(bkColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(bkColor.value()))
-                                          << ";";
-                        colorMap[bkColor.value()] = nextColorIndex;
-                        bkColorIndex = nextColorIndex++;
-                    }
-
-                    int fgColorIndex = 0;
-                    if (colorMap.find(fgColor.value()) != colorMap.end())
-                    {
-                        // color already exists in the map, just retrieve the index
-                        fgColorIndex = colorMap[fgColor.value()];
-                    }
-                    else
-                    {
-                        // color not present in the map, so add it
-                        colorTableBuilder << "\\red" << static_cast<int>(GetRValue(fgColor.value()))
-                                          << "\\green" << static_cast<int>(GetGValue(fgColor.value()))
-                                          << "\\blue" << static_cast<int>(GetBValue(fgColor.value()))
-                                          << ";";
-                        colorMap[fgColor.value()] = nextColorIndex;
-                        fgColorIndex = nextColorIndex++;
+                    case '\\':
+                    case '{':
+                    case '}':
+                        contentBuilder += '\\';
+                        contentBuilder += c;
+                        break;
+                    default:
+                        contentBuilder += c;
                     }
-
-                    contentBuilder << "\\highglight" << bkColorIndex
-                                   << "\\cf" << fgColorIndex
-                                   << " ";
-                }
-
-                // if this is the last character in the row, flush the whole row
-                if (col == rows.text.at(row).length() - 1)
-                {
-                    writeAccumulatedChars(true);
                 }
-            }
-        }
+            });
 
         // end colortbl
-        colorTableBuilder << "}";
+        colorTableBuilder += "}";
 
         // add color table to the final RTF
-        rtfBuilder << colorTableBuilder.str();
+        rtfBuilder += colorTableBuilder;
 
         // add the text content to the final RTF
-        rtfBuilder << contentBuilder.str();
+        rtfBuilder += contentBuilder;
 
         // end rtf
-        rtfBuilder << "}";
+        rtfBuilder += "}";
 
-        return rtfBuilder.str();
+        return rtfBuilder;
     }
     catch (...)
     {
@@ -1546,17 +1750,73 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
     }
 }
 
+// Routine Description:
+// - Finds how much of an old row a reflow copies. That's everything up to the last printable
+//   character, or the whole row if it wrapped, as the spaces at its end are then part of the line.
+// - If a row wrapped because a leading half didn't fit in its last column, that padding is left out.
+// Arguments:
+// - charRow - the row of the old buffer
+// - oldWidth - the width of the old buffer
+// Return Value:
+// - the column one past the last one to copy
+static short _ReflowRight(const CharRow& charRow, const short oldWidth) noexcept
+{
+    if (charRow.WasWrapForced())
+    {
+        return charRow.WasDoubleBytePadded() ? gsl::narrow_cast<short>(oldWidth - 1) : oldWidth;
+    }
+    return gsl::narrow_cast<short>(charRow.MeasureRight());
+}
+
+// Routine Description:
+// - Moves past one cell the way InsertCharacter moves the cursor: a leading half that would land
+//   in the last column is pushed onto the next row first, and filling the last column wraps.
+// Arguments:
+// - leading - whether the cell is the leading half of a double byte character
+// - width - the width of the new buffer
+void TextBuffer::ReflowPosition::Advance(const bool leading, const ptrdiff_t width) noexcept
+{
+    if (leading && x == width - 1)
+    {
+        Wrap();
+    }
+    if (++x == width)
+    {
+        Wrap();
+    }
+}
+
+void TextBuffer::ReflowPosition::Wrap() noexcept
+{
+    x = 0;
+    ++y;
+    wrapped = true;
+}
+
+void TextBuffer::ReflowPosition::Newline() noexcept
+{
+    x = 0;
+    ++y;
+    wrapped = false;
+}
+
 // Function Description:
 // - Reflow the contents from the old buffer into the new buffer. The new buffer
 //   can have different dimensions than the old buffer. If it does, then this
 //   function will attempt to maintain the logical contents of the old buffer,
 //   by continuing wrapped lines onto the next line in the new buffer.
+// - The lines of the old buffer are measured first, which finds the new row each of them
+//   starts on without writing anything. If visibleRows is given, only the lines that reach
+//   into that many rows above the new cursor, and everything below it, are written right away.
+//   The lines above those are written the first time anything needs one of their rows, so
+//   oldBuffer has to be handed to newBuffer's KeepReflowSource instead of being destroyed.
 // Arguments:
 // - oldBuffer - the text buffer to copy the contents FROM
 // - newBuffer - the text buffer to copy the contents TO
+// - visibleRows - how many rows above the cursor are on screen, or nullopt to write every line right away
 // Return Value:
 // - S_OK if we successfully copied the contents to the new buffer, otherwise an appropriate HRESULT.
-HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
+HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer, const std::optional<short> visibleRows)
 {
     Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
@@ -1572,71 +1832,35 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
 
     short const cOldRowsTotal = cOldLastChar.Y + 1;
     short const cOldColsTotal = oldBuffer.GetSize().Width();
+    const ptrdiff_t cNewRowsTotal = newBuffer.GetSize().Height();
+    const ptrdiff_t cNewColsTotal = newBuffer.GetSize().Width();
 
     COORD cNewCursorPos = { 0 };
     bool fFoundCursorPos = false;
 
     HRESULT hr = S_OK;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
+    try
     {
-        // Fetch the row and its "right" which is the last printable character.
-        const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
-        const CharRow& charRow = row.GetCharRow();
-        short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
-
-        // There is a special case here. If the row has a "wrap"
-        // flag on it, but the right isn't equal to the width (one
-        // index past the final valid index in the row) then there
-        // were a bunch trailing of spaces in the row.
-        // (But the measuring functions for each row Left/Right do
-        // not count spaces as "displayable" so they're not
-        // included.)
-        // As such, adjust the "right" to be the width of the row
-        // to capture all these spaces
-        if (charRow.WasWrapForced())
+        // Walk the old rows the way the new cursor moves while they're written out, to find
+        // where every line of the old buffer starts. A line ends at the first row that has
+        // neither wrapped nor been filled up to its last column.
+        std::vector<ReflowLine> lines;
+        ReflowLine line{};
+        ReflowPosition position{};
+        std::optional<ReflowPosition> cursorPosition;
+        for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
         {
-            iRight = cOldColsTotal;
-
-            // And a combined special case.
-            // If we wrapped off the end of the row by adding a
-            // piece of padding because of a double byte LEADING
-            // character, then remove one from the "right" to
-            // leave this padding out of the copy process.
-            if (charRow.WasDoubleBytePadded())
+            const CharRow& charRow = oldBuffer.GetRowByOffset(iOldRow).GetCharRow();
+            const short iRight = _ReflowRight(charRow, cOldColsTotal);
+            for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
             {
-                iRight--;
-            }
-        }
-
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
-        {
-            if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
-            {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
-            }
-
-            try
-            {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
-                const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
-
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
+                if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
                 {
-                    hr = E_OUTOFMEMORY;
-                    break;
+                    cursorPosition = position;
                 }
+                position.Advance(charRow.DbcsAttrAt(iOldCol).IsLeading(), cNewColsTotal);
             }
-            CATCH_RETURN();
-        }
-        if (SUCCEEDED(hr))
-        {
+
             // If we didn't have a full row to copy, insert a new
             // line into the new buffer.
             // Only do so if we were not forced to wrap. If we did
@@ -1646,8 +1870,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
             {
                 if (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
                 {
-                    cNewCursorPos = newCursor.GetPosition();
-                    fFoundCursorPos = true;
+                    cursorPosition = position;
                 }
                 // Only do this if it's not the final line in the buffer.
                 // On the final line, we want the cursor to sit
@@ -1655,9 +1878,14 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
                 // adjustment to follow.
                 if (iOldRow < cOldRowsTotal - 1)
                 {
-                    hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                    line.lastRow = gsl::narrow_cast<size_t>(iOldRow);
+                    lines.push_back(line);
+
+                    position.Newline();
+                    line.firstRow = line.lastRow + 1;
+                    line.top = position.y;
                 }
-                else
+                else if (position.x == 0 && position.y > 0 && position.wrapped)
                 {
                     // If we are on the final line of the buffer, we have one more check.
                     // We got into this code path because we are at the right most column of a row in the old buffer
@@ -1683,18 +1911,66 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
                     // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
                     // |                   |
                     //  ^ and the cursor is now here.
-                    const COORD coordNewCursor = newCursor.GetPosition();
-                    if (coordNewCursor.X == 0 && coordNewCursor.Y > 0)
-                    {
-                        if (newBuffer.GetRowByOffset(gsl::narrow_cast<size_t>(coordNewCursor.Y) - 1).GetCharRow().WasWrapForced())
-                        {
-                            hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
-                        }
-                    }
+                    position.Newline();
                 }
             }
         }
+        line.lastRow = gsl::narrow_cast<size_t>(cOldRowsTotal) - 1;
+        lines.push_back(line);
+
+        // The rows that don't fit push the ones at the top off, like NewlineCursor would have while writing.
+        const ptrdiff_t scrolled = std::max<ptrdiff_t>(position.y - (cNewRowsTotal - 1), 0);
+
+        // If we found where to put the cursor, it goes where the new cursor was when it got to that cell.
+        // Nothing had been pushed off the top for the rows after it yet.
+        if (cursorPosition.has_value())
+        {
+            cNewCursorPos.X = gsl::narrow<short>(cursorPosition->x);
+            cNewCursorPos.Y = gsl::narrow<short>(std::min(cursorPosition->y, cNewRowsTotal - 1));
+            fFoundCursorPos = true;
+        }
+
+        // Only the lines that reach into the rows on screen around the cursor are written now.
+        size_t firstWritten = 0;
+        if (visibleRows.has_value())
+        {
+            const ptrdiff_t cursorRow = fFoundCursorPos ? cNewCursorPos.Y + scrolled : position.y;
+            const ptrdiff_t shownFrom = cursorRow - visibleRows.value() + 1;
+            while (firstWritten + 1 < lines.size() && lines.at(firstWritten + 1).top <= shownFrom)
+            {
+                ++firstWritten;
+            }
+        }
+
+        for (auto i = firstWritten; i < lines.size(); ++i)
+        {
+            newBuffer._WriteReflowLine(oldBuffer, lines.at(i), scrolled);
+        }
+
+        // The ones above are left for later, except for those that have been pushed off the top anyway.
+        size_t firstKept = 0;
+        while (firstKept < firstWritten && lines.at(firstKept + 1).top <= scrolled)
+        {
+            ++firstKept;
+        }
+        if (firstKept < firstWritten)
+        {
+            auto pending = std::make_unique<PendingReflow>();
+            pending->source = &oldBuffer;
+            pending->lines.assign(lines.cbegin() + gsl::narrow_cast<ptrdiff_t>(firstKept),
+                                  lines.cbegin() + gsl::narrow_cast<ptrdiff_t>(firstWritten));
+            pending->written = lines.at(firstWritten).top;
+            pending->scrolled = scrolled;
+            newBuffer._pendingReflow = std::move(pending);
+        }
+
+        newCursor.SetPosition({ gsl::narrow<short>(position.x), gsl::narrow<short>(position.y - scrolled) });
     }
+    catch (...)
+    {
+        hr = wil::ResultFromCaughtException();
+    }
+
     if (SUCCEEDED(hr))
     {
         // Finish copying remaining parameters from the old text buffer to the new one
@@ -1760,6 +2036,13 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
 
         // Set size back to real size as it will be taking over the rendering duties.
         newCursor.SetSize(ulSize);
+
+        // Rows written above the compression threshold while reflowing are still expanded.
+        try
+        {
+            newBuffer.CompressScrollback();
+        }
+        CATCH_LOG();
     }
 
     newCursor.EndDeferDrawing();
@@ -1767,3 +2050,116 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer)
 
     return hr;
 }
+
+// Routine Description:
+// - Takes over the buffer that a reflow into this one left lines to write from, see Reflow.
+//   It's let go once there is nothing left to write from it.
+// Arguments:
+// - oldBuffer - the buffer that was reflowed into this one
+void TextBuffer::KeepReflowSource(std::unique_ptr<TextBuffer> oldBuffer) noexcept
+{
+    if (_pendingReflow && _pendingReflow->source == oldBuffer.get())
+    {
+        _pendingReflow->owner = std::move(oldBuffer);
+    }
+}
+
+// Routine Description:
+// - Checks whether the row at the given offset is one that a reflow hasn't written yet.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+bool TextBuffer::_IsReflowPending(const size_t index) const noexcept
+{
+    return _pendingReflow && gsl::narrow_cast<ptrdiff_t>(index) < _pendingReflow->written - _pendingReflow->scrolled;
+}
+
+// Routine Description:
+// - Writes the lines that a reflow left for later and lets go of the buffer they came from.
+void TextBuffer::_FinishReflow()
+{
+    // Take the job first, the lines are written through GetRowByOffset as well.
+    const auto pending = std::move(_pendingReflow);
+    for (const auto& line : pending->lines)
+    {
+        _WriteReflowLine(*pending->source, line, pending->scrolled);
+    }
+
+    // The rows beyond the compression threshold were passed over while they were waiting.
+    CompressScrollback();
+}
+
+// Routine Description:
+// - Writes one line of a buffer that is being reflowed into this one. The cells are placed where
+//   InsertCharacter would put them at the cursor, but the cursor isn't moved: a leading half that
+//   would land in the last column is pushed onto the next row, and filling the last column wraps.
+// - Cells that land on rows that have been pushed off the top are skipped.
+// Arguments:
+// - oldBuffer - the buffer being reflowed
+// - line - the old rows to write and the row they start on
+// - scrolled - how many rows have been pushed off the top of this buffer
+void TextBuffer::_WriteReflowLine(const TextBuffer& oldBuffer, const ReflowLine& line, const ptrdiff_t scrolled)
+{
+    const short oldWidth = oldBuffer.GetSize().Width();
+    const ptrdiff_t newWidth = GetSize().Width();
+    ReflowPosition position{ 0, line.top - scrolled, false };
+
+    const auto wrap = [&](const bool padded) {
+        if (position.y >= 0)
+        {
+            CharRow& charRow = GetRowByOffset(gsl::narrow_cast<size_t>(position.y)).GetCharRow();
+            charRow.SetWrapForced(true);
+            if (padded)
+            {
+                charRow.SetDoubleBytePadded(true);
+            }
+        }
+        position.Wrap();
+    };
+
+    for (auto iOldRow = line.firstRow; iOldRow <= line.lastRow; iOldRow++)
+    {
+        const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
+        const CharRow& charRow = row.GetCharRow();
+        const short iRight = _ReflowRight(charRow, oldWidth);
+
+        // Attributes are read a run at a time instead of looking up the run again for every column.
+        // The new buffer's row doesn't need any work for a cell whose color matches the run it's
+        // written into, see ATTR_ROW::SetAttrToEnd.
+        TextAttribute textAttr;
+        size_t attrApplies = 0;
+        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        {
+            if (attrApplies == 0)
+            {
+                textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol, &attrApplies);
+            }
+            --attrApplies;
+
+            const auto dbcsAttr = charRow.DbcsAttrAt(iOldCol);
+            if (position.y >= 0)
+            {
+                const COORD at{ gsl::narrow_cast<short>(position.x), gsl::narrow_cast<short>(position.y) };
+                FAIL_FAST_IF(!(_AssertValidDoubleByteSequence(dbcsAttr, at))); // Shouldn't be uncorrectable sequences unless something is very wrong.
+            }
+
+            if (dbcsAttr.IsLeading() && position.x == newWidth - 1)
+            {
+                wrap(true);
+            }
+
+            if (position.y >= 0)
+            {
+                ROW& newRow = GetRowByOffset(gsl::narrow_cast<size_t>(position.y));
+                const auto column = gsl::narrow_cast<size_t>(position.x);
+                newRow.GetCharRow().GlyphAt(column) = std::wstring_view{ charRow.GlyphAt(iOldCol) };
+                newRow.GetCharRow().DbcsAttrAt(column) = dbcsAttr;
+                THROW_HR_IF(E_OUTOFMEMORY, !newRow.GetAttrRow().SetAttrToEnd(gsl::narrow_cast<UINT>(column), textAttr));
+            }
+
+            if (++position.x == newWidth)
+            {
+                wrap(false);
+            }
+        }
+    }
+}
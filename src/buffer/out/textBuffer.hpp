@@ -52,7 +52,6 @@ filling in the last row, and updating the screen.
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
-#include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "../buffer/out/textBufferCellIterator.hpp"
@@ -95,6 +94,16 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    struct WriteRunResult
+    {
+        size_t inputConsumed; // UTF-16 code units taken from the text
+        size_t cellsAdvanced; // columns the write position moved to the right
+    };
+
+    WriteRunResult WriteRun(const std::wstring_view text,
+                            const TextAttribute attr,
+                            const COORD target);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -114,9 +123,13 @@ public:
     const Microsoft::Console::Types::Viewport GetSize() const;
 
     void ScrollRows(const SHORT firstRow, const SHORT size, const SHORT delta);
+    void CopyRectangle(const Microsoft::Console::Types::Viewport& source, const COORD targetOrigin);
 
     UINT TotalRowCount() const noexcept;
 
+    void SetScrollbackCompressionThreshold(const std::optional<size_t> rows);
+    void CompressScrollback();
+
     [[nodiscard]] TextAttribute GetCurrentAttributes() const noexcept;
 
     void SetCurrentAttributes(const TextAttribute currentAttributes) noexcept;
@@ -125,9 +138,6 @@ public:
 
     [[nodiscard]] HRESULT ResizeTraditional(const COORD newSize) noexcept;
 
-    const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    UnicodeStorage& GetUnicodeStorage() noexcept;
-
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
     const COORD GetWordStart(const COORD target, const std::wstring_view wordDelimiters, bool includeCharacterRun = false) const;
@@ -136,9 +146,16 @@ public:
     class TextAndColor
     {
     public:
+        // A stretch of a row's text that is drawn in the same colors.
+        struct Run
+        {
+            size_t length; // in UTF-16 code units
+            COLORREF foreground;
+            COLORREF background;
+        };
+
         std::vector<std::wstring> text;
-        std::vector<std::vector<COLORREF>> FgAttr;
-        std::vector<std::vector<COLORREF>> BkAttr;
+        std::vector<std::vector<Run>> runs; // for each row, covering all of its text in order
     };
 
     const TextAndColor GetTextForClipboard(const bool lineSelection,
@@ -158,26 +175,72 @@ public:
                               const std::wstring_view fontFaceName,
                               const COLORREF backgroundColor);
 
-    static HRESULT Reflow(TextBuffer& oldBuffer, TextBuffer& newBuffer);
+    static HRESULT Reflow(TextBuffer& oldBuffer,
+                          TextBuffer& newBuffer,
+                          const std::optional<short> visibleRows = std::nullopt);
+    void KeepReflowSource(std::unique_ptr<TextBuffer> oldBuffer) noexcept;
 
 private:
-    std::deque<ROW> _storage;
+    // One contiguous block of rows used as a circular buffer. _firstRow is the slot of the top row.
+    std::vector<ROW> _storage;
     Cursor _cursor;
 
     SHORT _firstRow; // indexes top row (not necessarily 0)
 
     TextAttribute _currentAttributes;
 
-    // storage location for glyphs that can't fit into the buffer normally
-    UnicodeStorage _unicodeStorage;
+    // rows further than this above the cursor are kept compressed until they're written again
+    std::optional<size_t> _compressionThreshold;
+
+    // the offset of the next row checked for recompression by IncrementCircularBuffer
+    size_t _compressionSweep;
+
+    // Where the cursor would be while a reflow writes out the old lines. Rows are counted from the
+    // top of everything that's written, so a row past the bottom is one that pushed the top row off.
+    struct ReflowPosition
+    {
+        ptrdiff_t x;
+        ptrdiff_t y;
+        bool wrapped; // whether it got onto this row by wrapping off the end of the one above
+
+        void Advance(const bool leading, const ptrdiff_t width) noexcept;
+        void Wrap() noexcept;
+        void Newline() noexcept;
+    };
+
+    // A line of the old buffer: the old rows it was on and the new row it starts on.
+    struct ReflowLine
+    {
+        size_t firstRow;
+        size_t lastRow;
+        ptrdiff_t top; // counted like ReflowPosition::y
+    };
+
+    // The lines a reflow left to be written the first time one of their rows is needed.
+    struct PendingReflow
+    {
+        const TextBuffer* source;
+        std::unique_ptr<TextBuffer> owner; // the source, once KeepReflowSource hands it over
+        std::vector<ReflowLine> lines;
+        ptrdiff_t written; // the top of the first line that was written right away
+        ptrdiff_t scrolled; // how many rows have scrolled off the top of the buffer since
+    };
+    std::unique_ptr<PendingReflow> _pendingReflow;
+
+    bool _IsReflowPending(const size_t index) const noexcept;
+    void _FinishReflow();
+    void _WriteReflowLine(const TextBuffer& oldBuffer, const ReflowLine& line, const ptrdiff_t scrolled);
 
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
+    void _RotateRows(const SHORT first, const SHORT middle, const SHORT last);
+    void _CompressRow(const size_t index);
+    void _SweepCompression();
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
 
     void _SetFirstRowIndex(const SHORT FirstRowIndex) noexcept;
 
-    COORD _GetPreviousFromCursor() const;
+    COORD _GetPreviousFrom(const COORD position) const;
 
     void _SetWrapOnCurrentRow();
     void _AdjustWrapOnCurrentRow(const bool fSet);
@@ -186,7 +249,7 @@ private:
 
     // Assist with maintaining proper buffer state for Double Byte character sequences
     bool _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
-    bool _AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribute);
+    bool _AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttribute, const COORD position);
 
     ROW& _GetFirstRow();
     ROW& _GetPrevRowNoWrap(const ROW& row);
@@ -15,37 +15,81 @@ class UnicodeStorageTests
 {
     TEST_CLASS(UnicodeStorageTests);
 
-    TEST_METHOD(CanOverwriteEmoji)
+    TEST_METHOD(CanStoreMultipleGlyphs)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
-        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
-        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
-
-        // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
-
-        // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
-        for (size_t i = 0; i < newMoon.size(); ++i)
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
+
+        // store both glyphs
+        const auto newMoonKey = storage.StoreGlyph(newMoon);
+        const auto fullMoonKey = storage.StoreGlyph(fullMoon);
+        VERIFY_ARE_NOT_EQUAL(newMoonKey, fullMoonKey);
+
+        // verify that each key still leads to its own glyph
+        VERIFY_ARE_EQUAL(String(newMoon.data(), gsl::narrow<int>(newMoon.size())),
+                         String(storage.GetText(newMoonKey).data(), gsl::narrow<int>(storage.GetText(newMoonKey).size())));
+        VERIFY_ARE_EQUAL(String(fullMoon.data(), gsl::narrow<int>(fullMoon.size())),
+                         String(storage.GetText(fullMoonKey).data(), gsl::narrow<int>(storage.GetText(fullMoonKey).size())));
+    }
+
+    TEST_METHOD(RequestsCompactionOnceGrown)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
+
+        VERIFY_IS_FALSE(storage.NeedsCompaction(fullMoon));
+
+        // keep overwriting the same glyph like a single cell would
+        while (!storage.NeedsCompaction(fullMoon))
         {
-            VERIFY_ARE_EQUAL(newMoonGlyph.at(i), newMoon.at(i));
+            storage.StoreGlyph(fullMoon);
         }
 
-        // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        // after compacting down to a single glyph, there should be room again
+        storage.Reset();
+        storage.StoreGlyph(fullMoon);
+        storage.MarkCompacted();
+        VERIFY_IS_FALSE(storage.NeedsCompaction(fullMoon));
+    }
+
+    TEST_METHOD(CanStoreMoreTextThanAKeyCanAddress)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
 
-        // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
-        for (size_t i = 0; i < fullMoon.size(); ++i)
+        // a very wide row full of surrogate pairs needs more code units than fit in a key
+        const size_t glyphCount = 40000;
+        std::vector<UnicodeStorage::key_type> keys;
+        for (size_t i = 0; i < glyphCount; ++i)
         {
-            VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
+            keys.push_back(storage.StoreGlyph(i % 2 ? fullMoon : newMoon));
         }
+        VERIFY_IS_GREATER_THAN(storage.size(), static_cast<size_t>(std::numeric_limits<UnicodeStorage::key_type>::max()));
+
+        for (size_t i = glyphCount - 2; i < glyphCount; ++i)
+        {
+            const auto expected = i % 2 ? fullMoon : newMoon;
+            const auto actual = storage.GetText(keys.at(i));
+            VERIFY_ARE_EQUAL(String(expected.data(), gsl::narrow<int>(expected.size())),
+                             String(actual.data(), gsl::narrow<int>(actual.size())));
+        }
+    }
+
+    TEST_METHOD(RequestsCompactionOnceOutOfKeys)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view zeroWidthJoiner{ L"\x200D" };
+
+        // every key gets used, then the owner has to compact before storing more
+        for (size_t i = 0; i <= std::numeric_limits<UnicodeStorage::key_type>::max(); ++i)
+        {
+            storage.StoreGlyph(zeroWidthJoiner);
+        }
+        storage.MarkCompacted();
+
+        VERIFY_IS_TRUE(storage.NeedsCompaction(zeroWidthJoiner));
+        VERIFY_THROWS(storage.StoreGlyph(zeroWidthJoiner), wil::ResultException);
     }
 };
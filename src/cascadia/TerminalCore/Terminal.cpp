@@ -414,44 +414,33 @@ Viewport Terminal::_GetVisibleViewport() const noexcept
 void Terminal::_WriteBuffer(const std::wstring_view& stringView)
 {
     auto& cursor = _buffer->GetCursor();
+    const auto attributes = _buffer->GetCurrentAttributes();
 
     // Defer the cursor drawing while we are iterating the string, for a better performance.
     // We can not waste time displaying a cursor event when we know more text is coming right behind it.
     cursor.StartDeferDrawing();
 
-    for (size_t i = 0; i < stringView.size(); i++)
+    // Write the string a row at a time. Each pass fills as much of the cursor's row
+    // as fits, so the cursor and viewport only need to be adjusted once per row.
+    size_t i = 0;
+    while (i < stringView.size())
     {
-        const auto wch = stringView.at(i);
         const COORD cursorPosBefore = cursor.GetPosition();
         COORD proposedCursorPosition = cursorPosBefore;
 
-        // TODO: MSFT 21006766
-        // This is not great but I need it demoable. Fix by making a buffer stream writer.
-        //
-        // If wch is a surrogate character we need to read 2 code units
-        // from the stringView to form a single code point.
-        const auto isSurrogate = wch >= 0xD800 && wch <= 0xDFFF;
-        const auto view = stringView.substr(i, isSurrogate ? 2 : 1);
-        const OutputCellIterator it{ view, _buffer->GetCurrentAttributes() };
-        const auto end = _buffer->Write(it);
-        const auto cellDistance = end.GetCellDistance(it);
-        const auto inputDistance = end.GetInputDistance(it);
-
-        if (inputDistance > 0)
+        const auto result = _buffer->WriteRun(stringView.substr(i), attributes, cursorPosBefore);
+
+        if (result.inputConsumed > 0)
         {
-            // If "wch" was a surrogate character, we just consumed 2 code units above.
-            // -> Increment "i" by 1 in that case and thus by 2 in total in this iteration.
-            proposedCursorPosition.X += gsl::narrow<SHORT>(cellDistance);
-            i += inputDistance - 1;
+            proposedCursorPosition.X += gsl::narrow<SHORT>(result.cellsAdvanced);
+            i += result.inputConsumed;
         }
         else
         {
-            // If _WriteBuffer() is called with a consecutive string longer than the viewport/buffer width
-            // the call to _buffer->Write() will refuse to write anything on the current line.
-            // GetInputDistance() thus returns 0, which would in turn cause i to be
-            // decremented by 1 below and force the outer loop to loop forever.
-            // This if() basically behaves as if "\r\n" had been encountered above and retries the write.
-            // With well behaving shells during normal operation this safeguard should normally not be encountered.
+            // If the cursor is already at the end of the row (or the next glyph is
+            // full width and only one column is left) WriteRun() can't write anything
+            // on the current line. This basically behaves as if "\r\n" had been
+            // encountered and retries the write on the next line.
             proposedCursorPosition.X = 0;
             proposedCursorPosition.Y++;
         }
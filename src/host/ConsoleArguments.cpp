@@ -18,6 +18,7 @@ const std::wstring_view ConsoleArguments::FILEPATH_LEADER_PREFIX = L"\\??\\";
 const std::wstring_view ConsoleArguments::WIDTH_ARG = L"--width";
 const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
+const std::wstring_view ConsoleArguments::FRAME_DIFF_ARG = L"--framediff";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 
@@ -114,6 +115,7 @@ ConsoleArguments::ConsoleArguments(const std::wstring& commandline,
     _width = 0;
     _height = 0;
     _inheritCursor = false;
+    _frameDiff = false;
 }
 
 ConsoleArguments::ConsoleArguments() :
@@ -138,6 +140,7 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments& other)
         _width = other._width;
         _height = other._height;
         _inheritCursor = other._inheritCursor;
+        _frameDiff = other._frameDiff;
         _recievedEarlySizeChange = other._recievedEarlySizeChange;
     }
 
@@ -479,6 +482,12 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == FRAME_DIFF_ARG)
+        {
+            _frameDiff = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -612,6 +621,11 @@ bool ConsoleArguments::GetInheritCursor() const
     return _inheritCursor;
 }
 
+bool ConsoleArguments::GetFrameDiff() const
+{
+    return _frameDiff;
+}
+
 // Method Description:
 // - Tell us to use a different size than the one parsed as the size of the
 //      console. This is called by the PtySignalInputThread when it receives a
@@ -50,6 +50,7 @@ public:
     short GetWidth() const;
     short GetHeight() const;
     bool GetInheritCursor() const;
+    bool GetFrameDiff() const;
 
     void SetExpectedSize(COORD dimensions) noexcept;
 
@@ -68,6 +69,7 @@ public:
     static const std::wstring_view WIDTH_ARG;
     static const std::wstring_view HEIGHT_ARG;
     static const std::wstring_view INHERIT_CURSOR_ARG;
+    static const std::wstring_view FRAME_DIFF_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
 
@@ -100,6 +102,7 @@ private:
         _serverHandle(serverHandle),
         _signalHandle(signalHandle),
         _inheritCursor(inheritCursor),
+        _frameDiff{ false },
         _recievedEarlySizeChange{ false },
         _originalWidth{ -1 },
         _originalHeight{ -1 }
@@ -127,6 +130,7 @@ private:
     DWORD _serverHandle;
     DWORD _signalHandle;
     bool _inheritCursor;
+    bool _frameDiff;
 
     bool _recievedEarlySizeChange;
     short _originalWidth;
@@ -177,8 +181,9 @@ namespace WEX
                                                            L"Create Server Handle: '%ws',\r\n"
                                                            L"Server Handle: '0x%x'\r\n"
                                                            L"Use Signal Handle: '%ws'\r\n"
-                                                           L"Signal Handle: '0x%x'\r\n",
-                                                           L"Inherit Cursor: '%ws'\r\n",
+                                                           L"Signal Handle: '0x%x'\r\n"
+                                                           L"Inherit Cursor: '%ws'\r\n"
+                                                           L"Frame Diff: '%ws'\r\n",
                                                            ci.GetClientCommandline().c_str(),
                                                            s_ToBoolString(ci.HasVtHandles()),
                                                            ci.GetVtInHandle(),
@@ -192,7 +197,8 @@ namespace WEX
                                                            ci.GetServerHandle(),
                                                            s_ToBoolString(ci.HasSignalHandle()),
                                                            ci.GetSignalHandle(),
-                                                           s_ToBoolString(ci.GetInheritCursor()));
+                                                           s_ToBoolString(ci.GetInheritCursor()),
+                                                           s_ToBoolString(ci.GetFrameDiff()));
             }
 
         private:
@@ -221,7 +227,8 @@ namespace WEX
                        expected.GetServerHandle() == actual.GetServerHandle() &&
                        expected.HasSignalHandle() == actual.HasSignalHandle() &&
                        expected.GetSignalHandle() == actual.GetSignalHandle() &&
-                       expected.GetInheritCursor() == actual.GetInheritCursor();
+                       expected.GetInheritCursor() == actual.GetInheritCursor() &&
+                       expected.GetFrameDiff() == actual.GetFrameDiff();
             }
 
             static bool AreSame(const ConsoleArguments& expected, const ConsoleArguments& actual)
@@ -246,7 +253,8 @@ namespace WEX
                        !object.ShouldCreateServerHandle() &&
                        object.GetServerHandle() == 0 &&
                        (object.GetSignalHandle() == 0 || object.GetSignalHandle() == INVALID_HANDLE_VALUE) &&
-                       !object.GetInheritCursor();
+                       !object.GetInheritCursor() &&
+                       !object.GetFrameDiff();
             }
         };
     }
@@ -18,6 +18,17 @@
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Interactivity;
 using namespace Microsoft::Console::VirtualTerminal;
+
+// Reads start out small, since most input is typed a few keys at a time. When
+// a read takes all it was allowed to (someone is pasting), the next one is
+// allowed to take twice as much, up to the maximum. A paste often arrives in
+// bursts with short reads in between, so the read size only goes back to the
+// minimum after several short reads in a row, and the buffer keeps what it
+// grew to rather than being reallocated for every burst.
+static constexpr size_t s_MinimumReadSize = 4096;
+static constexpr size_t s_MaximumReadSize = 128 * 1024;
+static constexpr size_t s_ShortReadsBeforeShrinking = 8;
+
 // Constructor Description:
 // - Creates the VT Input Thread.
 // Arguments:
@@ -28,10 +39,12 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
                              const bool inheritCursor) :
     _hFile{ std::move(hPipe) },
     _hThread{},
-    _utf8Parser{ CP_UTF8 },
     _dwThreadId{ 0 },
     _exitRequested{ false },
-    _exitResult{ S_OK }
+    _exitResult{ S_OK },
+    _buffer(s_MinimumReadSize),
+    _readSize{ s_MinimumReadSize },
+    _shortReads{ 0 }
 {
     THROW_HR_IF(E_HANDLE, _hFile.get() == INVALID_HANDLE_VALUE);
 
@@ -49,13 +62,13 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 // Method Description:
 // - Processes a buffer of input characters. The characters should be utf-8
 //      encoded, and will get converted to wchar_t's to be processed by the
-//      input state machine.
+//      input state machine. The whole buffer is handled under one lock.
 // Arguments:
-// - charBuffer - the UTF-8 characters recieved.
-// - cch - number of UTF-8 characters in charBuffer
+// - input - the UTF-8 characters recieved. A code point cut off at the end
+//      is kept until the next call completes it.
 // Return Value:
 // - S_OK on success, otherwise an appropriate failure.
-[[nodiscard]] HRESULT VtInputThread::_HandleRunInput(_In_reads_(cch) const byte* const charBuffer, const int cch)
+[[nodiscard]] HRESULT VtInputThread::_HandleRunInput(const std::string_view input)
 {
     // Make sure to call the GLOBAL Lock/Unlock, not the gci's lock/unlock.
     // Only the global unlock attempts to dispatch ctrl events. If you use the
@@ -67,16 +80,7 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
 
     try
     {
-        std::unique_ptr<wchar_t[]> pwsSequence;
-        unsigned int cchConsumed;
-        unsigned int cchSequence;
-        auto hr = _utf8Parser.Parse(charBuffer, cch, cchConsumed, pwsSequence, cchSequence);
-        // If we hit a parsing error, eat it. It's bad utf-8, we can't do anything with it.
-        if (FAILED(hr))
-        {
-            return S_FALSE;
-        }
-        _pInputStateMachine->ProcessString({ pwsSequence.get(), cchSequence });
+        _pInputStateMachine->ProcessUtf8(input);
     }
     CATCH_RETURN();
 
@@ -105,9 +109,8 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    byte buffer[256];
     DWORD dwRead = 0;
-    bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
+    bool fSuccess = !!ReadFile(_hFile.get(), _buffer.data(), gsl::narrow<DWORD>(_readSize), &dwRead, nullptr);
 
     // If we failed to read because the terminal broke our pipe (usually due
     //      to dying itself), close gracefully with ERROR_BROKEN_PIPE.
@@ -120,7 +123,26 @@ void VtInputThread::DoReadInput(const bool throwOnFail)
         return;
     }
 
-    HRESULT hr = _HandleRunInput(buffer, dwRead);
+    HRESULT hr = _HandleRunInput({ _buffer.data(), dwRead });
+
+    if (dwRead == _readSize)
+    {
+        _shortReads = 0;
+        if (_readSize < s_MaximumReadSize)
+        {
+            _readSize *= 2;
+            if (_buffer.size() < _readSize)
+            {
+                _buffer.resize(_readSize);
+            }
+        }
+    }
+    else if (_readSize > s_MinimumReadSize && ++_shortReads >= s_ShortReadsBeforeShrinking)
+    {
+        _readSize = s_MinimumReadSize;
+        _shortReads = 0;
+    }
+
     if (FAILED(hr))
     {
         if (throwOnFail)
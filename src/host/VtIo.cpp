@@ -25,6 +25,7 @@ VtIo::VtIo() :
     _initialized(false),
     _objectsCreated(false),
     _lookingForCursorPosition(false),
+    _frameDiff(false),
     _IoMode(VtIoMode::INVALID)
 {
 }
@@ -73,6 +74,7 @@ VtIo::VtIo() :
 [[nodiscard]] HRESULT VtIo::Initialize(const ConsoleArguments* const pArgs)
 {
     _lookingForCursorPosition = pArgs->GetInheritCursor();
+    _frameDiff = pArgs->GetFrameDiff();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -192,6 +194,13 @@ VtIo::VtIo() :
             if (_pVtRenderEngine)
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
+
+                // Frame diffing only applies to the UTF-8 xterm modes. The
+                //      ASCII and telnet modes are left exactly as they were.
+                if (_frameDiff && (_IoMode == VtIoMode::XTERM_256 || _IoMode == VtIoMode::XTERM))
+                {
+                    _pVtRenderEngine->SetFrameDiffing(true);
+                }
             }
         }
     }
@@ -55,6 +55,7 @@ namespace Microsoft::Console::VirtualTerminal
         bool _objectsCreated;
 
         bool _lookingForCursorPosition;
+        bool _frameDiff;
         std::mutex _shutdownLock;
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
@@ -132,7 +132,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 //   from the input buffer and in the peek case they are not.
 // Arguments:
 // - pInputBuffer - The input buffer to take records from to return to the client
-// - outEvents - The storage location to fill with input events
+// - outRecords - The storage location to fill with input records
 // - eventReadCount - The number of events to read
 // - pInputReadHandleData - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -152,7 +152,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // block, this will be returned along with context in *ppWaiter.
 // - Or an out of memory/math/string error message in NTSTATUS format.
 [[nodiscard]] static NTSTATUS _DoGetConsoleInput(InputBuffer& inputBuffer,
-                                                 std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                 std::vector<INPUT_RECORD>& outRecords,
                                                  const size_t eventReadCount,
                                                  INPUT_READ_HANDLE_DATA& readHandleState,
                                                  const bool IsUnicode,
@@ -171,37 +171,41 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         LockConsole();
         auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
-        std::deque<std::unique_ptr<IInputEvent>> partialEvents;
+        std::vector<INPUT_RECORD> partialRecords;
         if (!IsUnicode)
         {
             if (inputBuffer.IsReadPartialByteSequenceAvailable())
             {
-                partialEvents.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek));
+                partialRecords.push_back(inputBuffer.FetchReadPartialByteSequence(IsPeek)->ToInputRecord());
             }
         }
 
         size_t amountToRead;
-        if (FAILED(SizeTSub(eventReadCount, partialEvents.size(), &amountToRead)))
+        if (FAILED(SizeTSub(eventReadCount, partialRecords.size(), &amountToRead)))
         {
             return STATUS_INTEGER_OVERFLOW;
         }
-        std::deque<std::unique_ptr<IInputEvent>> readEvents;
-        NTSTATUS Status = inputBuffer.Read(readEvents,
-                                           amountToRead,
+        // We can never read more records than are stored, so don't make
+        // room for any more than that.
+        std::vector<INPUT_RECORD> readRecords(std::min(amountToRead, inputBuffer.GetNumberOfReadyEvents()));
+        size_t recordsRead;
+        NTSTATUS Status = inputBuffer.Read(readRecords,
+                                           recordsRead,
                                            IsPeek,
                                            true,
                                            IsUnicode,
                                            false);
+        readRecords.resize(recordsRead);
 
         if (CONSOLE_STATUS_WAIT == Status)
         {
-            FAIL_FAST_IF(!(readEvents.empty()));
+            FAIL_FAST_IF(!(readRecords.empty()));
             // If we're told to wait until later, move all of our context
             // to the read data object and send it back up to the server.
             waiter = std::make_unique<DirectReadData>(&inputBuffer,
                                                       &readHandleState,
                                                       eventReadCount,
-                                                      std::move(partialEvents));
+                                                      std::move(partialRecords));
         }
         else if (NT_SUCCESS(Status))
         {
@@ -210,36 +214,23 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             {
                 try
                 {
-                    SplitToOem(readEvents);
+                    SplitToOem(readRecords);
                 }
                 CATCH_LOG();
             }
 
-            // combine partial and readEvents
-            while (!partialEvents.empty())
-            {
-                readEvents.push_front(std::move(partialEvents.back()));
-                partialEvents.pop_back();
-            }
+            // combine partial and read records
+            readRecords.insert(readRecords.begin(), partialRecords.cbegin(), partialRecords.cend());
 
-            // move events over
-            for (size_t i = 0; i < eventReadCount; ++i)
+            // store partial record if necessary
+            if (readRecords.size() > eventReadCount)
             {
-                if (readEvents.empty())
-                {
-                    break;
-                }
-                outEvents.push_back(std::move(readEvents.front()));
-                readEvents.pop_front();
+                inputBuffer.StoreReadPartialByteSequence(IInputEvent::Create(readRecords.back()));
+                readRecords.pop_back();
+                FAIL_FAST_IF(readRecords.size() != eventReadCount);
             }
 
-            // store partial event if necessary
-            if (!readEvents.empty())
-            {
-                inputBuffer.StoreReadPartialByteSequence(std::move(readEvents.front()));
-                readEvents.pop_front();
-                FAIL_FAST_IF(!(readEvents.empty()));
-            }
+            outRecords.swap(readRecords);
         }
         return Status;
     }
@@ -255,7 +246,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -266,7 +257,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -274,7 +265,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         NTSTATUS Status = _DoGetConsoleInput(context,
-                                             outEvents,
+                                             outRecords,
                                              eventsToRead,
                                              readHandleState,
                                              false,
@@ -295,7 +286,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -306,7 +297,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -314,7 +305,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         NTSTATUS Status = _DoGetConsoleInput(context,
-                                             outEvents,
+                                             outRecords,
                                              eventsToRead,
                                              readHandleState,
                                              true,
@@ -335,7 +326,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The A version will convert to W using the console's current Input codepage (see SetConsoleCP)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -346,7 +337,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -354,7 +345,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         NTSTATUS Status = _DoGetConsoleInput(context,
-                                             outEvents,
+                                             outRecords,
                                              eventsToRead,
                                              readHandleState,
                                              false,
@@ -375,7 +366,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // - The W version accepts UCS-2 formatted characters (wide characters)
 // Arguments:
 // - context - The input buffer to take records from to return to the client
-// - outEvents - storage location for read events
+// - outRecords - storage location for read records
 // - eventsToRead - The number of input events to read
 // - readHandleState - A structure that will help us maintain
 // some input context across various calls on the same input
@@ -386,7 +377,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
 // buffer), this contains context that will allow the server to
 // restore this call later.
 [[nodiscard]] HRESULT ApiRoutines::ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                         std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                         std::vector<INPUT_RECORD>& outRecords,
                                                          const size_t eventsToRead,
                                                          INPUT_READ_HANDLE_DATA& readHandleState,
                                                          std::unique_ptr<IWaitRoutine>& waiter) noexcept
@@ -394,7 +385,7 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     try
     {
         NTSTATUS Status = _DoGetConsoleInput(context,
-                                             outEvents,
+                                             outRecords,
                                              eventsToRead,
                                              readHandleState,
                                              true,
@@ -461,6 +452,27 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
 }
 
+// Routine Description:
+// - Appends input records to the input buffer as they are (private call)
+// Arguments:
+// - pInputBuffer - the input buffer to write to
+// - records - the records to write
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - HRESULT indicating success or failure
+[[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputRecords(_Inout_ InputBuffer* const pInputBuffer,
+                                                           const gsl::span<const INPUT_RECORD> records,
+                                                           _Out_ size_t& eventsWritten) noexcept
+{
+    try
+    {
+        eventsWritten = 0;
+        eventsWritten = pInputBuffer->Write(records);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
 // Routine Description:
 // - Writes events to the input buffer, translating from codepage to unicode first
 // Arguments:
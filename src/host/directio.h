@@ -26,6 +26,10 @@ class SCREEN_INFORMATION;
                                                      _Out_ size_t& eventsWritten,
                                                      const bool append) noexcept;
 
+[[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputRecords(_Inout_ InputBuffer* const pInputBuffer,
+                                                           const gsl::span<const INPUT_RECORD> records,
+                                                           _Out_ size_t& eventsWritten) noexcept;
+
 [[nodiscard]] NTSTATUS ConsoleCreateScreenBuffer(std::unique_ptr<ConsoleHandleData>& handle,
                                                  _In_ PCONSOLE_API_MSG Message,
                                                  _In_ PCD_CREATE_OBJECT_INFORMATION Information,
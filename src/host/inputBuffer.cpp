@@ -212,10 +212,18 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
-    });
-    _storage.erase(newEnd, _storage.end());
+    // Rotate every record through the ring once, putting back only the key
+    // events. Popping before pushing means the ring never has to grow.
+    const size_t count = _storage.size();
+    for (size_t i = 0; i < count; ++i)
+    {
+        const INPUT_RECORD record = _storage.front();
+        _storage.pop_front();
+        if (record.EventType == KEY_EVENT)
+        {
+            _storage.push_back(record);
+        }
+    }
 }
 
 // Routine Description:
@@ -244,39 +252,24 @@ void InputBuffer::FlushAllButKeys()
 {
     try
     {
-        if (_storage.empty())
-        {
-            if (!WaitForData)
-            {
-                return STATUS_SUCCESS;
-            }
-            return CONSOLE_STATUS_WAIT;
-        }
-
-        // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
-        size_t eventsRead;
-        bool resetWaitEvent;
-        _ReadBuffer(events,
-                    AmountToRead,
-                    eventsRead,
-                    Peek,
-                    resetWaitEvent,
-                    Unicode,
-                    Stream);
+        // We can never read more records than are stored, so don't make
+        // room for any more than that.
+        std::vector<INPUT_RECORD> records(std::min(AmountToRead, _storage.size()));
+        size_t recordsRead;
+        const NTSTATUS Status = Read(records,
+                                     recordsRead,
+                                     Peek,
+                                     WaitForData,
+                                     Unicode,
+                                     Stream);
 
         // copy events to outEvents
-        while (!events.empty())
+        for (size_t i = 0; i < recordsRead; ++i)
         {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
+            OutEvents.push_back(IInputEvent::Create(til::at(records, i)));
         }
 
-        if (resetWaitEvent)
-        {
-            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
-        }
-        return STATUS_SUCCESS;
+        return Status;
     }
     catch (...)
     {
@@ -309,16 +302,17 @@ void InputBuffer::FlushAllButKeys()
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
-                      1,
+        INPUT_RECORD record;
+        size_t recordsRead;
+        Status = Read({ &record, 1 },
+                      recordsRead,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (recordsRead != 0)
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(record);
         }
     }
     catch (...)
@@ -329,35 +323,93 @@ void InputBuffer::FlushAllButKeys()
     return Status;
 }
 
+// Routine Description:
+// - This routine reads a batch of records from the input buffer straight into
+//   the given span, without creating an event object for each of them.
+// - It can convert returned data to through the currently set Input CP, it can optionally return a wait condition
+//   if there isn't enough data in the buffer, and it can be set to not remove records as it reads them out.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecords - where the read records are stored. Its size is the amount of records to try to read.
+// - recordsRead - on exit, the number of records stored at the front of outRecords
+// - Peek - If true, copy records to outRecords but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack key events that have a >1 repeat count. outRecords must hold exactly 1 record if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(const gsl::span<INPUT_RECORD> outRecords,
+                                         _Out_ size_t& recordsRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
+{
+    recordsRead = 0;
+    try
+    {
+        if (_storage.empty())
+        {
+            if (!WaitForData)
+            {
+                return STATUS_SUCCESS;
+            }
+            return CONSOLE_STATUS_WAIT;
+        }
+
+        // read from buffer
+        bool resetWaitEvent;
+        _ReadBuffer(outRecords,
+                    recordsRead,
+                    Peek,
+                    resetWaitEvent,
+                    Unicode,
+                    Stream);
+
+        if (resetWaitEvent)
+        {
+            ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+        }
+        return STATUS_SUCCESS;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
-// - readCount - amount of events to read
+// - outRecords - where read records are placed. Its size is the amount of records to read.
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
 // - resetWaitEvent - on exit, true if buffer became empty.
 // - unicode - true if read should be done in unicode mode
-// - streamRead - true if read should unpack KeyEvents that have a >1 repeat count. readCount must be 1 if streamRead is true.
+// - streamRead - true if read should unpack KeyEvents that have a >1 repeat count. outRecords must hold 1 record if streamRead is true.
 // Return Value:
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                              const size_t readCount,
+void InputBuffer::_ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                               _Out_ size_t& eventsRead,
                               const bool peek,
                               _Out_ bool& resetWaitEvent,
                               const bool unicode,
                               const bool streamRead)
 {
+    const size_t readCount = gsl::narrow_cast<size_t>(outRecords.size());
+
     // when stream reading, the previous behavior was to only allow reading of a single
     // event at a time.
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
@@ -366,86 +418,66 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 
     while (!_storage.empty() && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
+        INPUT_RECORD& record = til::at(outRecords, eventsRead);
+        INPUT_RECORD& storedRecord = _storage.front();
+
         // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        if (streamRead &&
+            storedRecord.EventType == KEY_EVENT &&
+            storedRecord.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
-            {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
-            }
+            // split the key event
+            record = storedRecord;
+            record.Event.KeyEvent.wRepeatCount = 1;
+            storedRecord.Event.KeyEvent.wRepeatCount--;
         }
-
-        if (performNormalRead)
+        else
         {
-            readEvents.push_back(std::move(_storage.front()));
+            record = storedRecord;
             _storage.pop_front();
         }
 
+        ++eventsRead;
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            if (record.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(record.Event.KeyEvent.uChar.UnicodeChar))
             {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
+                ++virtualReadCount;
             }
         }
     }
 
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
     // copy the events back if we were supposed to peek
-    if (peek)
+    if (peek && eventsRead != 0)
     {
         if (streamRead)
         {
             // we need to check and see if the event was split from a coalesced key event
             // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
+            const INPUT_RECORD& lastRecord = til::at(outRecords, eventsRead - 1);
+            if (!_storage.empty() &&
+                lastRecord.EventType == KEY_EVENT &&
+                _storage.front().EventType == KEY_EVENT &&
+                _CanCoalesce(lastRecord.Event.KeyEvent, _storage.front().Event.KeyEvent))
             {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
+                _storage.front().Event.KeyEvent.wRepeatCount++;
             }
             else
             {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
+                _storage.push_front(lastRecord);
             }
         }
         else
         {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
+            for (size_t i = eventsRead; i > 0; --i)
             {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
+                _storage.push_front(til::at(outRecords, i - 1));
             }
         }
     }
 
-    // move events read to proper deque
-    while (!readEvents.empty())
-    {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
-    }
-
     // signal if we emptied the buffer
     if (_storage.empty())
     {
@@ -457,17 +489,40 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
 // - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
 // Return Value:
-// S_OK if successful.
+// - The number of events that were written to the input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of events that were written to the input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> keptRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, keptRecords);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -476,23 +531,28 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingRecords;
+        existingRecords.reserve(_storage.size());
+        for (size_t i = 0; i < _storage.size(); ++i)
+        {
+            existingRecords.push_back(_storage[i]);
+        }
+        _storage.clear();
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we emptied the storage out from under it, it will always
+        // return true after the first one (as it is filling the newly emptied ring.)
         // Then after the second one, because we've inserted some input, it will always say false.
         bool unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
         size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
+        _WriteBuffer(existingRecords, existingEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(!unusedWaitStatus));
 
         // We need to set the wait event if there were 0 events in the
@@ -500,9 +560,9 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // Because we did interesting manipulation of the wait queue
         // in order to prepend, we can't trust what _WriteBuffer said
         // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
+        // buffer (the one we emptied at the top) was empty
         // when this whole thing started.
-        if (existingStorage.empty())
+        if (existingRecords.empty())
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         }
@@ -529,12 +589,27 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
 // - any outside references to inEvent will ben invalidated after
 // calling this method.
 size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
+{
+    const INPUT_RECORD record = inEvent->ToInputRecord();
+    return Write({ &record, 1 });
+}
+
+// Routine Description:
+// - Writes events to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inEvents - input events to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(records);
     }
     catch (...)
     {
@@ -544,20 +619,21 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 }
 
 // Routine Description:
-// - Writes events to the input buffer. Wakes up any readers that are
+// - Writes a batch of records to the input buffer. Wakes up any readers that are
 // waiting for additional input events.
 // Arguments:
-// - inEvents - input events to store in the buffer.
+// - inRecords - input records to store in the buffer.
 // Return Value:
 // - The number of events that were written to input buffer.
 // Note:
 // - The console lock must be held when calling this routine.
-size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> keptRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, keptRecords);
+        if (records.empty())
         {
             return 0;
         }
@@ -565,7 +641,7 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
 
         if (SetWaitEvent)
         {
@@ -584,9 +660,47 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Returns a copy of the record with the same contents an IInputEvent created
+// from it would report, so that storing records by value behaves exactly like
+// storing events did.
 // Arguments:
-// - inRecords - The events to store.
+// - record - the record to normalize
+// Return Value:
+// - The normalized record.
+// Note:
+// - will throw E_INVALIDARG for records of an unknown event type
+static INPUT_RECORD _NormalizeRecord(const INPUT_RECORD& record)
+{
+    INPUT_RECORD normalized{ 0 };
+    normalized.EventType = record.EventType;
+    switch (record.EventType)
+    {
+    case KEY_EVENT:
+        normalized.Event.KeyEvent = record.Event.KeyEvent;
+        normalized.Event.KeyEvent.bKeyDown = !!record.Event.KeyEvent.bKeyDown;
+        break;
+    case MOUSE_EVENT:
+        normalized.Event.MouseEvent = record.Event.MouseEvent;
+        break;
+    case WINDOW_BUFFER_SIZE_EVENT:
+        normalized.Event.WindowBufferSizeEvent = record.Event.WindowBufferSizeEvent;
+        break;
+    case MENU_EVENT:
+        normalized.Event.MenuEvent = record.Event.MenuEvent;
+        break;
+    case FOCUS_EVENT:
+        normalized.Event.FocusEvent.bSetFocus = !!record.Event.FocusEvent.bSetFocus;
+        break;
+    default:
+        THROW_HR(E_INVALIDARG);
+    }
+    return normalized;
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
+// Arguments:
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -595,27 +709,27 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    for (const INPUT_RECORD& inRecord : inRecords)
     {
-        // Pop the next event.
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
         // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
+        const INPUT_RECORD record = _NormalizeRecord(inRecord);
         if (vtInputMode)
         {
+            // The vt input module still works on event objects, so only
+            // this mode pays for creating one.
+            const auto inEvent = IInputEvent::Create(record);
             const bool handled = _termInput.HandleKey(inEvent.get());
             if (handled)
             {
@@ -628,42 +742,19 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // record at a time because this is the original behavior of
         // the input buffer. Changing this behavior may break stuff
         // that was depending on it.
-        if (initialInEventsSize == 1 && !_storage.empty())
+        if (inRecords.size() == 1 && !_storage.empty())
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
+            if (_CoalesceMouseMovedEvents(record) ||
+                _CoalesceRepeatedKeyPressEvents(record))
             {
                 eventsWritten = 1;
                 return;
             }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
         }
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+        _storage.push_back(record);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -673,42 +764,33 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
-// both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// - Checks if the last saved record and inRecord are both MOUSE_MOVED
+// events. If they are, the last saved record is updated with the new
+// mouse position and inRecord should be dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastStoredRecord.EventType == MOUSE_EVENT)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
+        const MOUSE_EVENT_RECORD& inMouseEvent = inRecord.Event.MouseEvent;
+        MOUSE_EVENT_RECORD& lastMouseEvent = lastStoredRecord.Event.MouseEvent;
 
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
+        if (inMouseEvent.dwEventFlags == MOUSE_MOVED &&
+            lastMouseEvent.dwEventFlags == MOUSE_MOVED)
         {
             // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastMouseEvent.dwMousePosition = inMouseEvent.dwMousePosition;
             return true;
         }
     }
@@ -716,24 +798,24 @@ bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<I
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similiar enough to be coalesced
+// - checks two key events to see if they're similiar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event
+// - b - the other key event
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -741,44 +823,35 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input record saved and inRecord are both a keypress down
+// event for the same key, update the repeat count of the saved record and
+// inRecord should be dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    INPUT_RECORD& lastStoredRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastStoredRecord.EventType == KEY_EVENT)
+    {
+        const KEY_EVENT_RECORD& inKeyEvent = inRecord.Event.KeyEvent;
+        KEY_EVENT_RECORD& lastKeyEvent = lastStoredRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount = gsl::narrow_cast<WORD>(lastKeyEvent.wRepeatCount + inKeyEvent.wRepeatCount);
             return true;
         }
     }
@@ -788,42 +861,51 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - keptRecords - storage for the records that remain, used only if any had to be removed
 // Return Value:
-// - None
+// - The records that should be written to the buffer. This is either
+// inRecords itself or a view of keptRecords.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+gsl::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                          std::vector<INPUT_RECORD>& keptRecords)
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
 
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    // Most batches contain nothing to remove, so we only start copying
+    // records once the first one has been dropped.
+    bool dropped = false;
+    for (auto it = inRecords.begin(); it != inRecords.end(); ++it)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        bool drop = false;
+        if (it->EventType == KEY_EVENT && it->Event.KeyEvent.bKeyDown)
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
+            if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+                !IsSystemKey(it->Event.KeyEvent.wVirtualKeyCode))
             {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
+                UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+                drop = true;
             }
+            else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && it->Event.KeyEvent.wVirtualKeyCode == VK_PAUSE)
+            {
+                WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+                drop = true;
+            }
+        }
+
+        if (drop && !dropped)
+        {
+            keptRecords.assign(inRecords.begin(), it);
+            dropped = true;
+        }
+        else if (!drop && dropped)
+        {
+            keptRecords.push_back(*it);
         }
-        outEvents.push_back(std::move(currEvent));
     }
-    inEvents.swap(outEvents);
+    return dropped ? gsl::span<const INPUT_RECORD>{ keptRecords } : inRecords;
 }
 
 // Routine Description:
@@ -852,9 +934,8 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
         // add all input events to the storage queue
         while (!inEvents.empty())
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
+            _storage.push_back(inEvents.front()->ToInputRecord());
             inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
         }
     }
     catch (...)
@@ -867,3 +948,123 @@ TerminalInput& InputBuffer::GetTerminalInput()
 {
     return _termInput;
 }
+
+// Routine Description:
+// - Returns the number of records in the ring.
+size_t InputBuffer::RecordRing::size() const noexcept
+{
+    return _count;
+}
+
+// Routine Description:
+// - Returns true if the ring holds no records.
+bool InputBuffer::RecordRing::empty() const noexcept
+{
+    return _count == 0;
+}
+
+INPUT_RECORD& InputBuffer::RecordRing::front()
+{
+    return (*this)[0];
+}
+
+const INPUT_RECORD& InputBuffer::RecordRing::front() const
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputBuffer::RecordRing::back()
+{
+    return (*this)[_count - 1];
+}
+
+const INPUT_RECORD& InputBuffer::RecordRing::back() const
+{
+    return (*this)[_count - 1];
+}
+
+// Routine Description:
+// - Returns the record at the given position, counted from the front of the ring.
+// Arguments:
+// - index - position of the record. Must be less than size().
+// Return Value:
+// - A reference to the record.
+INPUT_RECORD& InputBuffer::RecordRing::operator[](const size_t index)
+{
+    FAIL_FAST_IF(index >= _count);
+    return til::at(_records, (_head + index) & (_records.size() - 1));
+}
+
+const INPUT_RECORD& InputBuffer::RecordRing::operator[](const size_t index) const
+{
+    FAIL_FAST_IF(index >= _count);
+    return til::at(_records, (_head + index) & (_records.size() - 1));
+}
+
+// Routine Description:
+// - Appends a record to the back of the ring, growing it if it's full.
+// Arguments:
+// - record - the record to append
+// Return Value:
+// - <none>
+void InputBuffer::RecordRing::push_back(const INPUT_RECORD& record)
+{
+    if (_count == _records.size())
+    {
+        _Grow();
+    }
+    ++_count;
+    back() = record;
+}
+
+// Routine Description:
+// - Inserts a record in front of the ring, growing it if it's full.
+// Arguments:
+// - record - the record to insert
+// Return Value:
+// - <none>
+void InputBuffer::RecordRing::push_front(const INPUT_RECORD& record)
+{
+    if (_count == _records.size())
+    {
+        _Grow();
+    }
+    _head = (_head - 1) & (_records.size() - 1);
+    ++_count;
+    front() = record;
+}
+
+// Routine Description:
+// - Removes the record at the front of the ring. The ring must not be empty.
+void InputBuffer::RecordRing::pop_front() noexcept
+{
+    _head = (_head + 1) & (_records.size() - 1);
+    --_count;
+}
+
+// Routine Description:
+// - Removes all records. The ring keeps its capacity for later writes.
+void InputBuffer::RecordRing::clear() noexcept
+{
+    _head = 0;
+    _count = 0;
+}
+
+// Routine Description:
+// - Doubles the capacity of the ring and unwraps its records to the front
+// of the new storage.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputBuffer::RecordRing::_Grow()
+{
+    const size_t capacity = _records.empty() ? s_InitialCapacity : _records.size() * 2;
+    std::vector<INPUT_RECORD> records(capacity);
+    for (size_t i = 0; i < _count; ++i)
+    {
+        til::at(records, i) = (*this)[i];
+    }
+    _records.swap(records);
+    _head = 0;
+}
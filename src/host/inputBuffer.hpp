@@ -68,36 +68,76 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(const gsl::span<INPUT_RECORD> outRecords,
+                                _Out_ size_t& recordsRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    // A growable ring of input records. Events are stored by value so that
+    // writing, coalescing and reading them doesn't allocate once the ring
+    // has grown to fit the input that is waiting to be read.
+    class RecordRing final
+    {
+    public:
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        INPUT_RECORD& front();
+        const INPUT_RECORD& front() const;
+        INPUT_RECORD& back();
+        const INPUT_RECORD& back() const;
+        INPUT_RECORD& operator[](const size_t index);
+        const INPUT_RECORD& operator[](const size_t index) const;
+
+        void push_back(const INPUT_RECORD& record);
+        void push_front(const INPUT_RECORD& record);
+        void pop_front() noexcept;
+        void clear() noexcept;
+
+    private:
+        static constexpr size_t s_InitialCapacity = 64;
+
+        std::vector<INPUT_RECORD> _records; // size is always zero or a power of two
+        size_t _head = 0;
+        size_t _count = 0;
+
+        void _Grow();
+    };
+
+    RecordRing _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
-                     const size_t readCount,
+    void _ReadBuffer(const gsl::span<INPUT_RECORD> outRecords,
                      _Out_ size_t& eventsRead,
                      const bool peek,
                      _Out_ bool& resetWaitEvent,
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord);
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    gsl::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                 std::vector<INPUT_RECORD>& keptRecords);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
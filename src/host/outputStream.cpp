@@ -106,6 +106,26 @@ bool ConhostInternalGetSet::GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_I
     return true;
 }
 
+// Routine Description:
+// - Retrieves just the cursor position, viewport and buffer size of the active buffer.
+// - The VT adapter needs these for nearly every cursor movement or erase, and
+//   doesn't need the color table and attributes GetConsoleScreenBufferInfoEx copies out.
+// Arguments:
+// - cursorPosition - Receives the cursor position within the buffer
+// - viewport - Receives the viewport as an exclusive rectangle, like srWindow
+// - bufferSize - Receives the dimensions of the buffer
+// Return Value:
+// - true if successful. false otherwise.
+bool ConhostInternalGetSet::PrivateGetCursorAndViewport(COORD& cursorPosition, SMALL_RECT& viewport, COORD& bufferSize) const
+{
+    // Like GetConsoleScreenBufferInfoEx, report on the alt buffer if it's active.
+    const auto& buffer = _io.GetActiveOutputBuffer().GetActiveBuffer();
+    cursorPosition = buffer.GetTextBuffer().GetCursor().GetPosition();
+    viewport = buffer.GetViewport().ToExclusive();
+    bufferSize = buffer.GetBufferSize().Dimensions();
+    return true;
+}
+
 // Routine Description:
 // - Connects the SetConsoleScreenBufferInfoEx API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -307,6 +327,24 @@ bool ConhostInternalGetSet::PrivateWriteConsoleInputW(std::deque<std::unique_ptr
                                                     true)); // append
 }
 
+// Routine Description:
+// - Appends input records directly to the input buffer, without wrapping each
+//   of them in an IInputEvent first.
+// Arguments:
+// - records - the input records to be copied to the end of the input buffer
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - true if successful (see DoSrvPrivateWriteConsoleInputRecords). false otherwise.
+bool ConhostInternalGetSet::PrivateWriteConsoleInputRecords(const gsl::span<const INPUT_RECORD> records,
+                                                            size_t& eventsWritten)
+{
+    eventsWritten = 0;
+
+    return SUCCEEDED(DoSrvPrivateWriteConsoleInputRecords(_io.GetActiveInputBuffer(),
+                                                          records,
+                                                          eventsWritten));
+}
+
 // Routine Description:
 // - Connects the SetConsoleWindowInfo API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -55,6 +55,7 @@ public:
     ConhostInternalGetSet(_In_ Microsoft::Console::IIoProvider& io);
 
     bool GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const override;
+    bool PrivateGetCursorAndViewport(COORD& cursorPosition, SMALL_RECT& viewport, COORD& bufferSize) const override;
     bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) override;
 
     bool SetConsoleCursorPosition(const COORD position) override;
@@ -86,6 +87,8 @@ public:
 
     bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                    size_t& eventsWritten) override;
+    bool PrivateWriteConsoleInputRecords(const gsl::span<const INPUT_RECORD> records,
+                                         size_t& eventsWritten) override;
 
     bool SetConsoleWindowInfo(bool const absolute,
                               const SMALL_RECT& window) override;
@@ -124,6 +124,10 @@ SCREEN_INFORMATION::~SCREEN_INFORMATION()
         const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
         pScreen->_textBuffer->GetCursor().SetColor(gci.GetCursorColor());
         pScreen->_textBuffer->GetCursor().SetType(gci.GetCursorType());
+        if (gci.GetScrollbackCompressionThreshold() != 0)
+        {
+            pScreen->_textBuffer->SetScrollbackCompressionThreshold(gci.GetScrollbackCompressionThreshold());
+        }
 
         const NTSTATUS status = pScreen->_InitializeOutputStateMachine();
 
@@ -1414,7 +1418,8 @@ bool SCREEN_INFORMATION::IsMaximizedY() const
     // Save cursor's relative height versus the viewport
     SHORT const sCursorHeightInViewportBefore = _textBuffer->GetCursor().GetPosition().Y - _viewport.Top();
 
-    HRESULT hr = TextBuffer::Reflow(*_textBuffer.get(), *newTextBuffer.get());
+    // Only the rows around the viewport are written now, the rest of the scrollback once it's needed.
+    HRESULT hr = TextBuffer::Reflow(*_textBuffer.get(), *newTextBuffer.get(), _viewport.Height());
 
     if (SUCCEEDED(hr))
     {
@@ -1426,6 +1431,9 @@ bool SCREEN_INFORMATION::IsMaximizedY() const
         LOG_IF_FAILED(SetViewportOrigin(false, coordCursorHeightDiff, true));
 
         _textBuffer.swap(newTextBuffer);
+
+        // The scrollback that's left is written from the old buffer, so it has to stay around until then.
+        _textBuffer->KeepReflowSource(std::move(newTextBuffer));
     }
 
     return NTSTATUS_FROM_HRESULT(hr);
@@ -59,7 +59,8 @@ Settings::Settings() :
     _DefaultForeground(INVALID_COLOR),
     _DefaultBackground(INVALID_COLOR),
     _fUseDx(false),
-    _fCopyColor(false)
+    _fCopyColor(false),
+    _dwScrollbackCompressionThreshold(0)
 {
     _dwScreenBufferSize.X = 80;
     _dwScreenBufferSize.Y = 25;
@@ -986,3 +987,12 @@ bool Settings::GetCopyColor() const noexcept
 {
     return _fCopyColor;
 }
+
+// Routine Description:
+// - Gets how many rows above the cursor the text buffer keeps uncompressed.
+// Return Value:
+// - The number of rows, or 0 if scrollback isn't compressed at all.
+DWORD Settings::GetScrollbackCompressionThreshold() const noexcept
+{
+    return _dwScrollbackCompressionThreshold;
+}
@@ -187,6 +187,7 @@ public:
 
     bool GetUseDx() const noexcept;
     bool GetCopyColor() const noexcept;
+    DWORD GetScrollbackCompressionThreshold() const noexcept;
 
     COLORREF CalculateDefaultForeground() const noexcept;
     COLORREF CalculateDefaultBackground() const noexcept;
@@ -237,6 +238,7 @@ private:
     bool _fScreenReversed;
     bool _fUseDx;
     bool _fCopyColor;
+    DWORD _dwScrollbackCompressionThreshold; // 0 disables compression
 
     COLORREF _XtermColorTable[XTERM_COLOR_TABLE_SIZE];
 
@@ -691,6 +691,28 @@ class AttrRowTests
         }
     }
 
+    TEST_METHOD(TestSetAttrToEndWithinLastRun)
+    {
+        const TextAttribute TestAttr{ FOREGROUND_BLUE | BACKGROUND_GREEN };
+
+        Log::Comment(L"Writing the same color a cell at a time should keep the row at two runs.");
+        for (UINT i = 10; i < 20; ++i)
+        {
+            VERIFY_IS_TRUE(pSingle->SetAttrToEnd(i, TestAttr));
+        }
+
+        VERIFY_ARE_EQUAL(2u, pSingle->_list.size());
+        VERIFY_ARE_EQUAL(_DefaultAttr, pSingle->_list[0].GetAttributes());
+        VERIFY_ARE_EQUAL(10u, pSingle->_list[0].GetLength());
+        VERIFY_ARE_EQUAL(TestAttr, pSingle->_list[1].GetAttributes());
+        VERIFY_ARE_EQUAL(static_cast<size_t>(_sDefaultLength - 10), pSingle->_list[1].GetLength());
+
+        Log::Comment(L"Starting before the last run still has to rewrite the runs.");
+        VERIFY_IS_TRUE(pSingle->SetAttrToEnd(5, TestAttr));
+        VERIFY_ARE_EQUAL(2u, pSingle->_list.size());
+        VERIFY_ARE_EQUAL(5u, pSingle->_list[0].GetLength());
+    }
+
     TEST_METHOD(TestTotalLength)
     {
         ATTR_ROW* pTestItems[]{ pSingle, pChain };
@@ -62,6 +62,37 @@ class CodepointWidthDetectorTests
         }
     }
 
+    TEST_METHOD(CanGetWidthsAtRangeEdges)
+    {
+        CodepointWidthDetector widthDetector;
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"\xa0"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Ambiguous, widthDetector.GetWidth(L"\xa1"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"\xa2"));
+        VERIFY_ARE_EQUAL(CodepointWidth::Wide, widthDetector.GetWidth(L"\xD87F\xDFFD")); // U+2FFFD
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"\xD87F\xDFFE")); // U+2FFFE
+        VERIFY_ARE_EQUAL(CodepointWidth::Ambiguous, widthDetector.GetWidth(L"\xDBFF\xDFFD")); // U+10FFFD
+        VERIFY_ARE_EQUAL(CodepointWidth::Narrow, widthDetector.GetWidth(L"\xDBFF\xDFFF")); // U+10FFFF
+    }
+
+    TEST_METHOD(CanGetColumnWidthsOfText)
+    {
+        CodepointWidthDetector widthDetector;
+        std::vector<BYTE> widths;
+
+        const std::wstring_view text{ L"a\x306A\xD83D\xDC7E!" };
+        VERIFY_ARE_EQUAL(6u, widthDetector.GetColumnWidths(text, widths));
+
+        const std::vector<BYTE> expected{ 1, 2, 2, 0, 1 };
+        VERIFY_ARE_EQUAL(expected.size(), widths.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(expected.at(i), widths.at(i));
+        }
+
+        VERIFY_ARE_EQUAL(0u, widthDetector.GetColumnWidths({}, widths));
+        VERIFY_ARE_EQUAL(0u, widths.size());
+    }
+
     static bool FallbackMethod(const std::wstring_view glyph)
     {
         if (glyph.size() < 1)
@@ -87,15 +118,38 @@ class CodepointWidthDetectorTests
         widthDetector.IsWide(ambiguous);
 
         // Cache should hold it.
-        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.Size());
 
         // Cached item should match what we expect
-        const auto it = widthDetector._fallbackCache.begin();
-        VERIFY_ARE_EQUAL(ambiguous, it->first);
-        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), it->second);
+        const auto cached = widthDetector._fallbackCache.Find(0x414);
+        VERIFY_IS_TRUE(cached.has_value());
+        VERIFY_ARE_EQUAL(FallbackMethod(ambiguous), cached.value());
 
         // Cache should empty when font changes.
         widthDetector.NotifyFontChanged();
-        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
+        VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.Size());
+        VERIFY_IS_FALSE(widthDetector._fallbackCache.Find(0x414).has_value());
+    }
+
+    TEST_METHOD(AmbiguousCacheGrows)
+    {
+        CodepointWidthDetector widthDetector;
+        widthDetector.SetFallbackMethod(std::bind(&FallbackMethod, std::placeholders::_1));
+
+        // The private use area is ambiguous, so every one of these asks the fallback.
+        const wchar_t first = 0xE000;
+        const size_t count = 1000;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto wch = gsl::narrow_cast<wchar_t>(first + i);
+            VERIFY_ARE_EQUAL(FallbackMethod({ &wch, 1 }), widthDetector.IsWide(wch));
+        }
+
+        VERIFY_ARE_EQUAL(count, widthDetector._fallbackCache.Size());
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto wch = gsl::narrow_cast<wchar_t>(first + i);
+            VERIFY_ARE_EQUAL(FallbackMethod({ &wch, 1 }), widthDetector._fallbackCache.Find(wch).value());
+        }
     }
 };
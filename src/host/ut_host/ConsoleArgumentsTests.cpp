@@ -32,6 +32,7 @@ public:
     TEST_METHOD(HeadlessArgTests);
     TEST_METHOD(SignalHandleTests);
     TEST_METHOD(FeatureArgTests);
+    TEST_METHOD(FrameDiffArgTests);
 };
 
 ConsoleArguments CreateAndParse(std::wstring& commandline, HANDLE hVtIn, HANDLE hVtOut)
@@ -1140,3 +1141,22 @@ void ConsoleArgumentsTests::FeatureArgTests()
                                     false), // inheritCursor
                    false); // successful parse?
 }
+
+void ConsoleArgumentsTests::FrameDiffArgTests()
+{
+    std::wstring commandline;
+
+    commandline = L"conhost.exe --headless";
+    Log::Comment(L"#1 frame diffing is off unless asked for");
+    VERIFY_IS_FALSE(CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE).GetFrameDiff());
+
+    commandline = L"conhost.exe --headless --framediff";
+    Log::Comment(L"#2 the framediff arg turns it on");
+    VERIFY_IS_TRUE(CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE).GetFrameDiff());
+
+    commandline = L"conhost.exe --framediff --headless -- foo.exe";
+    Log::Comment(L"#3 the framediff arg isn't passed on to the client");
+    const auto args = CreateAndParse(commandline, INVALID_HANDLE_VALUE, INVALID_HANDLE_VALUE);
+    VERIFY_IS_TRUE(args.GetFrameDiff());
+    VERIFY_ARE_EQUAL(std::wstring(L"foo.exe"), args.GetClientCommandline());
+}
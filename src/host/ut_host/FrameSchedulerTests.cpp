@@ -0,0 +1,91 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include "..\..\renderer\base\frameScheduler.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Render;
+using namespace std::chrono_literals;
+
+class FrameSchedulerTests
+{
+    TEST_CLASS(FrameSchedulerTests);
+
+    FrameScheduler::clock::time_point _now;
+
+    FrameScheduler _MakeScheduler()
+    {
+        _now = {};
+        return FrameScheduler{ [this]() { return _now; } };
+    }
+
+    TEST_METHOD(FirstFramePaintsImmediately)
+    {
+        auto scheduler = _MakeScheduler();
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() == 0ms);
+    }
+
+    TEST_METHOD(BurstsAreCoalescedIntoOneFramePerBudget)
+    {
+        auto scheduler = _MakeScheduler();
+        scheduler.SetTargetFps(100); // 10ms per frame
+
+        scheduler.FramePainted();
+
+        Log::Comment(L"A request right after a frame waits out the rest of the budget.");
+        _now += 3ms;
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() == 7ms);
+
+        _now += 7ms;
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() == 0ms);
+        scheduler.FramePainted();
+
+        Log::Comment(L"Over a flood of requests, we paint exactly one frame per budget.");
+        size_t frames = 0;
+        for (auto i = 0; i < 100; ++i)
+        {
+            _now += 1ms;
+            if (scheduler.TimeUntilNextFrame() == 0ms)
+            {
+                scheduler.FramePainted();
+                ++frames;
+            }
+        }
+        VERIFY_ARE_EQUAL(10u, frames);
+    }
+
+    TEST_METHOD(IdleScreenPaintsImmediately)
+    {
+        auto scheduler = _MakeScheduler();
+
+        scheduler.FramePainted();
+        _now += 1s;
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() == 0ms);
+    }
+
+    TEST_METHOD(LowLatencyNeverWaits)
+    {
+        auto scheduler = _MakeScheduler();
+        scheduler.SetLowLatency(true);
+
+        scheduler.FramePainted();
+        _now += 1ms;
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() == 0ms);
+
+        scheduler.SetLowLatency(false);
+        VERIFY_IS_TRUE(scheduler.TimeUntilNextFrame() > 0ms);
+    }
+
+    TEST_METHOD(RejectsZeroFps)
+    {
+        auto scheduler = _MakeScheduler();
+        VERIFY_THROWS(scheduler.SetTargetFps(0), wil::ResultException);
+        VERIFY_ARE_EQUAL(FrameScheduler::s_DefaultTargetFps, scheduler.GetTargetFps());
+    }
+};
@@ -0,0 +1,181 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "..\..\inc\consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "..\..\renderer\base\renderer.hpp"
+#include "..\..\renderer\base\HeadlessEngine.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Render;
+
+class HeadlessEngineTests
+{
+    TEST_CLASS(HeadlessEngineTests);
+
+    std::unique_ptr<CommonState> m_state;
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalScreenBuffer();
+        m_state->PrepareGlobalInputBuffer();
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalInputBuffer();
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+
+        m_state.reset(nullptr);
+
+        return true;
+    }
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state->PrepareNewTextBufferInfo();
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        m_state->CleanupNewTextBufferInfo();
+        return true;
+    }
+
+    TEST_METHOD(NothingInvalidNothingPainted)
+    {
+        HeadlessEngine engine{ { 10, 2 } };
+        VERIFY_ARE_EQUAL(S_FALSE, engine.StartPaint());
+        VERIFY_ARE_EQUAL(0u, engine.GetCallLog().size());
+    }
+
+    TEST_METHOD(PaintsIntoGridAndLog)
+    {
+        HeadlessEngine engine{ { 10, 2 } };
+
+        const std::wstring_view text{ L"hi\x4e00" };
+        const std::vector<Cluster> clusters{
+            { text.substr(0, 1), 1 },
+            { text.substr(1, 1), 1 },
+            { text.substr(2, 1), 2 },
+        };
+
+        VERIFY_SUCCEEDED(engine.InvalidateAll());
+        VERIFY_ARE_EQUAL(S_OK, engine.StartPaint());
+        VERIFY_SUCCEEDED(engine.UpdateDrawingBrushes(RGB(255, 0, 0), RGB(0, 0, 255), 0, ExtendedAttributes::Normal, false));
+        VERIFY_SUCCEEDED(engine.PaintBufferLine({ clusters.data(), clusters.size() }, { 1, 1 }, false));
+
+        IRenderEngine::CursorOptions options{};
+        options.coordCursor = { 5, 1 };
+        options.isOn = true;
+        VERIFY_SUCCEEDED(engine.PaintCursor(options));
+        VERIFY_SUCCEEDED(engine.EndPaint());
+
+        VERIFY_ARE_EQUAL(L"          ", engine.GetRowText(0));
+        VERIFY_ARE_EQUAL(L" hi\x4e00     ", engine.GetRowText(1));
+        VERIFY_ARE_EQUAL(RGB(255, 0, 0), engine.GetCell({ 2, 1 }).foreground);
+        VERIFY_ARE_EQUAL(RGB(0, 0, 255), engine.GetCell({ 3, 1 }).background);
+        VERIFY_ARE_EQUAL(L"", engine.GetCell({ 4, 1 }).text);
+        VERIFY_ARE_EQUAL(COORD({ 5, 1 }), engine.GetCursorPosition().value());
+        VERIFY_ARE_EQUAL(1u, engine.GetFrameCount());
+
+        const std::vector<std::wstring> expected{
+            L"StartPaint 0,0-9,1",
+            L"UpdateDrawingBrushes #ff0000 #0000ff",
+            L"PaintBufferLine 1,1 \"hi\x4e00\"",
+            L"PaintCursor 5,1",
+            L"EndPaint",
+        };
+        VERIFY_ARE_EQUAL(expected.size(), engine.GetCallLog().size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            VERIFY_ARE_EQUAL(expected.at(i), engine.GetCallLog().at(i));
+        }
+    }
+
+    TEST_METHOD(RendererPaintsBufferIntoEngine)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+        auto& textBuffer = si.GetTextBuffer();
+
+        textBuffer.Write(OutputCellIterator(L"golden"), { 0, 0 });
+        textBuffer.Write(OutputCellIterator(L"frame"), { 3, 1 });
+
+        HeadlessEngine engine{ si.GetViewport().Dimensions() };
+        Renderer renderer(&gci.renderData, nullptr, 0, nullptr);
+        renderer.AddRenderEngine(&engine);
+
+        renderer.TriggerRedrawAll();
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+        VERIFY_ARE_EQUAL(1u, engine.GetFrameCount());
+
+        const auto row0 = engine.GetRowText(0);
+        const auto row1 = engine.GetRowText(1);
+        VERIFY_ARE_EQUAL(L"golden", row0.substr(0, 6));
+        VERIFY_ARE_EQUAL(L"   frame", row1.substr(0, 8));
+    }
+
+    TEST_METHOD(RendererCountsFrameStatistics)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& si = gci.GetActiveOutputBuffer();
+        auto& textBuffer = si.GetTextBuffer();
+
+        // Paint the default brushes in the same colors the buffer is filled
+        // with, so the only brush changes are around the red word.
+        const auto fill = textBuffer.GetRowByOffset(0).GetAttrRow().GetAttrByColumn(0);
+        const auto previousAttributes = si.GetAttributes();
+        auto restoreAttributes = wil::scope_exit([&]() { si.SetAttributes(previousAttributes); });
+        si.SetAttributes(fill);
+
+        const TextAttribute red{ FOREGROUND_RED | FOREGROUND_INTENSITY };
+        textBuffer.Write(OutputCellIterator(L"golden", fill), { 0, 0 });
+        textBuffer.Write(OutputCellIterator(L"frame", red), { 3, 1 });
+
+        const auto view = si.GetViewport().Dimensions();
+        HeadlessEngine engine{ view };
+        Renderer renderer(&gci.renderData, nullptr, 0, nullptr);
+        renderer.AddRenderEngine(&engine);
+
+        renderer.TriggerRedrawAll();
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+
+        const auto frames = renderer.GetRecentFrameStatistics();
+        VERIFY_ARE_EQUAL(1u, frames.size());
+        const auto& frame = frames.front();
+
+        const auto width = gsl::narrow_cast<size_t>(view.X);
+        const auto height = gsl::narrow_cast<size_t>(view.Y);
+        VERIFY_ARE_EQUAL(width * height, frame.invalidatedCells);
+        VERIFY_ARE_EQUAL(height, frame.rowsPainted);
+        VERIFY_ARE_EQUAL(width * height, frame.clustersEmitted);
+        VERIFY_ARE_EQUAL(0u, frame.bytesWritten);
+
+        // The engine is handed the brushes for the defaults, once for every
+        // row, and twice more for the runs on either side of "frame"...
+        const auto& log = engine.GetCallLog();
+        const auto brushCalls = std::count_if(log.cbegin(), log.cend(), [](const std::wstring& call) {
+            return call.rfind(L"UpdateDrawingBrushes", 0) == 0;
+        });
+        VERIFY_ARE_EQUAL(height + 3, gsl::narrow_cast<size_t>(brushCalls));
+
+        // ...but only the defaults, the red and the way back are changes.
+        VERIFY_ARE_EQUAL(3u, frame.brushChanges);
+    }
+};
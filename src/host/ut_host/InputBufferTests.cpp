@@ -78,7 +78,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +98,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +121,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MOUSE_EVENT_RECORD& mouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(mouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +161,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +220,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +238,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,11 +381,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(1);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
-                                1,
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -396,9 +394,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
-                                RECORD_INSERT_COUNT - 1,
+        outRecords.resize(RECORD_INSERT_COUNT - 1);
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -431,11 +428,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords(recordInsertCount);
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
-                                recordInsertCount,
+        inputBuffer._ReadBuffer(outRecords,
                                 eventsRead,
                                 false,
                                 resetWaitEvent,
@@ -444,10 +440,9 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +584,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +615,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +635,75 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(CanWriteAndReadRecordSpans)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (unsigned int i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            records.push_back(MakeKeyEvent(TRUE, 1, static_cast<WCHAR>(L'A' + i), 0, static_cast<WCHAR>(L'A' + i), 0));
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.Write(records), RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
+
+        // peeking copies the records out but leaves them in place
+        std::vector<INPUT_RECORD> outRecords(RECORD_INSERT_COUNT);
+        size_t recordsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, recordsRead, true, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
+        for (size_t i = 0; i < recordsRead; ++i)
+        {
+            VERIFY_ARE_EQUAL(records[i], outRecords[i]);
+        }
+
+        // a read into a larger span only fills as much as there is
+        outRecords.assign(RECORD_INSERT_COUNT * 2, INPUT_RECORD{});
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, recordsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, RECORD_INSERT_COUNT);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+        for (size_t i = 0; i < recordsRead; ++i)
+        {
+            VERIFY_ARE_EQUAL(records[i], outRecords[i]);
+        }
+
+        VERIFY_ARE_EQUAL(inputBuffer.Read(outRecords, recordsRead, false, true, true, false), CONSOLE_STATUS_WAIT);
+        VERIFY_ARE_EQUAL(recordsRead, 0u);
+    }
+
+    TEST_METHOD(StorageGrowsWhileWrapped)
+    {
+        InputBuffer inputBuffer;
+        // the initial capacity of the storage ring
+        const size_t capacity = 64;
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 0; i < capacity * 3; ++i)
+        {
+            INPUT_RECORD record{};
+            record.EventType = MENU_EVENT;
+            record.Event.MenuEvent.dwCommandId = gsl::narrow<UINT>(i);
+            records.push_back(record);
+        }
+
+        // fill the ring, then read some off the front so that the next
+        // writes wrap around before the ring has to grow
+        VERIFY_ARE_EQUAL(inputBuffer.Write(gsl::span<const INPUT_RECORD>{ records.data(), capacity }), capacity);
+        std::vector<INPUT_RECORD> outRecords(capacity / 2);
+        size_t recordsRead = 0;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, recordsRead, false, false, true, false));
+        VERIFY_ARE_EQUAL(recordsRead, capacity / 2);
+
+        const auto remaining = gsl::span<const INPUT_RECORD>{ records }.subspan(capacity);
+        VERIFY_ARE_EQUAL(inputBuffer.Write(remaining), capacity * 2);
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), capacity * 5 / 2);
+
+        for (size_t i = 0; i < inputBuffer.GetNumberOfReadyEvents(); ++i)
+        {
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], records[i + capacity / 2]);
+        }
+    }
 };
@@ -11,8 +11,7 @@
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 
-#include <deque>
-#include <memory>
+#include <vector>
 
 using namespace WEX::Logging;
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -45,14 +44,14 @@ class InputRecordConversionTests
     {
         Log::Comment(L"nothing should happen to input events that aren't key events");
 
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
+        std::vector<INPUT_RECORD> inEvents;
         INPUT_RECORD inRecords[INPUT_RECORD_COUNT] = { 0 };
         for (size_t i = 0; i < INPUT_RECORD_COUNT; ++i)
         {
             inRecords[i].EventType = MOUSE_EVENT;
             inRecords[i].Event.MouseEvent.dwMousePosition.X = static_cast<SHORT>(i);
             inRecords[i].Event.MouseEvent.dwMousePosition.Y = static_cast<SHORT>(i * 2);
-            inEvents.push_back(IInputEvent::Create(inRecords[i]));
+            inEvents.push_back(inRecords[i]);
         }
 
         SplitToOem(inEvents);
@@ -60,7 +59,7 @@ class InputRecordConversionTests
 
         for (size_t i = 0; i < INPUT_RECORD_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inRecords[i], inEvents[i]->ToInputRecord());
+            VERIFY_ARE_EQUAL(inRecords[i], inEvents[i]);
         }
     }
 
@@ -68,13 +67,13 @@ class InputRecordConversionTests
     {
         Log::Comment(L"non-dbcs chars shouldn't be split");
 
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
+        std::vector<INPUT_RECORD> inEvents;
         INPUT_RECORD inRecords[INPUT_RECORD_COUNT] = { 0 };
         for (size_t i = 0; i < INPUT_RECORD_COUNT; ++i)
         {
             inRecords[i].EventType = KEY_EVENT;
             inRecords[i].Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(L'a' + i);
-            inEvents.push_back(IInputEvent::Create(inRecords[i]));
+            inEvents.push_back(inRecords[i]);
         }
 
         SplitToOem(inEvents);
@@ -82,7 +81,7 @@ class InputRecordConversionTests
 
         for (size_t i = 0; i < INPUT_RECORD_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inRecords[i], inEvents[i]->ToInputRecord());
+            VERIFY_ARE_EQUAL(inRecords[i], inEvents[i]);
         }
     }
 
@@ -93,7 +92,7 @@ class InputRecordConversionTests
         const UINT codepage = ServiceLocator::LocateGlobals().getConsoleInformation().CP;
 
         INPUT_RECORD inRecords[INPUT_RECORD_COUNT * 2] = { 0 };
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
+        std::vector<INPUT_RECORD> inEvents;
         // U+3042 hiragana letter A
         wchar_t hiraganaA = 0x3042;
         wchar_t inChars[INPUT_RECORD_COUNT];
@@ -103,7 +102,7 @@ class InputRecordConversionTests
             inRecords[i].EventType = KEY_EVENT;
             inRecords[i].Event.KeyEvent.uChar.UnicodeChar = currentChar;
             inChars[i] = currentChar;
-            inEvents.push_back(IInputEvent::Create(inRecords[i]));
+            inEvents.push_back(inRecords[i]);
         }
 
         SplitToOem(inEvents);
@@ -122,8 +121,8 @@ class InputRecordConversionTests
         VERIFY_ARE_EQUAL(writtenBytes, static_cast<int>(INPUT_RECORD_COUNT * 2));
         for (size_t i = 0; i < INPUT_RECORD_COUNT * 2; ++i)
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(inEvents[i].get());
-            VERIFY_ARE_EQUAL(static_cast<char>(pKeyEvent->GetCharData()), dbcsChars[i]);
+            VERIFY_ARE_EQUAL(static_cast<WORD>(KEY_EVENT), inEvents[i].EventType);
+            VERIFY_ARE_EQUAL(static_cast<char>(inEvents[i].Event.KeyEvent.uChar.UnicodeChar), dbcsChars[i]);
         }
     }
 };
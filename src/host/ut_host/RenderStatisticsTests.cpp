@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+
+#include "..\..\renderer\inc\RenderStatistics.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Render;
+using namespace std::chrono_literals;
+
+class RenderStatisticsTests
+{
+    TEST_CLASS(RenderStatisticsTests);
+
+    TEST_METHOD(EmptySummary)
+    {
+        RenderStatistics statistics;
+        VERIFY_ARE_EQUAL(0u, statistics.GetTotalFrames());
+        VERIFY_ARE_EQUAL(0u, statistics.GetRecentFrames().size());
+
+        const auto summary = statistics.Summarize();
+        VERIFY_ARE_EQUAL(0u, summary.frameCount);
+        VERIFY_IS_TRUE(summary.paintTime.p50 == 0us);
+        VERIFY_IS_TRUE(summary.paintTime.p99 == 0us);
+    }
+
+    TEST_METHOD(RecordsFramesInOrder)
+    {
+        RenderStatistics statistics;
+        for (size_t i = 1; i <= 3; ++i)
+        {
+            FrameStatistics frame;
+            frame.rowsPainted = i;
+            frame.clustersEmitted = i * 80;
+            statistics.Record(frame);
+        }
+
+        const auto frames = statistics.GetRecentFrames();
+        VERIFY_ARE_EQUAL(3u, frames.size());
+        VERIFY_ARE_EQUAL(1u, frames.at(0).rowsPainted);
+        VERIFY_ARE_EQUAL(3u, frames.at(2).rowsPainted);
+        VERIFY_ARE_EQUAL(240u, frames.at(2).clustersEmitted);
+    }
+
+    TEST_METHOD(RingKeepsTheMostRecentFrames)
+    {
+        RenderStatistics statistics;
+        const auto total = RenderStatistics::s_Capacity + 10;
+        for (size_t i = 0; i < total; ++i)
+        {
+            FrameStatistics frame;
+            frame.bytesWritten = i;
+            statistics.Record(frame);
+        }
+
+        VERIFY_ARE_EQUAL(total, statistics.GetTotalFrames());
+
+        const auto frames = statistics.GetRecentFrames();
+        VERIFY_ARE_EQUAL(RenderStatistics::s_Capacity, frames.size());
+        VERIFY_ARE_EQUAL(10u, frames.front().bytesWritten);
+        VERIFY_ARE_EQUAL(total - 1, frames.back().bytesWritten);
+    }
+
+    TEST_METHOD(SummarizesPercentiles)
+    {
+        RenderStatistics statistics;
+
+        // Paint times of 1..100us, recorded out of order.
+        for (auto i = 0; i < 100; ++i)
+        {
+            FrameStatistics frame;
+            frame.paintTime = std::chrono::microseconds{ (i * 37) % 100 + 1 };
+            frame.lockTime = 5us;
+            statistics.Record(frame);
+        }
+
+        const auto summary = statistics.Summarize();
+        VERIFY_ARE_EQUAL(100u, summary.frameCount);
+        VERIFY_ARE_EQUAL(50, summary.paintTime.p50.count());
+        VERIFY_ARE_EQUAL(99, summary.paintTime.p99.count());
+        VERIFY_ARE_EQUAL(5, summary.lockTime.p50.count());
+        VERIFY_ARE_EQUAL(5, summary.lockTime.p99.count());
+        VERIFY_ARE_EQUAL(0, summary.presentTime.p99.count());
+    }
+};
@@ -1743,6 +1743,17 @@ void ScreenBufferTests::ResizeAltBufferGetScreenBufferInfo()
 
     VERIFY_ARE_EQUAL(newActualAltView.Width(), newApiViewport.Width());
     VERIFY_ARE_EQUAL(newActualAltView.Height(), newApiViewport.Height());
+
+    Log::Comment(NoThrowString().Format(
+        L"The narrow query the VT adapter uses should report the same as the full one."));
+    ConhostInternalGetSet getSet{ gci };
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
+    VERIFY_IS_TRUE(getSet.PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
+    VERIFY_ARE_EQUAL(csbiex.dwCursorPosition, cursorPosition);
+    VERIFY_ARE_EQUAL(csbiex.srWindow, viewport);
+    VERIFY_ARE_EQUAL(csbiex.dwSize, bufferSize);
 }
 
 void ScreenBufferTests::VtEraseAllPersistCursor()
@@ -156,4 +156,230 @@ class SearchTests
         Search s(gci.renderData, L"\x304b", Search::Direction::Backward, Search::Sensitivity::CaseInsensitive);
         DoFoundChecks(s, coordStartExpected, -1);
     }
+
+    TEST_METHOD(FindAllReturnsEveryMatch)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        Search s(gci.renderData, L"\x304b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        const auto& matches = s.FindAll();
+
+        VERIFY_ARE_EQUAL(4u, matches.size());
+        for (SHORT y = 0; y < 4; y++)
+        {
+            const COORD start{ 2, y };
+            const COORD end{ 3, y };
+            VERIFY_ARE_EQUAL(start, matches.at(gsl::narrow_cast<size_t>(y)).first);
+            VERIFY_ARE_EQUAL(end, matches.at(gsl::narrow_cast<size_t>(y)).second);
+        }
+    }
+
+    TEST_METHOD(MatchesOnlySpanWrappedRows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+        const SHORT lastColumn = textBuffer.GetSize().RightInclusive();
+
+        // Row 1 wrapped into row 2, row 2 didn't wrap into row 3.
+        textBuffer.Write(OutputCellIterator(L"Q"), { lastColumn, 1 });
+        textBuffer.Write(OutputCellIterator(L"Q"), { lastColumn, 2 });
+
+        Search s(gci.renderData, L"QA", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+
+        VERIFY_IS_TRUE(s.FindNext());
+        const COORD start{ lastColumn, 1 };
+        const COORD end{ 0, 2 };
+        VERIFY_ARE_EQUAL(start, s.GetFoundLocation().first);
+        VERIFY_ARE_EQUAL(end, s.GetFoundLocation().second);
+
+        VERIFY_IS_FALSE(s.FindNext());
+    }
+
+    TEST_METHOD(RefreshPicksUpNewText)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        VERIFY_ARE_EQUAL(4u, s.FindAll().size());
+
+        textBuffer.Write(OutputCellIterator(L"ab"), { 10, 6 });
+        textBuffer.Write(OutputCellIterator(L"AB"), { 10, 5 });
+        textBuffer.Write(OutputCellIterator(L"  "), { 0, 1 });
+
+        // Nothing changes until the buffer is read again.
+        VERIFY_ARE_EQUAL(4u, s.FindAll().size());
+
+        s.Refresh();
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(4u, matches.size());
+
+        const COORD start{ 10, 5 };
+        const COORD end{ 11, 5 };
+        VERIFY_ARE_EQUAL(COORD({ 0, 2 }), matches.at(1).first);
+        VERIFY_ARE_EQUAL(start, matches.at(3).first);
+        VERIFY_ARE_EQUAL(end, matches.at(3).second);
+    }
+
+    TEST_METHOD(RefreshFollowsScrolledRows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+
+        Search s(gci.renderData, L"AB", Search::Direction::Forward, Search::Sensitivity::CaseSensitive);
+        const auto before = s.FindAll();
+        VERIFY_ARE_EQUAL(4u, before.size());
+
+        // Push the top row out, the way a new line at the bottom of a full buffer does.
+        VERIFY_IS_TRUE(textBuffer.IncrementCircularBuffer());
+
+        const auto revision = textBuffer.GetRowByOffset(0).GetRevision();
+        VERIFY_ARE_EQUAL(revision, s._rows.at(1).revision);
+
+        s.Refresh();
+
+        Log::Comment(L"The cache moved up with the rows, so only the new bottom row was read.");
+        VERIFY_ARE_EQUAL(revision, s._rows.at(0).revision);
+        for (size_t y = 0; y < s._rows.size(); y++)
+        {
+            VERIFY_ARE_EQUAL(textBuffer.GetRowByOffset(y).GetRevision(), s._rows.at(y).revision);
+        }
+
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(3u, matches.size());
+        for (size_t i = 0; i < matches.size(); i++)
+        {
+            const auto& moved = before.at(i + 1);
+            const COORD start{ moved.first.X, gsl::narrow_cast<SHORT>(moved.first.Y - 1) };
+            const COORD end{ moved.second.X, gsl::narrow_cast<SHORT>(moved.second.Y - 1) };
+            VERIFY_ARE_EQUAL(start, matches.at(i).first);
+            VERIFY_ARE_EQUAL(end, matches.at(i).second);
+        }
+    }
+
+    TEST_METHOD(ForwardRegexCaseSensitive)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        COORD coordStartExpected = { 0 };
+        Search s(gci.renderData, L"A[A-Z]", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        DoFoundChecks(s, coordStartExpected, 1);
+    }
+
+    TEST_METHOD(ForwardRegexCaseInsensitive)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        COORD coordStartExpected = { 0 };
+        Search s(gci.renderData, L"[a-b]+", Search::Direction::Forward, Search::Sensitivity::CaseInsensitive, Search::Mode::RegularExpression);
+        DoFoundChecks(s, coordStartExpected, 1);
+    }
+
+    TEST_METHOD(BackwardRegexCaseSensitiveJapanese)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // Each wide glyph is seen once, and the match covers both of its cells.
+        COORD coordStartExpected = { 2, 3 };
+        Search s(gci.renderData, L"\x304b+", Search::Direction::Backward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        DoFoundChecks(s, coordStartExpected, -1);
+    }
+
+    TEST_METHOD(RegexMatchesAcrossWrappedRows)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const SHORT lastColumn = gci.GetActiveOutputBuffer().GetTextBuffer().GetSize().RightInclusive();
+
+        // Row 1 wrapped into row 2, so they're one line. Row 3 wrapped into the empty row 4.
+        Search s(gci.renderData, L"E +A", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(1u, matches.size());
+        VERIFY_ARE_EQUAL(COORD({ 8, 1 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 0, 2 }), matches.at(0).second);
+
+        // The blank cells after the text at the end of a line aren't part of it,
+        // but those of a row that wrapped are.
+        Search t(gci.renderData, L"DE$", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        const auto& ends = t.FindAll();
+        VERIFY_ARE_EQUAL(2u, ends.size());
+        VERIFY_ARE_EQUAL(COORD({ 7, 0 }), ends.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 8, 0 }), ends.at(0).second);
+        VERIFY_ARE_EQUAL(COORD({ 7, 2 }), ends.at(1).first);
+        VERIFY_ARE_EQUAL(COORD({ 8, 2 }), ends.at(1).second);
+
+        Search u(gci.renderData, L"C.*", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        const auto& rests = u.FindAll();
+        VERIFY_ARE_EQUAL(3u, rests.size());
+        VERIFY_ARE_EQUAL(COORD({ 4, 0 }), rests.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 8, 0 }), rests.at(0).second);
+        VERIFY_ARE_EQUAL(COORD({ 4, 1 }), rests.at(1).first);
+        VERIFY_ARE_EQUAL(COORD({ 8, 2 }), rests.at(1).second);
+        VERIFY_ARE_EQUAL(COORD({ 4, 3 }), rests.at(2).first);
+        VERIFY_ARE_EQUAL(COORD({ lastColumn, 3 }), rests.at(2).second);
+    }
+
+    TEST_METHOD(RegexAnchorsMatchAtLogicalLineStarts)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // Row 2 continues row 1, so it doesn't start a line.
+        Search s(gci.renderData, L"^(AB|XY)", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(3u, matches.size());
+        VERIFY_ARE_EQUAL(COORD({ 0, 0 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 0, 1 }), matches.at(1).first);
+        VERIFY_ARE_EQUAL(COORD({ 0, 3 }), matches.at(2).first);
+    }
+
+    TEST_METHOD(RegexDoesNotBacktrack)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+        textBuffer.Write(OutputCellIterator(std::wstring(40, L'a')), { 0, 6 });
+
+        // A backtracking engine takes exponential time to give up on this one.
+        Search s(gci.renderData, L"(a*)*b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        VERIFY_IS_FALSE(s.FindNext());
+        VERIFY_ARE_EQUAL(0u, s.FindAll().size());
+    }
+
+    TEST_METHOD(RegexTriesOnlyOffsetsWhereMatchesStart)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& textBuffer = gci.GetActiveOutputBuffer().GetTextBuffer();
+        textBuffer.Write(OutputCellIterator(L"xab" + std::wstring(60, L'a')), { 0, 6 });
+
+        // Every 'a' after the match could start one, but there's no 'b' to end it.
+        Search s(gci.renderData, L"a.*b", Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression);
+        const auto& matches = s.FindAll();
+        VERIFY_ARE_EQUAL(1u, matches.size());
+        VERIFY_ARE_EQUAL(COORD({ 1, 6 }), matches.at(0).first);
+        VERIFY_ARE_EQUAL(COORD({ 2, 6 }), matches.at(0).second);
+
+        // The backward pass only marks the offset the match starts at.
+        std::vector<bool> starts;
+        VERIFY_IS_TRUE(s._regex->FindMatchStarts(L"xab" + std::wstring(60, L'a'), starts));
+        VERIFY_ARE_EQUAL(64u, starts.size());
+        VERIFY_ARE_EQUAL(1, static_cast<int>(std::count(starts.cbegin(), starts.cend(), true)));
+        VERIFY_IS_TRUE(starts.at(1));
+
+        // Anchors are swapped in the reversed pattern, so they still hold.
+        RegexMatcher anchored{ L"^a|b$", false };
+        VERIFY_IS_TRUE(anchored.FindMatchStarts(L"aab", starts));
+        VERIFY_IS_TRUE(starts.at(0));
+        VERIFY_IS_FALSE(starts.at(1));
+        VERIFY_IS_TRUE(starts.at(2));
+        VERIFY_IS_FALSE(anchored.FindMatchStarts(L"bba", starts));
+    }
+
+    TEST_METHOD(RegexRejectsMalformedPatterns)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        for (const auto pattern : { L"(AB", L"AB)", L"[AB", L"*A", L"A**", L"A{2,1}", L"A{1001}", L"\\q" })
+        {
+            Log::Comment(NoThrowString().Format(L"Pattern: %s", pattern));
+            VERIFY_THROWS(Search(gci.renderData, pattern, Search::Direction::Forward, Search::Sensitivity::CaseSensitive, Search::Mode::RegularExpression), wil::ResultException);
+        }
+    }
 };
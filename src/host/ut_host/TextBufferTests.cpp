@@ -81,6 +81,8 @@ class TextBufferTests
 
     TEST_METHOD(TestDoubleBytePadFlag);
 
+    TEST_METHOD(TestWriteRun);
+
     void DoBoundaryTest(PWCHAR const pwszInputString,
                         short const cLength,
                         short const cMax,
@@ -140,10 +142,18 @@ class TextBufferTests
 
     TEST_METHOD(ResizeTraditionalRotationPreservesHighUnicode);
     TEST_METHOD(ScrollBufferRotationPreservesHighUnicode);
+    TEST_METHOD(ScrollRowsInCircledBuffer);
+    TEST_METHOD(CopyRectangleOverlapsAndClipsWideGlyphs);
+
+    TEST_METHOD(GetTextForClipboardMergesColorRuns);
+
+    TEST_METHOD(ScrollbackCompressionRoundTrips);
 
     TEST_METHOD(ResizeTraditionalHighUnicodeRowRemoval);
     TEST_METHOD(ResizeTraditionalHighUnicodeColumnRemoval);
 
+    TEST_METHOD(ReflowWritesViewportFirst);
+
     TEST_METHOD(TestBurrito);
 };
 
@@ -289,6 +299,70 @@ void TextBufferTests::TestDoubleBytePadFlag()
     VERIFY_IS_FALSE(Row.GetCharRow().WasDoubleBytePadded());
 }
 
+void TextBufferTests::TestWriteRun()
+{
+    TextBuffer& textBuffer = GetTbi();
+    const auto width = textBuffer.GetSize().Width();
+    const TextAttribute expectedAttr(FOREGROUND_RED);
+
+    Log::Comment(L"A short run is written in one pass with a single attribute.");
+    {
+        const auto result = textBuffer.WriteRun(L"abc", expectedAttr, { 2, 0 });
+        VERIFY_ARE_EQUAL(3u, result.inputConsumed);
+        VERIFY_ARE_EQUAL(3u, result.cellsAdvanced);
+
+        const ROW& row = textBuffer.GetRowByOffset(0);
+        VERIFY_ARE_EQUAL(L"abc", row.GetText().substr(2, 3));
+        for (auto col = 2; col < 5; col++)
+        {
+            VERIFY_ARE_EQUAL(expectedAttr, row.GetAttrRow().GetAttrByColumn(col));
+        }
+        VERIFY_IS_FALSE(row.GetCharRow().WasWrapForced());
+    }
+
+    Log::Comment(L"A run longer than the row stops at the end of the row and sets the wrap flag.");
+    {
+        const std::wstring text(width + 5, L'x');
+        const auto result = textBuffer.WriteRun(text, expectedAttr, { 0, 1 });
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(width), result.inputConsumed);
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(width), result.cellsAdvanced);
+        VERIFY_IS_TRUE(textBuffer.GetRowByOffset(1).GetCharRow().WasWrapForced());
+    }
+
+    Log::Comment(L"A run exactly as wide as the row doesn't wrap, since a newline may follow it.");
+    {
+        const std::wstring text(width, L'y');
+        const auto result = textBuffer.WriteRun(text, expectedAttr, { 0, 4 });
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(width), result.inputConsumed);
+        VERIFY_ARE_EQUAL(gsl::narrow<size_t>(width), result.cellsAdvanced);
+        VERIFY_IS_FALSE(textBuffer.GetRowByOffset(4).GetCharRow().WasWrapForced());
+
+        // The next line starts on its own row, so copying and reflowing keep them apart.
+        textBuffer.WriteRun(L"z", expectedAttr, { 0, 5 });
+        VERIFY_IS_FALSE(textBuffer.GetRowByOffset(4).GetCharRow().WasWrapForced());
+    }
+
+    Log::Comment(L"A surrogate pair is consumed as one full width glyph.");
+    {
+        const std::wstring text{ L"\xD83D\xDE00z" };
+        const auto result = textBuffer.WriteRun(text, expectedAttr, { 0, 2 });
+        VERIFY_ARE_EQUAL(3u, result.inputConsumed);
+        VERIFY_ARE_EQUAL(3u, result.cellsAdvanced);
+    }
+
+    Log::Comment(L"A full width glyph that doesn't fit in the last column is left unconsumed.");
+    {
+        const auto result = textBuffer.WriteRun(L"a\x30a2", expectedAttr, { width - 2, 3 });
+        VERIFY_ARE_EQUAL(1u, result.inputConsumed);
+        VERIFY_ARE_EQUAL(1u, result.cellsAdvanced);
+        VERIFY_IS_TRUE(textBuffer.GetRowByOffset(3).GetCharRow().WasDoubleBytePadded());
+
+        const auto retry = textBuffer.WriteRun(L"\x30a2", expectedAttr, { width - 1, 3 });
+        VERIFY_ARE_EQUAL(0u, retry.inputConsumed);
+        VERIFY_ARE_EQUAL(0u, retry.cellsAdvanced);
+    }
+}
+
 void TextBufferTests::DoBoundaryTest(PWCHAR const pwszInputString,
                                      short const cLength,
                                      short const cMax,
@@ -1924,6 +1998,225 @@ void TextBufferTests::ScrollBufferRotationPreservesHighUnicode()
     VERIFY_ARE_EQUAL(String(fire), String(shouldBeFireText.data(), gsl::narrow<int>(shouldBeFireText.size())));
 }
 
+// This tests that scrolling a region of a buffer that has already circled moves only the rows
+// in that region and leaves the circular buffer's first row where it was.
+void TextBufferTests::ScrollRowsInCircledBuffer()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Circle the buffer a few times so that the first row isn't at the front of the storage.
+    for (auto i = 0; i < 3; ++i)
+    {
+        VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    }
+    const auto firstRow = _buffer->GetFirstRowIndex();
+    VERIFY_ARE_EQUAL(3, firstRow);
+
+    // Mark the start of every logical row with its index.
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        const auto marker = static_cast<wchar_t>(L'0' + y);
+        _buffer->GetRowByOffset(y).GetCharRow().GlyphAt(0) = std::wstring_view{ &marker, 1 };
+    }
+
+    // Move logical rows 5, 6 and 7 up to 3, 4 and 5.
+    _buffer->ScrollRows(5, 3, -2);
+
+    const std::wstring_view expected{ L"0125673489" };
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        const auto text = *_buffer->GetTextDataAt({ 0, y });
+        VERIFY_ARE_EQUAL(String(expected.data() + y, 1), String(text.data(), gsl::narrow<int>(text.size())));
+    }
+
+    // The buffer shouldn't have been straightened out to do that and every row should still know its slot.
+    VERIFY_ARE_EQUAL(firstRow, _buffer->GetFirstRowIndex());
+    for (size_t i = 0; i < _buffer->_storage.size(); ++i)
+    {
+        VERIFY_ARE_EQUAL(gsl::narrow<SHORT>(i), _buffer->_storage[i].GetId());
+    }
+}
+
+// This tests that a rectangle copied within the buffer lands intact when it overlaps itself,
+// and that a wide glyph cut in half at the edges of the copy doesn't leave a stray half behind.
+void TextBufferTests::CopyRectangleOverlapsAndClipsWideGlyphs()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    const auto rowText = [&](const SHORT y) {
+        return String(_buffer->GetRowByOffset(y).GetText().c_str());
+    };
+
+    // Move part of a row to the right, over itself.
+    _buffer->Write(OutputCellIterator(L"abcdef"), { 0, 0 });
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 0 }, { 4, 1 }), { 2, 0 });
+    VERIFY_ARE_EQUAL(String(L"ababcd    "), rowText(0));
+
+    // Move two rows down by one, over themselves, with their colors and an emoji.
+    const TextAttribute red{ 0x0c };
+    _buffer->Write(OutputCellIterator(L"123", red), { 0, 1 });
+    _buffer->Write(OutputCellIterator(L"456"), { 0, 2 });
+    _buffer->GetRowByOffset(1).GetCharRow().GlyphAt(3) = std::wstring_view{ L"\xD83D\xDD25" };
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 1 }, { 4, 2 }), { 0, 2 });
+    VERIFY_ARE_EQUAL(String(L"123\xD83D\xDD25      "), rowText(2));
+    VERIFY_ARE_EQUAL(String(L"456       "), rowText(3));
+    VERIFY_ARE_EQUAL(red, _buffer->GetRowByOffset(2).GetAttrRow().GetAttrByColumn(2));
+    VERIFY_ARE_EQUAL(attr, _buffer->GetRowByOffset(2).GetAttrRow().GetAttrByColumn(3));
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(2).GetCharRow().DbcsAttrAt(3).IsGlyphStored());
+
+    // Put a wide glyph in columns 1 and 2 of the last row.
+    auto& charRow = _buffer->GetRowByOffset(4).GetCharRow();
+    charRow.GlyphAt(0) = std::wstring_view{ L"x" };
+    charRow.GlyphAt(1) = std::wstring_view{ L"\x304b" };
+    charRow.DbcsAttrAt(1).SetLeading();
+    charRow.GlyphAt(2) = std::wstring_view{ L"\x304b" };
+    charRow.DbcsAttrAt(2).SetTrailing();
+    charRow.GlyphAt(3) = std::wstring_view{ L"y" };
+
+    // Copying only its trailing half pads the target out with a space instead.
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 2, 4 }, { 2, 1 }), { 6, 4 });
+    VERIFY_ARE_EQUAL(String(L"x\x304by   y  "), rowText(4));
+    VERIFY_IS_FALSE(charRow.DbcsAttrAt(6).IsDbcs());
+
+    // Overwriting its trailing half clears the leading half that's left.
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 4 }, { 1, 1 }), { 2, 4 });
+    VERIFY_ARE_EQUAL(String(L"x xy   y  "), rowText(4));
+    VERIFY_IS_FALSE(charRow.DbcsAttrAt(1).IsDbcs());
+
+    // A compressed row is copied from in place, emoji and all, and stays compressed.
+    _buffer->GetRowByOffset(2).GetCharRow().Compress();
+    _buffer->CopyRectangle(Viewport::FromDimensions({ 0, 2 }, { 4, 1 }), { 6, 0 });
+    VERIFY_ARE_EQUAL(String(L"ababcd123\xD83D\xDD25"), rowText(0));
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(0).GetCharRow().DbcsAttrAt(9).IsGlyphStored());
+    VERIFY_ARE_EQUAL(red, _buffer->GetRowByOffset(0).GetAttrRow().GetAttrByColumn(8));
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(2).GetCharRow().IsCompressed());
+}
+
+void TextBufferTests::GetTextForClipboardMergesColorRuns()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 10, 3 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x07 };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // "ab" and "cd" have different attributes that resolve to the same colors.
+    _buffer->Write(OutputCellIterator(L"ab", TextAttribute{ 0x0c }), { 0, 0 });
+    _buffer->Write(OutputCellIterator(L"cd", TextAttribute{ 0x800c }), { 2, 0 });
+    _buffer->Write(OutputCellIterator(L"<e"), { 4, 0 });
+    _buffer->Write(OutputCellIterator(L"xy"), { 0, 1 });
+
+    const auto getForeground = [](TextAttribute& textAttr) -> COLORREF {
+        return textAttr.GetLegacyAttributes() & FG_ATTRS;
+    };
+    const auto getBackground = [](TextAttribute& textAttr) -> COLORREF {
+        return (textAttr.GetLegacyAttributes() & BG_ATTRS) >> 4;
+    };
+
+    const std::vector<SMALL_RECT> selection{ { 0, 0, 9, 0 }, { 0, 1, 9, 1 } };
+    const auto data = _buffer->GetTextForClipboard(false, true, selection, getForeground, getBackground);
+
+    VERIFY_ARE_EQUAL(2u, data.text.size());
+    VERIFY_ARE_EQUAL(String(L"abcd<e\r\n"), String(data.text.at(0).c_str()));
+    VERIFY_ARE_EQUAL(String(L"xy"), String(data.text.at(1).c_str()));
+
+    // The trailing spaces were trimmed off the default colored run, and the
+    // line break got a run of its own.
+    const auto& runs = data.runs.at(0);
+    VERIFY_ARE_EQUAL(3u, runs.size());
+    VERIFY_ARE_EQUAL(4u, runs.at(0).length);
+    VERIFY_ARE_EQUAL(0x0cu, runs.at(0).foreground);
+    VERIFY_ARE_EQUAL(2u, runs.at(1).length);
+    VERIFY_ARE_EQUAL(0x07u, runs.at(1).foreground);
+    VERIFY_ARE_EQUAL(2u, runs.at(2).length);
+    VERIFY_ARE_EQUAL(1u, data.runs.at(1).size());
+    VERIFY_ARE_EQUAL(2u, data.runs.at(1).at(0).length);
+
+    // "xy" continues the colors of "<e", so it doesn't need a span of its own.
+    const auto html = TextBuffer::GenHTML(data, 10, L"Consolas", 0, "Test");
+    size_t spans = 0;
+    for (auto pos = html.find("<SPAN"); pos != std::string::npos; pos = html.find("<SPAN", pos + 1))
+    {
+        spans++;
+    }
+    VERIFY_ARE_EQUAL(2u, spans);
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, html.find("\">abcd</SPAN>"));
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, html.find("\">&lt;e<BR>xy</SPAN>"));
+
+    const auto rtf = TextBuffer::GenRTF(data, 10, L"Consolas", 0);
+    VERIFY_ARE_NOT_EQUAL(std::string::npos, rtf.find("\\highglight1\\cf2 abcd\\highglight1\\cf3 <e\\line xy}"));
+}
+
+// This tests that rows compressed once they've scrolled far enough away from the cursor read back exactly as they were written.
+void TextBufferTests::ScrollbackCompressionRoundTrips()
+{
+    // Set up a text buffer for us
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Put plain text, a wide character and an emoji in the first row.
+    auto& charRow = _buffer->_storage[0].GetCharRow();
+    charRow.GlyphAt(0) = std::wstring_view{ L"A" };
+    charRow.GlyphAt(1) = std::wstring_view{ L"\x304b" };
+    charRow.DbcsAttrAt(1).SetLeading();
+    charRow.GlyphAt(2) = std::wstring_view{ L"\x304b" };
+    charRow.DbcsAttrAt(2).SetTrailing();
+    charRow.GlyphAt(3) = std::wstring_view{ L"\xD83D\xDD25" };
+    const auto expected = _buffer->_storage[0].GetText();
+
+    // With the cursor at the bottom, every row more than 2 rows above it should be compressed.
+    _buffer->GetCursor().SetPosition({ 0, bufferSize.Y - 1 });
+    _buffer->SetScrollbackCompressionThreshold(2);
+    for (SHORT y = 0; y < bufferSize.Y; ++y)
+    {
+        VERIFY_ARE_EQUAL(y < bufferSize.Y - 3, _buffer->_storage[y].GetCharRow().IsCompressed());
+    }
+
+    // Reading the row leaves it compressed, and it reads back exactly as it was written.
+    const TextBuffer& constBuffer = *_buffer;
+    const auto& row = constBuffer.GetRowByOffset(0);
+    VERIFY_IS_TRUE(row.GetCharRow().IsCompressed());
+    VERIFY_ARE_EQUAL(String(expected.c_str()), String(row.GetText().c_str()));
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(1).IsLeading());
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(2).IsTrailing());
+    VERIFY_IS_TRUE(row.GetCharRow().DbcsAttrAt(3).IsGlyphStored());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(bufferSize.X), row.GetCharRow().size());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(0), row.GetCharRow().MeasureLeft());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(4), row.GetCharRow().MeasureRight());
+    VERIFY_IS_TRUE(row.GetCharRow().ContainsText());
+    VERIFY_IS_FALSE(constBuffer.GetRowByOffset(1).GetCharRow().ContainsText());
+    VERIFY_IS_TRUE(row.GetCharRow().IsCompressed());
+
+    // Circling the buffer compresses the row that just scrolled past the threshold.
+    VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    VERIFY_IS_TRUE(_buffer->_storage[_buffer->_firstRow + bufferSize.Y - 4].GetCharRow().IsCompressed());
+
+    // Writing to a compressed row expands it...
+    const SHORT writtenOffset = bufferSize.Y - 4;
+    auto& written = _buffer->GetRowByOffset(writtenOffset);
+    VERIFY_IS_TRUE(written.GetCharRow().IsCompressed());
+    written.GetCharRow().GlyphAt(0) = std::wstring_view{ L"B" };
+    VERIFY_IS_FALSE(written.GetCharRow().IsCompressed());
+
+    // ...until the buffer circles on and the sweep compresses it again, before it leaves the buffer.
+    for (SHORT i = 0; i < writtenOffset && !written.GetCharRow().IsCompressed(); ++i)
+    {
+        VERIFY_IS_TRUE(_buffer->IncrementCircularBuffer());
+    }
+    VERIFY_IS_TRUE(written.GetCharRow().IsCompressed());
+    VERIFY_ARE_EQUAL(L'B', written.GetText().front());
+}
+
 // This tests that rows removed from the buffer while resizing traditionally will also drop the high unicode
 // characters from the Unicode Storage buffer
 void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
@@ -1949,14 +2242,17 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_IS_FALSE(_buffer->_storage[pos.Y].GetUnicodeStorage().empty(), L"The row should have stored the glyph.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    for (const auto& row : _buffer->_storage)
+    {
+        VERIFY_IS_TRUE(row.GetUnicodeStorage().empty(), L"No remaining row should hold any glyphs.");
+    }
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1984,14 +2280,77 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_IS_FALSE(_buffer->_storage[pos.Y].GetUnicodeStorage().empty(), L"The row should have stored the glyph.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_IS_TRUE(_buffer->_storage[pos.Y].GetUnicodeStorage().empty(), L"The row should no longer hold the glyph.");
+}
+
+void TextBufferTests::ReflowWritesViewportFirst()
+{
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto oldBuffer = std::make_unique<TextBuffer>(COORD{ 10, 20 }, attr, cursorSize, _renderTarget);
+
+    // Every third line is long enough to wrap, and each line has its own color.
+    for (wchar_t line = 0; line < 25; ++line)
+    {
+        const std::wstring text(line % 3 == 0 ? 14 : 5, static_cast<wchar_t>(L'a' + line));
+        for (const auto wch : text)
+        {
+            VERIFY_IS_TRUE(oldBuffer->InsertCharacter(wch, DbcsAttribute{}, TextAttribute{ static_cast<WORD>(0x10 + line % 4) }));
+        }
+        VERIFY_IS_TRUE(oldBuffer->NewlineCursor());
+    }
+    VERIFY_IS_TRUE(oldBuffer->InsertCharacter(L'>', DbcsAttribute{}, attr));
+
+    const COORD newSize{ 7, 20 };
+    TextBuffer fullBuffer{ newSize, attr, cursorSize, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(*oldBuffer, fullBuffer));
+    VERIFY_IS_NULL(fullBuffer._pendingReflow.get());
+
+    TextBuffer lazyBuffer{ newSize, attr, cursorSize, _renderTarget };
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(*oldBuffer, lazyBuffer, 4i16));
+    VERIFY_ARE_EQUAL(fullBuffer.GetCursor().GetPosition(), lazyBuffer.GetCursor().GetPosition());
+
+    // The rows above the viewport are written from the old buffer later on, so it's kept around.
+    const TextBuffer* const oldPointer = oldBuffer.get();
+    lazyBuffer.KeepReflowSource(std::move(oldBuffer));
+    VERIFY_IS_NOT_NULL(lazyBuffer._pendingReflow.get());
+    VERIFY_IS_TRUE(oldPointer == lazyBuffer._pendingReflow->owner.get());
+
+    const auto compareRow = [&](const size_t index) {
+        const ROW& expected = fullBuffer.GetRowByOffset(index);
+        const ROW& actual = lazyBuffer._storage.at((lazyBuffer._firstRow + index) % lazyBuffer.TotalRowCount());
+        VERIFY_ARE_EQUAL(expected.GetText(), actual.GetText());
+        VERIFY_ARE_EQUAL(expected.GetCharRow().WasWrapForced(), actual.GetCharRow().WasWrapForced());
+        for (size_t column = 0; column < gsl::narrow_cast<size_t>(newSize.X); ++column)
+        {
+            VERIFY_ARE_EQUAL(expected.GetAttrRow().GetAttrByColumn(column), actual.GetAttrRow().GetAttrByColumn(column));
+        }
+    };
+
+    // The rows on screen are already there, the ones above them are still blank.
+    const auto written = gsl::narrow_cast<size_t>(lazyBuffer._pendingReflow->written - lazyBuffer._pendingReflow->scrolled);
+    VERIFY_IS_TRUE(written > 0);
+    VERIFY_IS_LESS_THAN_OR_EQUAL(written + 4, gsl::narrow_cast<size_t>(lazyBuffer.GetCursor().GetPosition().Y) + 1);
+    for (size_t index = written; index < lazyBuffer.TotalRowCount(); ++index)
+    {
+        compareRow(index);
+    }
+    VERIFY_IS_FALSE(lazyBuffer._storage.at(lazyBuffer._firstRow).GetCharRow().ContainsText());
+
+    // Asking for a row above them writes the rest, the same as if it was all written right away.
+    lazyBuffer.GetRowByOffset(0);
+    VERIFY_IS_NULL(lazyBuffer._pendingReflow.get());
+    for (size_t index = 0; index < lazyBuffer.TotalRowCount(); ++index)
+    {
+        compareRow(index);
+    }
 }
 
 void TextBufferTests::TestBurrito()
@@ -115,6 +115,16 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestWrapping);
 
+    TEST_METHOD(TestPaintOnlyInvalidRowSpans);
+
+    TEST_METHOD(TestFrameDiffing);
+
+    TEST_METHOD(TestFrameDiffingAcrossScrolls);
+
+    TEST_METHOD(TestFrameDiffingMinimizesSequences);
+
+    TEST_METHOD(TestFrameDiffingReplay);
+
     TEST_METHOD(TestResize);
 
     TEST_METHOD(TestCursorVisibility);
@@ -465,7 +475,7 @@ void VtRendererTest::Xterm256TestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the FG----"));
         qExpectedInput.push_back("\x1b[37m"); // Foreground DARK_WHITE
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[4],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -474,7 +484,7 @@ void VtRendererTest::Xterm256TestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to something not in the table----"));
         qExpectedInput.push_back("\x1b[48;2;1;1;1m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       0x010101,
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -483,7 +493,7 @@ void VtRendererTest::Xterm256TestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to the 'Default' background----"));
         qExpectedInput.push_back("\x1b[49m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[0],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -885,7 +895,7 @@ void VtRendererTest::XtermTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the FG----"));
         qExpectedInput.push_back("\x1b[37m"); // Foreground DARK_WHITE
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[4],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -894,12 +904,12 @@ void VtRendererTest::XtermTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to something not in the table----"));
         qExpectedInput.push_back("\x1b[40m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7], 0x010101, 0, ExtendedAttributes::Normal, false));
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], 0x010101, 0, ExtendedAttributes::Normal, false));
 
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to the 'Default' background----"));
         qExpectedInput.push_back("\x1b[40m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[0],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -1145,7 +1155,7 @@ void VtRendererTest::WinTelnetTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the FG----"));
         qExpectedInput.push_back("\x1b[37m"); // Foreground DARK_WHITE
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[4],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -1154,12 +1164,12 @@ void VtRendererTest::WinTelnetTestColors()
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to something not in the table----"));
         qExpectedInput.push_back("\x1b[40m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7], 0x010101, 0, ExtendedAttributes::Normal, false));
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15], 0x010101, 0, ExtendedAttributes::Normal, false));
 
         Log::Comment(NoThrowString().Format(
             L"----Change only the BG to the 'Default' background----"));
         qExpectedInput.push_back("\x1b[40m"); // Background DARK_BLACK
-        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[7],
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
                                                       g_ColorTable[0],
                                                       0,
                                                       ExtendedAttributes::Normal,
@@ -1320,6 +1330,352 @@ void VtRendererTest::TestWrapping()
     });
 }
 
+void VtRendererTest::TestPaintOnlyInvalidRowSpans()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Invalidate the start of the top line and the start of a line further down, "
+        L"like a status line and a prompt changing at the same time."));
+    SMALL_RECT top = { 0, 0, 3, 1 };
+    SMALL_RECT bottom = { 0, 10, 3, 11 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&top));
+    VERIFY_SUCCEEDED(engine->Invalidate(&bottom));
+
+    const wchar_t* const line = L"asdfghjkl";
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < wcslen(line); i++)
+    {
+        clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+    }
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The renderer repaints everything in the bounding rectangle of the two..."));
+        SMALL_RECT bounds = { 0, 0, 3, 11 };
+        VERIFY_ARE_EQUAL(bounds, engine->_invalidRect.ToExclusive());
+
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+
+        Log::Comment(NoThrowString().Format(
+            L"...but only the columns that changed are sent for the lines that changed..."));
+        qExpectedInput.push_back("asd");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+
+        Log::Comment(NoThrowString().Format(
+            L"...and nothing at all is sent for the lines in between."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 5 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+
+        qExpectedInput.push_back("\x1b[11;1H");
+        qExpectedInput.push_back("asd");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 10 }, false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestFrameDiffing()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    engine->SetFrameDiffing(true);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    std::wstring line = L"asdfghjkl";
+    const auto makeClusters = [&]() {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+        }
+        return clusters;
+    };
+    SMALL_RECT invalid = { 0, 0, 9, 1 };
+
+    auto clusters = makeClusters();
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"The first time we see the line, all of it is sent."));
+        qExpectedInput.push_back("\x1b[H");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 0 }));
+
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Repainting the same line sends nothing at all."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+
+    line[5] = L'X';
+    clusters = makeClusters();
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing one character only sends that character. Backing up "
+            L"four columns is shorter than a CUP."));
+        qExpectedInput.push_back("\x1b[4D");
+        qExpectedInput.push_back("X");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    Log::Comment(NoThrowString().Format(
+        L"Clearing the screen forgets the last frame."));
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_SUCCEEDED(engine->_ClearScreen());
+    VERIFY_IS_TRUE(engine->_shadow.empty());
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestFrameDiffingAcrossScrolls()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    engine->SetFrameDiffing(true);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const std::wstring line = L"asdfghjkl";
+    std::vector<Cluster> clusters;
+    for (size_t i = 0; i < line.size(); i++)
+    {
+        clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+    }
+    SMALL_RECT invalid = { 0, 0, 9, 1 };
+
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    bool forcePaint = false;
+    VERIFY_SUCCEEDED(engine->InvalidateCircling(&forcePaint));
+    VERIFY_IS_TRUE(forcePaint);
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"During the frame that circles, the screen hasn't moved yet."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+    });
+    VERIFY_IS_TRUE(engine->_shadow.empty());
+
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Once the terminal has scrolled, the same line is sent in full."));
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    invalid = { 0, 31, 9, 32 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Moving down and returning the carriage is shorter than a CUP."));
+        qExpectedInput.push_back("\x1b[31B");
+        qExpectedInput.push_back("\r");
+        qExpectedInput.push_back("asdfghjkl");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 31 }, false));
+        VERIFY_IS_FALSE(engine->_shadow.empty());
+
+        Log::Comment(NoThrowString().Format(
+            L"A newline from the bottom row scrolls the terminal too."));
+        qExpectedInput.push_back("\r\n");
+        VERIFY_SUCCEEDED(engine->_MoveCursor({ 0, 32 }));
+        VERIFY_IS_TRUE(engine->_shadow.empty());
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestFrameDiffingMinimizesSequences()
+{
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    std::unique_ptr<Xterm256Engine> engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+    engine->SetFrameDiffing(true);
+
+    // Verify the first paint emits a clear and go home
+    qExpectedInput.push_back("\x1b[2J");
+    VERIFY_IS_TRUE(engine->_firstPaint);
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    std::wstring line = L"abcdefghijklmnopqrst";
+    const auto makeClusters = [&]() {
+        std::vector<Cluster> clusters;
+        for (size_t i = 0; i < line.size(); i++)
+        {
+            clusters.emplace_back(std::wstring_view{ &line[i], 1 }, static_cast<size_t>(1));
+        }
+        return clusters;
+    };
+    SMALL_RECT invalid = { 0, 0, 20, 1 };
+
+    auto clusters = makeClusters();
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[H");
+        qExpectedInput.push_back("abcdefghijklmnopqrst");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    line[1] = L'B';
+    line[18] = L'S';
+    clusters = makeClusters();
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Two changes at either end of the line only send those two "
+            L"characters, skipping over the unchanged run between them."));
+        qExpectedInput.push_back("\x1b[19D");
+        qExpectedInput.push_back("B");
+        qExpectedInput.push_back("\x1b[16C");
+        qExpectedInput.push_back("S");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, 0 }, false));
+    });
+
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"Changing both colors sends a single SGR, before the text that "
+            L"uses it."));
+        qExpectedInput.push_back(EMPTY_CALLBACK_SENTINEL);
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(0x00030201,
+                                                      0x00070605,
+                                                      0,
+                                                      ExtendedAttributes::Normal,
+                                                      false));
+        WriteCallback(EMPTY_CALLBACK_SENTINEL, 1);
+
+        qExpectedInput.push_back("\x1b[38;2;1;2;3;48;2;5;6;7m");
+        qExpectedInput.push_back("\x1b[18D");
+        qExpectedInput.push_back("B");
+        VERIFY_SUCCEEDED(engine->PaintBufferLine({ &clusters.at(1), 1 }, { 1, 0 }, false));
+    });
+
+    TestPaint(*engine, [&]() {
+        Log::Comment(NoThrowString().Format(
+            L"A pending SGR is still sent at the end of the frame."));
+        qExpectedInput.push_back("\x1b[m");
+        VERIFY_SUCCEEDED(engine->UpdateDrawingBrushes(g_ColorTable[15],
+                                                      g_ColorTable[0],
+                                                      0,
+                                                      ExtendedAttributes::Normal,
+                                                      false));
+    });
+
+    VerifyExpectedInputsDrained();
+}
+
+void VtRendererTest::TestFrameDiffingReplay()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Replay the same frames through an engine with and without frame "
+        L"diffing, and compare the bytes each one writes per frame. The frames "
+        L"look like a status display, where a few numbers change every frame."));
+
+    const auto rightAligned = [](const int value, const size_t width) {
+        auto text = std::to_wstring(value);
+        text.insert(0, width - std::min(width, text.size()), L' ');
+        return text;
+    };
+
+    // Each frame repaints the whole screen, like the renderer does after an
+    //      InvalidateAll, but only the counters in it change.
+    const auto replay = [&](const bool frameDiffing) {
+        wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+        auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, SetUpViewport(), g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+        engine->SetFrameDiffing(frameDiffing);
+
+        std::vector<size_t> bytesPerFrame;
+        for (int frame = 0; frame < 10; frame++)
+        {
+            const auto bytesBefore = engine->GetBytesWritten();
+            VERIFY_SUCCEEDED(engine->InvalidateAll());
+            VERIFY_SUCCEEDED(engine->StartPaint());
+            for (short row = 0; row < 32; row++)
+            {
+                auto text = L"process " + rightAligned(row, 2) +
+                            L"  cpu " + rightAligned((frame * row) % 100, 3) +
+                            L"%  mem " + rightAligned(4096 + frame * 8, 6) +
+                            L" KB  state running";
+                text.resize(80, L' ');
+
+                std::vector<Cluster> clusters;
+                for (size_t i = 0; i < text.size(); i++)
+                {
+                    clusters.emplace_back(std::wstring_view{ &text[i], 1 }, static_cast<size_t>(1));
+                }
+                VERIFY_SUCCEEDED(engine->PaintBufferLine({ clusters.data(), clusters.size() }, { 0, row }, false));
+            }
+            VERIFY_SUCCEEDED(engine->EndPaint());
+            bytesPerFrame.push_back(engine->GetBytesWritten() - bytesBefore);
+        }
+        return bytesPerFrame;
+    };
+
+    const auto plain = replay(false);
+    const auto diffed = replay(true);
+
+    for (size_t frame = 0; frame < plain.size(); frame++)
+    {
+        Log::Comment(NoThrowString().Format(
+            L"Frame %zu: %zu bytes without diffing, %zu bytes with diffing", frame, plain.at(frame), diffed.at(frame)));
+    }
+
+    Log::Comment(NoThrowString().Format(
+        L"The first frame has nothing to diff against, so it can't save anything."));
+    VERIFY_IS_LESS_THAN_OR_EQUAL(diffed.at(0), plain.at(0));
+
+    for (size_t frame = 1; frame < plain.size(); frame++)
+    {
+        VERIFY_IS_LESS_THAN(diffed.at(frame), plain.at(frame));
+    }
+}
+
 void VtRendererTest::TestResize()
 {
     Viewport view = SetUpViewport();
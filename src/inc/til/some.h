@@ -132,6 +132,11 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             return _array[pos];
         }
 
+        constexpr reference operator[](size_type pos) noexcept
+        {
+            return _array[pos];
+        }
+
         constexpr const_reference front() const noexcept
         {
             return _array[0];
@@ -142,11 +147,21 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             return _array[_used - 1];
         }
 
+        constexpr reference back() noexcept
+        {
+            return _array[_used - 1];
+        }
+
         constexpr const T* data() const noexcept
         {
             return _array.data();
         }
 
+        constexpr T* data() noexcept
+        {
+            return _array.data();
+        }
+
         void push_back(const T& val)
         {
             if (_used >= N)
@@ -159,6 +174,11 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             ++_used;
         }
 
+        void clear() noexcept
+        {
+            _used = 0;
+        }
+
         void pop_back()
         {
             if (_used <= 0)
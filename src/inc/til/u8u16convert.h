@@ -12,8 +12,12 @@ Abstract:
 Tests have been made in order to investigate whether or not own algorithms
 could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
-Based on the results the decision was made to keep using the platform
-functions MultiByteToWideChar and WideCharToMultiByte.
+UTF-16 to UTF-8 keeps using the platform function WideCharToMultiByte.
+UTF-8 to UTF-16 is done here: the bulk of the input is ASCII, which is widened
+16 bytes at a time on x86/x64, and the rest is decoded one code point at a time.
+Ill-formed UTF-8 is replaced the way MultiByteToWideChar replaces it, with one
+U+FFFD for each maximal subpart of an ill-formed sequence, as the Unicode
+standard recommends (chapter 3.9).
 
 Author(s):
 - Steffen Illhardt (german-one) 2020
@@ -21,8 +25,163 @@ Author(s):
 
 #pragma once
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+        // Routine Description:
+        // - Widens the ASCII characters at the start of a UTF-8 string.
+        //   On x86/x64 16 bytes are tested and widened at a time with SSE2.
+        // Arguments:
+        // - in - the UTF-8 code units
+        // - length - the number of code units in `in`
+        // - out - receives the UTF-16 code units, must have room for `length` of them
+        // Return Value:
+        // - the number of ASCII characters that were widened
+        inline size_t u8u16ascii(const char* const in, const size_t length, wchar_t* const out) noexcept
+        {
+            size_t i = 0;
+
+#if defined(_M_IX86) || defined(_M_X64)
+            const auto zero = _mm_setzero_si128();
+            for (; i + 16 <= length; i += 16)
+            {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're converting the string in fixed size blocks.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. The intrinsic requires it.
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+                // Each output code unit is one of the bytes zero extended. Widening all of them
+                // is fine even if the block isn't all ASCII, the caller overwrites the others.
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're converting the string in fixed size blocks.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. The intrinsic requires it.
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(chunk, zero));
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're converting the string in fixed size blocks.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. The intrinsic requires it.
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(chunk, zero));
+
+                // Non-ASCII bytes have their most significant bit set.
+                const auto mask = _mm_movemask_epi8(chunk);
+                if (mask != 0)
+                {
+                    unsigned long bit = 0;
+                    _BitScanForward(&bit, static_cast<unsigned long>(mask));
+                    return i + bit;
+                }
+            }
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. The caller guarantees the lengths.
+            for (; i < length && static_cast<BYTE>(in[i]) < 0x80; ++i)
+            {
+                out[i] = static_cast<wchar_t>(in[i]);
+            }
+#pragma warning(pop)
+
+            return i;
+        }
+
+        // Routine Description:
+        // - Converts a UTF-8 string to UTF-16.
+        //   Each maximal subpart of an ill-formed sequence is replaced with one U+FFFD.
+        // Arguments:
+        // - in - the UTF-8 string
+        // - out - receives the UTF-16 code units, must have room for `in.length()` of them.
+        //         No UTF-8 sequence takes fewer code units than its UTF-16 counterpart.
+        // Return Value:
+        // - the number of UTF-16 code units written
+        inline size_t u8u16transcode(const std::string_view in, wchar_t* const out) noexcept
+        {
+            constexpr wchar_t replacementChar{ 0xFFFD };
+
+#pragma warning(push)
+#pragma warning(disable : 26481) // Don't use pointer arithmetic. The caller guarantees the lengths.
+#pragma warning(disable : 26446) // Prefer to use gsl::at(). The loop conditions keep the indexes in bounds.
+            size_t i = 0;
+            size_t o = 0;
+            while (i < in.length())
+            {
+                const auto ascii = u8u16ascii(in.data() + i, in.length() - i, out + o);
+                i += ascii;
+                o += ascii;
+                if (i >= in.length())
+                {
+                    break;
+                }
+
+                // The lead byte tells the length of the sequence and the range that its first
+                // continuation byte has to fall in, see table 3-7 of the Unicode standard.
+                const auto lead = static_cast<BYTE>(in[i++]);
+                size_t needed{};
+                unsigned int codepoint{};
+                BYTE lower{ 0x80 };
+                BYTE upper{ 0xBF };
+                if (lead >= 0xC2 && lead <= 0xDF)
+                {
+                    needed = 1;
+                    codepoint = lead & 0x1Fu;
+                }
+                else if (lead >= 0xE0 && lead <= 0xEF)
+                {
+                    needed = 2;
+                    codepoint = lead & 0x0Fu;
+                    lower = lead == 0xE0 ? 0xA0 : lower; // overlong
+                    upper = lead == 0xED ? 0x9F : upper; // surrogates
+                }
+                else if (lead >= 0xF0 && lead <= 0xF4)
+                {
+                    needed = 3;
+                    codepoint = lead & 0x07u;
+                    lower = lead == 0xF0 ? 0x90 : lower; // overlong
+                    upper = lead == 0xF4 ? 0x8F : upper; // beyond U+10FFFF
+                }
+                else
+                {
+                    // a continuation byte without a lead, or a byte that never occurs in UTF-8
+                    out[o++] = replacementChar;
+                    continue;
+                }
+
+                size_t got = 0;
+                for (; got < needed && i < in.length(); ++got, ++i)
+                {
+                    const auto trail = static_cast<BYTE>(in[i]);
+                    if (trail < lower || trail > upper)
+                    {
+                        break;
+                    }
+                    codepoint = (codepoint << 6) | (trail & 0x3Fu);
+                    lower = 0x80;
+                    upper = 0xBF;
+                }
+
+                if (got != needed)
+                {
+                    // The bytes consumed so far are the maximal subpart. The byte that
+                    // broke the sequence gets looked at again as the start of a new one.
+                    out[o++] = replacementChar;
+                }
+                else if (codepoint >= 0x10000)
+                {
+                    codepoint -= 0x10000;
+                    out[o++] = static_cast<wchar_t>(0xD800 + (codepoint >> 10));
+                    out[o++] = static_cast<wchar_t>(0xDC00 + (codepoint & 0x3FF));
+                }
+                else
+                {
+                    out[o++] = static_cast<wchar_t>(codepoint);
+                }
+            }
+#pragma warning(pop)
+
+            return o;
+        }
+    }
+
     template<class charT>
     class u8u16state final
     {
@@ -263,7 +422,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
     // Return Value:
     // - S_OK          - the conversion succeded
     // - E_OUTOFMEMORY - the function failed to allocate memory for the resulting string
-    // - E_ABORT       - the resulting string length would exceed the upper boundary of an int and thus, the conversion was aborted before the conversion has been completed
+    // - E_ABORT       - the resulting string length would exceed the max_size and thus, the conversion was aborted before the conversion has been completed
     // - E_UNEXPECTED  - an unexpected error occurred
     template<class inT, class outT>
     [[nodiscard]] typename std::enable_if<std::is_same<typename inT::value_type, char>::value && std::is_same<typename outT::value_type, wchar_t>::value, HRESULT>::type
@@ -278,14 +437,12 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
                 return S_OK;
             }
 
-            int lengthRequired{};
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
-            RETURN_HR_IF(E_ABORT, FAILED(SizeTToInt(in.length(), &lengthRequired)));
-            out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
+            out.resize(in.length());
+            const auto lengthOut = details::u8u16transcode({ in.data(), in.length() }, out.data());
+            out.resize(lengthOut);
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            return S_OK;
         }
         catch (std::length_error&)
         {
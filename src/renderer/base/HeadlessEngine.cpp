@@ -0,0 +1,459 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "HeadlessEngine.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+namespace
+{
+    std::wstring FormatCoord(const COORD coord)
+    {
+        return std::to_wstring(coord.X) + L"," + std::to_wstring(coord.Y);
+    }
+
+    std::wstring FormatRect(const SMALL_RECT rect)
+    {
+        return std::to_wstring(rect.Left) + L"," + std::to_wstring(rect.Top) + L"-" +
+               std::to_wstring(rect.Right) + L"," + std::to_wstring(rect.Bottom);
+    }
+
+    std::wstring FormatColor(const COLORREF color)
+    {
+        wchar_t buffer[8];
+        swprintf_s(buffer, L"#%02x%02x%02x", GetRValue(color), GetGValue(color), GetBValue(color));
+        return buffer;
+    }
+}
+
+// Routine Description:
+// - Creates a headless engine with a blank grid of the given size.
+// Arguments:
+// - size - The width and height of the grid, in cells.
+HeadlessEngine::HeadlessEngine(const COORD size) :
+    RenderEngineBase(),
+    _size{ Viewport::FromDimensions(size) },
+    _cells{},
+    _invalidRect{ Viewport::Empty() },
+    _invalidUsed{ false },
+    _brush{ L" ", 0, 0, 0, ExtendedAttributes::Normal, false },
+    _cursor{ std::nullopt },
+    _title{},
+    _frames{ 0 },
+    _logging{ true },
+    _log{}
+{
+    THROW_HR_IF(E_INVALIDARG, !_size.IsValid());
+    _cells.resize(static_cast<size_t>(_size.Width()) * _size.Height(), _brush);
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
+try
+{
+    _InvalidCombine(Viewport::FromExclusive(*psrRegion));
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateCursor(const COORD* const pcoordCursor) noexcept
+try
+{
+    _InvalidCombine(Viewport::FromCoord(*pcoordCursor));
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept
+{
+    // We don't have a window for the system to ask us to redraw.
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept
+try
+{
+    for (const auto& rect : rectangles)
+    {
+        _InvalidCombine(Viewport::FromExclusive(rect));
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
+{
+    // We don't move the grid around to save painting. A scroll simply repaints everything.
+    if (pcoordDelta->X != 0 || pcoordDelta->Y != 0)
+    {
+        return InvalidateAll();
+    }
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateAll() noexcept
+try
+{
+    _InvalidCombine(_size);
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
+{
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
+{
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Starts a frame. Like the other engines, there's nothing to do when nothing
+//      was invalidated since the last frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK to paint a frame, S_FALSE if there's nothing to paint.
+[[nodiscard]] HRESULT HeadlessEngine::StartPaint() noexcept
+try
+{
+    if (!_invalidUsed && !_titleChanged)
+    {
+        return S_FALSE;
+    }
+
+    _Log(L"StartPaint", FormatRect(_invalidRect.ToInclusive()));
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::EndPaint() noexcept
+try
+{
+    _invalidRect = Viewport::Empty();
+    _invalidUsed = false;
+    _frames++;
+
+    _Log(L"EndPaint", {});
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::Present() noexcept
+{
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::ScrollFrame() noexcept
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Blanks the invalid part of the grid with the current brush.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or a suitable HRESULT if we failed to allocate.
+[[nodiscard]] HRESULT HeadlessEngine::PaintBackground() noexcept
+try
+{
+    const auto dirty = Viewport::Intersect(_invalidRect, _size);
+    for (auto y = dirty.Top(); y < dirty.BottomExclusive(); y++)
+    {
+        for (auto x = dirty.Left(); x < dirty.RightExclusive(); x++)
+        {
+            _CellAt({ x, y }) = _brush;
+        }
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+// Routine Description:
+// - Paints a run of text into the grid with the current brush. A cluster that
+//      spans several columns fills its first cell, and blanks the others.
+// Arguments:
+// - clusters - text and column widths to be painted
+// - coord - where in the grid the run starts
+// - trimLeft - unused
+// Return Value:
+// - S_OK, or a suitable HRESULT if we failed to allocate.
+[[nodiscard]] HRESULT HeadlessEngine::PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                                      const COORD coord,
+                                                      const bool /*trimLeft*/) noexcept
+try
+{
+    std::wstring text;
+    auto target = coord;
+    for (const auto& cluster : clusters)
+    {
+        text.append(cluster.GetText());
+        for (size_t i = 0; i < cluster.GetColumns(); i++)
+        {
+            if (_size.IsInBounds(target))
+            {
+                auto& cell = _CellAt(target);
+                cell = _brush;
+                cell.text = i == 0 ? std::wstring{ cluster.GetText() } : std::wstring{};
+            }
+            target.X++;
+        }
+    }
+
+    _Log(L"PaintBufferLine", FormatCoord(coord) + L" \"" + text + L"\"");
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::PaintBufferGridLines(const GridLines lines,
+                                                           const COLORREF color,
+                                                           const size_t cchLine,
+                                                           const COORD coordTarget) noexcept
+try
+{
+    if (lines != GridLines::None)
+    {
+        _Log(L"PaintBufferGridLines", FormatCoord(coordTarget) + L" " + std::to_wstring(cchLine) + L" " + FormatColor(color));
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::PaintSelection(const SMALL_RECT rect) noexcept
+try
+{
+    const auto selection = Viewport::Intersect(Viewport::FromExclusive(rect), _size);
+    for (auto y = selection.Top(); y < selection.BottomExclusive(); y++)
+    {
+        for (auto x = selection.Left(); x < selection.RightExclusive(); x++)
+        {
+            _CellAt({ x, y }).selected = true;
+        }
+    }
+
+    _Log(L"PaintSelection", FormatRect(rect));
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::PaintCursor(const CursorOptions& options) noexcept
+try
+{
+    if (options.isOn)
+    {
+        _cursor = options.coordCursor;
+        _Log(L"PaintCursor", FormatCoord(options.coordCursor));
+    }
+    else
+    {
+        _cursor = std::nullopt;
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::UpdateDrawingBrushes(const COLORREF colorForeground,
+                                                           const COLORREF colorBackground,
+                                                           const WORD legacyColorAttribute,
+                                                           const ExtendedAttributes extendedAttrs,
+                                                           const bool /*isSettingDefaultBrushes*/) noexcept
+try
+{
+    _brush.foreground = colorForeground;
+    _brush.background = colorBackground;
+    _brush.legacyAttributes = legacyColorAttribute;
+    _brush.extendedAttributes = extendedAttrs;
+
+    _Log(L"UpdateDrawingBrushes", FormatColor(colorForeground) + L" " + FormatColor(colorBackground));
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::UpdateFont(const FontInfoDesired& /*fiFontInfoDesired*/, FontInfo& /*fiFontInfo*/) noexcept
+{
+    return S_OK;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::UpdateDpi(const int /*iDpi*/) noexcept
+{
+    return S_OK;
+}
+
+// Routine Description:
+// - Resizes the grid to match the new viewport, keeping whatever was painted
+//      in the part that's still visible.
+// Arguments:
+// - srNewViewport - The bounds of the new viewport.
+// Return Value:
+// - S_OK, or a suitable HRESULT if we failed to allocate.
+[[nodiscard]] HRESULT HeadlessEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
+try
+{
+    const auto newSize = Viewport::FromDimensions(Viewport::FromInclusive(srNewViewport).Dimensions());
+    if (newSize.Dimensions() != _size.Dimensions())
+    {
+        std::vector<Cell> cells(static_cast<size_t>(newSize.Width()) * newSize.Height(), _brush);
+        const auto kept = Viewport::Intersect(_size, newSize);
+        for (auto y = kept.Top(); y < kept.BottomExclusive(); y++)
+        {
+            for (auto x = kept.Left(); x < kept.RightExclusive(); x++)
+            {
+                cells.at(static_cast<size_t>(y) * newSize.Width() + x) = _CellAt({ x, y });
+            }
+        }
+
+        _cells.swap(cells);
+        _size = newSize;
+        _InvalidCombine(_size);
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
+[[nodiscard]] HRESULT HeadlessEngine::GetProposedFont(const FontInfoDesired& /*fiFontInfoDesired*/, FontInfo& /*fiFontInfo*/, const int /*iDpi*/) noexcept
+{
+    return S_OK;
+}
+
+SMALL_RECT HeadlessEngine::GetDirtyRectInChars()
+{
+    return _invalidRect.ToInclusive();
+}
+
+// Routine Description:
+// - We don't have a font. Every cell is one unit big.
+[[nodiscard]] HRESULT HeadlessEngine::GetFontSize(_Out_ COORD* const pFontSize) noexcept
+{
+    *pFontSize = { 1, 1 };
+    return S_OK;
+}
+
+// Routine Description:
+// - We don't have a font to measure glyphs with.
+// Return Value:
+// - S_FALSE: the renderer should use another engine's value.
+[[nodiscard]] HRESULT HeadlessEngine::IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept
+{
+    *pResult = false;
+    return S_FALSE;
+}
+
+[[nodiscard]] HRESULT HeadlessEngine::_DoUpdateTitle(_In_ const std::wstring& newTitle) noexcept
+try
+{
+    _title = newTitle;
+    _Log(L"UpdateTitle", newTitle);
+    return S_OK;
+}
+CATCH_RETURN();
+
+COORD HeadlessEngine::GetSize() const noexcept
+{
+    return _size.Dimensions();
+}
+
+// Routine Description:
+// - Gets a cell of the grid, as it was last painted.
+// Arguments:
+// - coord - The position of the cell. Throws if it's outside the grid.
+// Return Value:
+// - The cell.
+const HeadlessEngine::Cell& HeadlessEngine::GetCell(const COORD coord) const
+{
+    THROW_HR_IF(E_INVALIDARG, !_size.IsInBounds(coord));
+    return _cells.at(static_cast<size_t>(coord.Y) * _size.Width() + coord.X);
+}
+
+// Routine Description:
+// - Gets the text of a whole row of the grid, for comparing against a known
+//      good frame.
+// Arguments:
+// - row - The row to read. Throws if it's outside the grid.
+// Return Value:
+// - The text of the row.
+std::wstring HeadlessEngine::GetRowText(const SHORT row) const
+{
+    std::wstring text;
+    for (SHORT x = 0; x < _size.Width(); x++)
+    {
+        text.append(GetCell({ x, row }).text);
+    }
+    return text;
+}
+
+// Routine Description:
+// - Gets where the cursor was painted in the last frame, if it was visible.
+std::optional<COORD> HeadlessEngine::GetCursorPosition() const noexcept
+{
+    return _cursor;
+}
+
+const std::wstring& HeadlessEngine::GetTitle() const noexcept
+{
+    return _title;
+}
+
+// Routine Description:
+// - Gets how many frames we've painted, to measure the renderer's throughput.
+size_t HeadlessEngine::GetFrameCount() const noexcept
+{
+    return _frames;
+}
+
+// Routine Description:
+// - Gets the log of the calls we received, one line per call. The log can get
+//      large, turn it off with SetCallLogging when measuring throughput.
+const std::vector<std::wstring>& HeadlessEngine::GetCallLog() const noexcept
+{
+    return _log;
+}
+
+void HeadlessEngine::SetCallLogging(const bool enabled) noexcept
+{
+    _logging = enabled;
+}
+
+void HeadlessEngine::ClearCallLog() noexcept
+{
+    _log.clear();
+}
+
+HeadlessEngine::Cell& HeadlessEngine::_CellAt(const COORD coord)
+{
+    return _cells.at(static_cast<size_t>(coord.Y) * _size.Width() + coord.X);
+}
+
+void HeadlessEngine::_InvalidCombine(const Viewport& invalid)
+{
+    const auto clipped = Viewport::Intersect(invalid, _size);
+    if (clipped.Width() <= 0 || clipped.Height() <= 0)
+    {
+        return;
+    }
+
+    _invalidRect = _invalidUsed ? Viewport::Union(_invalidRect, clipped) : clipped;
+    _invalidUsed = true;
+}
+
+void HeadlessEngine::_Log(const std::wstring_view call, const std::wstring_view details)
+{
+    if (_logging)
+    {
+        std::wstring line{ call };
+        if (!details.empty())
+        {
+            line.append(L" ");
+            line.append(details);
+        }
+        _log.emplace_back(std::move(line));
+    }
+}
@@ -0,0 +1,115 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HeadlessEngine.hpp
+
+Abstract:
+- A render engine that doesn't need a display or a pipe. It paints into a grid
+  of cells in memory and keeps a log of the calls it received, so frames can be
+  compared against known good output, and the renderer can be measured without
+  the cost of a real engine.
+--*/
+
+#pragma once
+
+#include "..\inc\RenderEngineBase.hpp"
+
+namespace Microsoft::Console::Render
+{
+    class HeadlessEngine final : public RenderEngineBase
+    {
+    public:
+        // One cell of the grid, as it was last painted.
+        struct Cell
+        {
+            std::wstring text;
+            COLORREF foreground;
+            COLORREF background;
+            WORD legacyAttributes;
+            ExtendedAttributes extendedAttributes;
+            bool selected;
+        };
+
+        HeadlessEngine(const COORD size);
+        ~HeadlessEngine() override = default;
+
+        // IRenderEngine Members
+        [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override;
+        [[nodiscard]] HRESULT InvalidateCursor(const COORD* const pcoordCursor) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSystem(const RECT* const prcDirtyClient) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override;
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
+
+        [[nodiscard]] HRESULT StartPaint() noexcept override;
+        [[nodiscard]] HRESULT EndPaint() noexcept override;
+        [[nodiscard]] HRESULT Present() noexcept override;
+
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override;
+
+        [[nodiscard]] HRESULT PaintBackground() noexcept override;
+        [[nodiscard]] HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                              const COORD coord,
+                                              const bool trimLeft) noexcept override;
+        [[nodiscard]] HRESULT PaintBufferGridLines(const GridLines lines,
+                                                   const COLORREF color,
+                                                   const size_t cchLine,
+                                                   const COORD coordTarget) noexcept override;
+        [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT rect) noexcept override;
+
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const COLORREF colorForeground,
+                                                   const COLORREF colorBackground,
+                                                   const WORD legacyColorAttribute,
+                                                   const ExtendedAttributes extendedAttrs,
+                                                   const bool isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo) noexcept override;
+        [[nodiscard]] HRESULT UpdateDpi(const int iDpi) noexcept override;
+        [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override;
+
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo, const int iDpi) noexcept override;
+
+        SMALL_RECT GetDirtyRectInChars() override;
+        [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
+        [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+
+        // Inspecting what was painted
+        COORD GetSize() const noexcept;
+        const Cell& GetCell(const COORD coord) const;
+        std::wstring GetRowText(const SHORT row) const;
+        std::optional<COORD> GetCursorPosition() const noexcept;
+        const std::wstring& GetTitle() const noexcept;
+        size_t GetFrameCount() const noexcept;
+
+        const std::vector<std::wstring>& GetCallLog() const noexcept;
+        void SetCallLogging(const bool enabled) noexcept;
+        void ClearCallLog() noexcept;
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(_In_ const std::wstring& newTitle) noexcept override;
+
+    private:
+        Microsoft::Console::Types::Viewport _size;
+        std::vector<Cell> _cells;
+
+        Microsoft::Console::Types::Viewport _invalidRect;
+        bool _invalidUsed;
+
+        Cell _brush;
+        std::optional<COORD> _cursor;
+        std::wstring _title;
+        size_t _frames;
+
+        bool _logging;
+        std::vector<std::wstring> _log;
+
+        Cell& _CellAt(const COORD coord);
+        void _InvalidCombine(const Microsoft::Console::Types::Viewport& invalid);
+        void _Log(const std::wstring_view call, const std::wstring_view details);
+    };
+}
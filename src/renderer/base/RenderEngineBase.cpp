@@ -35,3 +35,15 @@ HRESULT RenderEngineBase::UpdateTitle(const std::wstring& newTitle) noexcept
     }
     return hr;
 }
+
+// Routine Description:
+// - Gets how many bytes this engine has written to its output stream since it
+//      was created. Engines that draw to a surface don't write any.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of bytes written, 0 by default.
+size_t RenderEngineBase::GetBytesWritten() const noexcept
+{
+    return 0;
+}
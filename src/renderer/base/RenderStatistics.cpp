@@ -0,0 +1,121 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "../inc/RenderStatistics.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+RenderStatistics::RenderStatistics() noexcept :
+    _slots{},
+    _total{ 0 }
+{
+}
+
+// Routine Description:
+// - Adds a frame to the ring, replacing the oldest one once the ring is full.
+// - Only one thread (the render thread) may record frames.
+// Arguments:
+// - frame - The statistics of the frame that was just painted.
+// Return Value:
+// - <none>
+void RenderStatistics::Record(const FrameStatistics& frame) noexcept
+{
+    const auto total = _total.load(std::memory_order_relaxed);
+    auto& slot = til::at(_slots, total % s_Capacity);
+
+    const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frame = frame;
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    _total.store(total + 1, std::memory_order_release);
+}
+
+// Routine Description:
+// - Gets how many frames were recorded since we started, including the ones
+//      that have since fallen out of the ring.
+size_t RenderStatistics::GetTotalFrames() const noexcept
+{
+    return _total.load(std::memory_order_acquire);
+}
+
+// Routine Description:
+// - Copies the frames still held by the ring, oldest first. Safe to call from
+//      any thread while the render thread is recording.
+// Arguments:
+// - <none>
+// Return Value:
+// - Up to s_Capacity of the most recent frames.
+std::vector<FrameStatistics> RenderStatistics::GetRecentFrames() const
+{
+    const auto total = GetTotalFrames();
+    const auto count = std::min(total, s_Capacity);
+
+    std::vector<FrameStatistics> frames;
+    frames.reserve(count);
+    for (auto i = total - count; i < total; ++i)
+    {
+        const auto& slot = _slots.at(i % s_Capacity);
+        for (;;)
+        {
+            const auto before = slot.sequence.load(std::memory_order_acquire);
+            if (before % 2 != 0)
+            {
+                continue;
+            }
+
+            const auto frame = slot.frame;
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (slot.sequence.load(std::memory_order_relaxed) == before)
+            {
+                frames.push_back(frame);
+                break;
+            }
+        }
+    }
+    return frames;
+}
+
+// Routine Description:
+// - Computes the median and 99th percentile of the times of the recent frames.
+// Arguments:
+// - <none>
+// Return Value:
+// - The percentiles, all zero if no frames were recorded yet.
+FrameStatisticsSummary RenderStatistics::Summarize() const
+{
+    const auto frames = GetRecentFrames();
+
+    FrameStatisticsSummary summary;
+    summary.frameCount = frames.size();
+    if (frames.empty())
+    {
+        return summary;
+    }
+
+    std::vector<std::chrono::microseconds> times(frames.size());
+    const auto percentiles = [&](std::chrono::microseconds FrameStatistics::*member) {
+        std::transform(frames.cbegin(), frames.cend(), times.begin(), [&](const auto& frame) {
+            return frame.*member;
+        });
+        std::sort(times.begin(), times.end());
+
+        // Nearest rank: the smallest time that at least p% of the frames don't exceed.
+        const auto rank = [&](const size_t percent) {
+            return times.at((times.size() * percent + 99) / 100 - 1);
+        };
+        return FrameTimePercentiles{ rank(50), rank(99) };
+    };
+
+    summary.lockTime = percentiles(&FrameStatistics::lockTime);
+    summary.paintTime = percentiles(&FrameStatistics::paintTime);
+    summary.presentTime = percentiles(&FrameStatistics::presentTime);
+    return summary;
+}
@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "frameScheduler.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+
+FrameScheduler::FrameScheduler() :
+    FrameScheduler(&clock::now)
+{
+}
+
+// Routine Description:
+// - Creates a scheduler that reads the time from the given clock.
+// Arguments:
+// - now - Returns the current time. Tests can substitute their own.
+FrameScheduler::FrameScheduler(NowFunc now) :
+    _now{ std::move(now) },
+    _targetFps{ s_DefaultTargetFps },
+    _lowLatency{ false },
+    _lastFrame{ std::nullopt }
+{
+    THROW_HR_IF(E_INVALIDARG, !_now);
+}
+
+// Routine Description:
+// - Sets how many frames per second we're allowed to paint at most.
+// Arguments:
+// - fps - The target frame rate. Must be greater than 0.
+// Return Value:
+// - <none>
+void FrameScheduler::SetTargetFps(const UINT fps)
+{
+    THROW_HR_IF(E_INVALIDARG, fps == 0);
+    _targetFps = fps;
+}
+
+UINT FrameScheduler::GetTargetFps() const noexcept
+{
+    return _targetFps;
+}
+
+// Routine Description:
+// - In low latency mode, a requested frame is always painted right away, so
+//      that echoing a keystroke never waits on the frame budget. Requests are
+//      still coalesced while a frame is being painted.
+// Arguments:
+// - lowLatency - true to paint every frame as soon as it's requested.
+// Return Value:
+// - <none>
+void FrameScheduler::SetLowLatency(const bool lowLatency) noexcept
+{
+    _lowLatency = lowLatency;
+}
+
+bool FrameScheduler::IsLowLatency() const noexcept
+{
+    return _lowLatency;
+}
+
+// Routine Description:
+// - Determines how long to wait before painting a frame that was just
+//      requested. Anything else requested in the meantime is part of the same
+//      frame.
+// Arguments:
+// - <none>
+// Return Value:
+// - The time left in the budget of the last frame, or zero to paint now.
+FrameScheduler::clock::duration FrameScheduler::TimeUntilNextFrame() const
+{
+    if (_lowLatency || !_lastFrame.has_value())
+    {
+        return clock::duration::zero();
+    }
+
+    const auto budget = std::chrono::duration_cast<clock::duration>(std::chrono::seconds{ 1 }) / _targetFps.load();
+    const auto elapsed = _now() - _lastFrame.value();
+    return elapsed >= budget ? clock::duration::zero() : budget - elapsed;
+}
+
+// Routine Description:
+// - Records that a frame was just painted. The budget of the next frame starts now.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void FrameScheduler::FramePainted()
+{
+    _lastFrame = _now();
+}
@@ -0,0 +1,47 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- frameScheduler.hpp
+
+Abstract:
+- Decides when the render thread should paint the next frame. A frame that's
+  requested after the screen has been idle for a whole frame budget is painted
+  right away. Requests that arrive in a burst are coalesced, so we paint at most
+  one frame per budget.
+- The clock can be replaced, so the pacing can be tested without waiting on a
+  real one.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Render
+{
+    class FrameScheduler final
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+        using NowFunc = std::function<clock::time_point()>;
+
+        static constexpr UINT s_DefaultTargetFps = 125;
+
+        FrameScheduler();
+        FrameScheduler(NowFunc now);
+
+        void SetTargetFps(const UINT fps);
+        UINT GetTargetFps() const noexcept;
+
+        void SetLowLatency(const bool lowLatency) noexcept;
+        bool IsLowLatency() const noexcept;
+
+        clock::duration TimeUntilNextFrame() const;
+        void FramePainted();
+
+    private:
+        NowFunc _now;
+        std::atomic<UINT> _targetFps;
+        std::atomic<bool> _lowLatency;
+        std::optional<clock::time_point> _lastFrame;
+    };
+}
@@ -88,15 +88,27 @@ Renderer::~Renderer()
 {
     FAIL_FAST_IF_NULL(pEngine); // This is a programming error. Fail fast.
 
+    using std::chrono::steady_clock;
+    const auto elapsedSince = [](const steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(steady_clock::now() - start);
+    };
+
+    _frameStatistics = {};
+    _lastBrushes.reset();
+    const auto bytesBefore = pEngine->GetBytesWritten();
+
+    const auto lockStart = steady_clock::now();
     _pData->LockConsole();
     auto unlock = wil::scope_exit([&]() {
         _pData->UnlockConsole();
+        _frameStatistics.lockTime = elapsedSince(lockStart);
     });
 
     // Last chance check if anything scrolled without an explicit invalidate notification since the last frame.
     _CheckViewportAndScroll();
 
     // Try to start painting a frame
+    const auto paintStart = steady_clock::now();
     HRESULT const hr = pEngine->StartPaint();
     RETURN_IF_FAILED(hr);
 
@@ -110,8 +122,13 @@ Renderer::~Renderer()
 
     auto endPaint = wil::scope_exit([&]() {
         LOG_IF_FAILED(pEngine->EndPaint());
+        _frameStatistics.paintTime = elapsedSince(paintStart);
     });
 
+    const auto dirty = Viewport::FromInclusive(pEngine->GetDirtyRectInChars());
+    _frameStatistics.invalidatedCells = static_cast<size_t>(std::max<int>(dirty.Width(), 0)) *
+                                        static_cast<size_t>(std::max<int>(dirty.Height(), 0));
+
     // A. Prep Colors
     RETURN_IF_FAILED(_UpdateDrawingBrushes(pEngine, _pData->GetDefaultBrushColors(), true));
 
@@ -143,7 +160,12 @@ Renderer::~Renderer()
     unlock.reset();
 
     // Trigger out-of-lock presentation for renderers that can support it
+    const auto presentStart = steady_clock::now();
     RETURN_IF_FAILED(pEngine->Present());
+    _frameStatistics.presentTime = elapsedSince(presentStart);
+
+    _frameStatistics.bytesWritten = pEngine->GetBytesWritten() - bytesBefore;
+    _statistics.Record(_frameStatistics);
 
     // As we leave the scope, EndPaint will be called (declared above)
     return S_OK;
@@ -586,85 +608,87 @@ void Renderer::_PaintBufferOutput(_In_ IRenderEngine* const pEngine)
             // This means that we need 14,27 out of the backing buffer to fill in the 1,1 cell of the screen.
             const auto screenLine = Viewport::Offset(bufferLine, -view.Origin());
 
-            // Retrieve the cell information iterator limited to just this line we want to redraw.
-            auto it = buffer.GetCellDataAt(bufferLine.Origin(), bufferLine);
+            // Retrieve the row holding the line we want to redraw.
+            const auto& bufferRow = buffer.GetRowByOffset(gsl::narrow<size_t>(bufferLine.Top()));
 
             // Ask the helper to paint through this specific line.
-            _PaintBufferOutputHelper(pEngine, it, screenLine.Origin());
+            _PaintBufferOutputHelper(pEngine,
+                                     bufferRow,
+                                     gsl::narrow<size_t>(bufferLine.Left()),
+                                     gsl::narrow<size_t>(bufferLine.RightExclusive()),
+                                     screenLine.Origin());
         }
     }
 }
 
+// Routine Description:
+// - Paints one line of a row of the buffer. The line is walked one attribute
+//      run at a time, straight from the row's attribute runs and character
+//      data, and each run is handed to the engine as a single call.
+// - The clusters are accumulated in a buffer owned by the renderer, so once it
+//      has grown to the width of the widest line, painting allocates nothing.
+// Arguments:
+// - pEngine - The render engine to paint with.
+// - row - The row of the buffer to paint from.
+// - startColumn - The first column of the row to paint.
+// - endColumn - One past the last column of the row to paint.
+// - target - Where on the screen the first column should be painted.
+// Return Value:
+// - <none>
 void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                        TextBufferCellIterator it,
+                                        const ROW& row,
+                                        const size_t startColumn,
+                                        const size_t endColumn,
                                         const COORD target)
 {
-    // If we have valid data, let's figure out how to draw it.
-    if (it)
-    {
-        // TODO: MSFT: 20961091 -  This is a perf issue. Instead of rebuilding this and allocing memory to hold the reinterpretation,
-        // we should have an iterator/view adapter for the rendering.
-        // That would probably also eliminate the RenderData needing to give us the entire TextBuffer as well...
-        // Retrieve the iterator for one line of information.
-        std::vector<Cluster> clusters;
-        size_t cols = 0;
+    const auto& charRow = row.GetCharRow();
+    const auto& attrRow = row.GetAttrRow();
+    const auto end = std::min(endColumn, charRow.size());
 
-        // Retrieve the first color.
-        auto color = it->TextAttr();
+    _frameStatistics.rowsPainted++;
 
-        // And hold the point where we should start drawing.
-        auto screenPoint = target;
+    // Hold the point where we should start drawing.
+    auto screenPoint = target;
 
-        // This outer loop will continue until we reach the end of the text we are trying to draw.
-        while (it)
+    auto column = startColumn;
+    while (column < end)
+    {
+        // Find the attribute for this run and how far it goes.
+        size_t applies = 0;
+        const auto runColor = attrRow.GetAttrByColumn(column, &applies);
+        const auto runEnd = std::min(end, column + std::max<size_t>(applies, 1));
+
+        // Update the drawing brushes with our color.
+        THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, runColor, false));
+
+        // Walk through the text data of the run and turn it into rendering clusters.
+        // A wide glyph that starts inside the run belongs to it, even if its
+        // trailing half has a different attribute.
+        _clusterBuffer.clear();
+        size_t cols = 0;
+        while (column < runEnd)
         {
-            // Hold onto the current run color right here for the length of the outer loop.
-            // We'll be changing the persistent one as we run through the inner loops to detect
-            // when a run changes, but we will still need to know this color at the bottom
-            // when we go to draw gridlines for the length of the run.
-            const auto currentRunColor = color;
-
-            // Update the drawing brushes with our color.
-            THROW_IF_FAILED(_UpdateDrawingBrushes(pEngine, currentRunColor, false));
-
-            // Advance the point by however many columns we've just outputted and reset the accumulator.
-            screenPoint.X += gsl::narrow<SHORT>(cols);
-            cols = 0;
-
-            // Ensure that our cluster vector is clear.
-            clusters.clear();
-
-            // This inner loop will accumulate clusters until the color changes.
-            // When the color changes, it will save the new color off and break.
-            do
-            {
-                if (color != it->TextAttr())
-                {
-                    color = it->TextAttr();
-                    break;
-                }
-
-                // Walk through the text data and turn it into rendering clusters.
-                clusters.emplace_back(it->Chars(), it->Columns());
-
-                // Advance the cluster and column counts.
-                const auto columnCount = clusters.back().GetColumns();
-                it += columnCount > 0 ? columnCount : 1; // prevent infinite loop for no visible columns
-                cols += columnCount;
-
-            } while (it);
+            const auto& dbcsAttr = charRow.DbcsAttrAt(column);
+            const size_t columnCount = dbcsAttr.IsLeading() ? 2 : 1;
+            _clusterBuffer.emplace_back(charRow.GlyphAt(column), columnCount);
+            column += columnCount;
+            cols += columnCount;
+        }
 
-            // Do the painting.
-            // TODO: Calculate when trim left should be TRUE
-            THROW_IF_FAILED(pEngine->PaintBufferLine({ clusters.data(), clusters.size() }, screenPoint, false));
+        // Do the painting.
+        // TODO: Calculate when trim left should be TRUE
+        THROW_IF_FAILED(pEngine->PaintBufferLine({ _clusterBuffer.data(), _clusterBuffer.size() }, screenPoint, false));
+        _frameStatistics.clustersEmitted += _clusterBuffer.size();
 
-            // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
-            if (_pData->IsGridLineDrawingAllowed())
-            {
-                // We're only allowed to draw the grid lines under certain circumstances.
-                _PaintBufferOutputGridLineHelper(pEngine, currentRunColor, cols, screenPoint);
-            }
+        // If we're allowed to do grid drawing, draw that now too (since it will be coupled with the color data)
+        if (_pData->IsGridLineDrawingAllowed())
+        {
+            // We're only allowed to draw the grid lines under certain circumstances.
+            _PaintBufferOutputGridLineHelper(pEngine, runColor, cols, screenPoint);
         }
+
+        // Advance the point by however many columns we've just outputted.
+        screenPoint.X += gsl::narrow<SHORT>(cols);
     }
 }
 
@@ -803,9 +827,9 @@ void Renderer::_PaintOverlay(IRenderEngine& engine,
                 const COORD target{ viewDirty.Left(), iRow };
                 const auto source = target - overlay.origin;
 
-                auto it = overlay.buffer.GetCellLineDataAt(source);
+                const auto& overlayRow = overlay.buffer.GetRowByOffset(gsl::narrow<size_t>(source.Y));
 
-                _PaintBufferOutputHelper(&engine, it, target);
+                _PaintBufferOutputHelper(&engine, overlayRow, gsl::narrow<size_t>(source.X), overlayRow.size(), target);
             }
         }
     }
@@ -882,6 +906,13 @@ void Renderer::_PaintSelection(_In_ IRenderEngine* const pEngine)
     //      then on the next engine we might not update the color.
     RETURN_IF_FAILED(pEngine->UpdateDrawingBrushes(rgbForeground, rgbBackground, legacyAttributes, extendedAttrs, isSettingDefaultBrushes));
 
+    const auto brushes = std::make_tuple(rgbForeground, rgbBackground, legacyAttributes, extendedAttrs);
+    if (_lastBrushes != brushes)
+    {
+        _lastBrushes = brushes;
+        _frameStatistics.brushChanges++;
+    }
+
     return S_OK;
 }
 
@@ -938,3 +969,28 @@ void Renderer::AddRenderEngine(_In_ IRenderEngine* const pEngine)
     THROW_HR_IF_NULL(E_INVALIDARG, pEngine);
     _rgpEngines.push_back(pEngine);
 }
+
+// Method Description:
+// - Gets the statistics of the frames we've painted recently, oldest first.
+//      There's one entry per engine for every frame. Safe to call from any
+//      thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - The statistics of up to the last RenderStatistics::s_Capacity frames.
+std::vector<FrameStatistics> Renderer::GetRecentFrameStatistics() const
+{
+    return _statistics.GetRecentFrames();
+}
+
+// Method Description:
+// - Gets the median and 99th percentile of the lock, paint and present times
+//      of the frames we've painted recently. Safe to call from any thread.
+// Arguments:
+// - <none>
+// Return Value:
+// - The summary of the recent frames.
+FrameStatisticsSummary Renderer::GetFrameStatisticsSummary() const
+{
+    return _statistics.Summarize();
+}
@@ -76,6 +76,9 @@ namespace Microsoft::Console::Render
 
         void AddRenderEngine(_In_ IRenderEngine* const pEngine) override;
 
+        std::vector<FrameStatistics> GetRecentFrameStatistics() const override;
+        FrameStatisticsSummary GetFrameStatisticsSummary() const override;
+
     private:
         std::deque<IRenderEngine*> _rgpEngines;
 
@@ -95,9 +98,22 @@ namespace Microsoft::Console::Render
         void _PaintBufferOutput(_In_ IRenderEngine* const pEngine);
 
         void _PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
-                                      TextBufferCellIterator it,
+                                      const ROW& row,
+                                      const size_t startColumn,
+                                      const size_t endColumn,
                                       const COORD target);
 
+        // Reused for every line we paint, so painting doesn't allocate once it has grown.
+        std::vector<Cluster> _clusterBuffer;
+
+        // The frame being painted, and the ones we've painted recently.
+        FrameStatistics _frameStatistics;
+        RenderStatistics _statistics;
+
+        // The brushes last handed to the engine in the frame being painted, so
+        // that a run in the same colors as the one before isn't counted as a change.
+        std::optional<std::tuple<COLORREF, COLORREF, WORD, ExtendedAttributes>> _lastBrushes;
+
         static IRenderEngine::GridLines s_GetGridlines(const TextAttribute& textAttribute) noexcept;
 
         void _PaintBufferOutputGridLineHelper(_In_ IRenderEngine* const pEngine,
@@ -15,7 +15,8 @@ RenderThread::RenderThread() :
     _hEvent(nullptr),
     _hPaintCompletedEvent(nullptr),
     _fKeepRunning(true),
-    _hPaintEnabledEvent(nullptr)
+    _hPaintEnabledEvent(nullptr),
+    _scheduler()
 {
 }
 
@@ -160,17 +161,27 @@ DWORD WINAPI RenderThread::_ThreadProc()
         WaitForSingleObject(_hPaintEnabledEvent, INFINITE);
         WaitForSingleObject(_hEvent, INFINITE);
 
+        // If we painted recently, wait out the rest of that frame's budget so a
+        //      burst of requests turns into a single frame. If we've been idle,
+        //      paint right away. Don't bother when we're shutting down.
+        if (_fKeepRunning)
+        {
+            const auto delay = std::chrono::ceil<std::chrono::milliseconds>(_scheduler.TimeUntilNextFrame());
+            if (delay.count() > 0)
+            {
+                Sleep(gsl::narrow_cast<DWORD>(delay.count()));
+            }
+        }
+
+        // Everything requested up to this point is painted by this frame.
+        ResetEvent(_hEvent);
+
         ResetEvent(_hPaintCompletedEvent);
 
         LOG_IF_FAILED(_pRenderer->PaintFrame());
+        _scheduler.FramePainted();
 
         SetEvent(_hPaintCompletedEvent);
-
-        // extra check before we sleep since it's a "long" activity, relatively speaking.
-        if (_fKeepRunning)
-        {
-            Sleep(s_FrameLimitMilliseconds);
-        }
     }
 
     return S_OK;
@@ -186,6 +197,30 @@ void RenderThread::EnablePainting()
     SetEvent(_hPaintEnabledEvent);
 }
 
+// Method Description:
+// - Sets how many frames per second we paint at most.
+// Arguments:
+// - fps: the target frame rate. Must be greater than 0.
+// Return Value:
+// - <none>
+void RenderThread::SetTargetFps(const UINT fps)
+{
+    _scheduler.SetTargetFps(fps);
+}
+
+// Method Description:
+// - In low latency mode, every requested frame is painted as soon as the
+//      thread gets to it, instead of waiting out the frame budget. Useful when
+//      echoing keystrokes matters more than throughput.
+// Arguments:
+// - lowLatency: true to paint frames as soon as they're requested.
+// Return Value:
+// - <none>
+void RenderThread::SetLowLatency(const bool lowLatency) noexcept
+{
+    _scheduler.SetLowLatency(lowLatency);
+}
+
 void RenderThread::WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs)
 {
     // When rendering takes place via DirectX, and a console application
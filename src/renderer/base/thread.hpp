@@ -16,6 +16,7 @@ Author(s):
 
 #include "..\inc\IRenderer.hpp"
 #include "..\inc\IRenderThread.hpp"
+#include "frameScheduler.hpp"
 
 namespace Microsoft::Console::Render
 {
@@ -32,12 +33,13 @@ namespace Microsoft::Console::Render
         void EnablePainting() override;
         void WaitForPaintCompletionAndDisable(const DWORD dwTimeoutMs) override;
 
+        void SetTargetFps(const UINT fps);
+        void SetLowLatency(const bool lowLatency) noexcept;
+
     private:
         static DWORD WINAPI s_ThreadProc(_In_ LPVOID lpParameter);
         DWORD WINAPI _ThreadProc();
 
-        static DWORD const s_FrameLimitMilliseconds = 8;
-
         HANDLE _hThread;
         HANDLE _hEvent;
 
@@ -46,6 +48,8 @@ namespace Microsoft::Console::Render
 
         IRenderer* _pRenderer; // Non-ownership pointer
 
+        FrameScheduler _scheduler;
+
         bool _fKeepRunning;
     };
 }
@@ -17,6 +17,7 @@ Author(s):
 #include "FontInfoDesired.hpp"
 #include "IRenderEngine.hpp"
 #include "IRenderTarget.hpp"
+#include "RenderStatistics.hpp"
 #include "../types/inc/viewport.hpp"
 
 namespace Microsoft::Console::Render
@@ -61,6 +62,9 @@ namespace Microsoft::Console::Render
 
         virtual void AddRenderEngine(_In_ IRenderEngine* const pEngine) = 0;
 
+        virtual std::vector<FrameStatistics> GetRecentFrameStatistics() const = 0;
+        virtual FrameStatisticsSummary GetFrameStatisticsSummary() const = 0;
+
     protected:
         IRenderer() = default;
     };
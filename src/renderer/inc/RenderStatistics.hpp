@@ -0,0 +1,72 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- RenderStatistics.hpp
+
+Abstract:
+- Per-frame measurements of the render pipeline, so we can tell where the time
+  of a frame goes without attaching a profiler.
+- The render thread records one entry for each frame it paints, for each
+  engine, into a fixed size ring. Any thread can read the ring back without
+  taking a lock or holding up the render thread.
+--*/
+
+#pragma once
+
+namespace Microsoft::Console::Render
+{
+    // The work done and the time spent to paint one frame for one engine.
+    struct FrameStatistics
+    {
+        std::chrono::microseconds lockTime{}; // how long the console lock was held
+        std::chrono::microseconds paintTime{}; // from StartPaint to the end of EndPaint
+        std::chrono::microseconds presentTime{};
+        size_t invalidatedCells{};
+        size_t rowsPainted{};
+        size_t clustersEmitted{};
+        size_t brushChanges{};
+        size_t bytesWritten{}; // only counted by engines that write to a stream, like VT
+    };
+
+    struct FrameTimePercentiles
+    {
+        std::chrono::microseconds p50{};
+        std::chrono::microseconds p99{};
+    };
+
+    struct FrameStatisticsSummary
+    {
+        size_t frameCount{}; // how many of the recent frames were summarized
+        FrameTimePercentiles lockTime{};
+        FrameTimePercentiles paintTime{};
+        FrameTimePercentiles presentTime{};
+    };
+
+    class RenderStatistics final
+    {
+    public:
+        static constexpr size_t s_Capacity = 256;
+
+        RenderStatistics() noexcept;
+
+        void Record(const FrameStatistics& frame) noexcept;
+
+        size_t GetTotalFrames() const noexcept;
+        std::vector<FrameStatistics> GetRecentFrames() const;
+        FrameStatisticsSummary Summarize() const;
+
+    private:
+        // A slot is being written while its sequence is odd. Readers copy the
+        // frame out and retry if the sequence moved while they were reading.
+        struct Slot
+        {
+            std::atomic<size_t> sequence;
+            FrameStatistics frame;
+        };
+
+        std::array<Slot, s_Capacity> _slots;
+        std::atomic<size_t> _total;
+    };
+}
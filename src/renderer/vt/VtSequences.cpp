@@ -99,6 +99,45 @@ using namespace Microsoft::Console::Render;
     return _WriteFormattedString(&format, chars);
 }
 
+// Method Description:
+// - Moves the cursor backward (left) a number of characters.
+// Arguments:
+// - chars: a number of characters to move cursor left by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorBackward(const short chars) noexcept
+{
+    static const std::string format = "\x1b[%dD";
+
+    return _WriteFormattedString(&format, chars);
+}
+
+// Method Description:
+// - Moves the cursor up a number of lines, without scrolling.
+// Arguments:
+// - lines: a number of lines to move cursor up by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorUp(const short lines) noexcept
+{
+    static const std::string format = "\x1b[%dA";
+
+    return _WriteFormattedString(&format, lines);
+}
+
+// Method Description:
+// - Moves the cursor down a number of lines, without scrolling.
+// Arguments:
+// - lines: a number of lines to move cursor down by.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CursorDown(const short lines) noexcept
+{
+    static const std::string format = "\x1b[%dB";
+
+    return _WriteFormattedString(&format, lines);
+}
+
 // Method Description:
 // - Formats and writes a sequence to erase the remainer of the line starting
 //      from the cursor position.
@@ -108,6 +147,7 @@ using namespace Microsoft::Console::Render;
 // - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
 [[nodiscard]] HRESULT VtEngine::_ClearScreen() noexcept
 {
+    _ClearShadow();
     return _Write("\x1b[2J");
 }
 
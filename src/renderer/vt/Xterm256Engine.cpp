@@ -49,6 +49,8 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
     // Only do extended attributes in xterm-256color, as to not break telnet.exe.
     RETURN_IF_FAILED(_UpdateExtendedAttrs(extendedAttrs));
 
+    _SetShadowBrush(colorForeground, colorBackground, legacyColorAttribute, extendedAttrs);
+
     return VtEngine::_RgbUpdateDrawingBrushes(colorForeground,
                                               colorBackground,
                                               WI_IsFlagSet(extendedAttrs, ExtendedAttributes::Bold),
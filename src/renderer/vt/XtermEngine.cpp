@@ -190,6 +190,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     //      is called.
     // TODO:GH#2915 Treat underline separately from LVB_UNDERSCORE
     RETURN_IF_FAILED(_UpdateUnderline(legacyColorAttribute));
+    _SetShadowBrush(colorForeground, colorBackground, legacyColorAttribute, extendedAttrs);
     // The base xterm mode only knows about 16 colors
     return VtEngine::_16ColorUpdateDrawingBrushes(colorForeground,
                                                   colorBackground,
@@ -237,6 +238,16 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 
     if (coord.X != _lastText.X || coord.Y != _lastText.Y)
     {
+        // Moving down a line from the bottom row (by newline, or because the
+        //      last line wrapped there) scrolls the terminal, so the last frame
+        //      we sent no longer lines up with the screen.
+        const bool downOneLine = coord.Y == (_lastText.Y + 1) &&
+                                 (coord.X == 0 || coord.X == _lastText.X);
+        if (downOneLine && _lastText.Y >= _lastViewport.ToOrigin().BottomInclusive())
+        {
+            _ClearShadow();
+        }
+
         if (coord.X == 0 && coord.Y == 0)
         {
             _needToDisableCursor = true;
@@ -285,7 +296,7 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
         else
         {
             _needToDisableCursor = true;
-            hr = _CursorPosition(coord);
+            hr = _frameDiffing ? _CursorPositionShortest(coord) : _CursorPosition(coord);
         }
 
         if (SUCCEEDED(hr))
@@ -301,6 +312,78 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     return hr;
 }
 
+// Routine Description:
+// - Moves the cursor with whichever is shorter: an absolute CUP, or relative
+//      moves from where we last left the cursor. Used when frame diffing, where
+//      the point is to send as few bytes as we can.
+// Arguments:
+// - coord: location to move the cursor to.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT XtermEngine::_CursorPositionShortest(const COORD coord) noexcept
+{
+    // A relative move only works from where the terminal really has the
+    //      cursor. In the last column the terminal may be about to wrap, and
+    //      after a wrapped line we're not tracking the cursor that closely.
+    const auto view = _lastViewport.ToOrigin();
+    if (_previousLineWrapped ||
+        !view.IsInBounds(coord) ||
+        _lastText.X < 0 ||
+        _lastText.X >= view.RightInclusive() ||
+        _lastText.Y < 0 ||
+        _lastText.Y > view.BottomInclusive())
+    {
+        return _CursorPosition(coord);
+    }
+
+    const int dx = coord.X - _lastText.X;
+    const int dy = coord.Y - _lastText.Y;
+
+    // CUP is ESC [ row ; col H. A relative move is CUU/CUD (ESC [ n A/B)
+    //      followed by CR, BS or CUF/CUB (ESC [ n C/D).
+    const size_t absoluteLength = 4 +
+                                  _DecimalDigits(gsl::narrow_cast<size_t>(coord.Y) + 1) +
+                                  _DecimalDigits(gsl::narrow_cast<size_t>(coord.X) + 1);
+    const size_t verticalLength = dy == 0 ? 0 : 3 + _DecimalDigits(gsl::narrow_cast<size_t>(std::abs(dy)));
+    size_t horizontalLength = 0;
+    if (dx != 0)
+    {
+        horizontalLength = (coord.X == 0 || dx == -1) ? 1 : 3 + _DecimalDigits(gsl::narrow_cast<size_t>(std::abs(dx)));
+    }
+
+    if (verticalLength + horizontalLength >= absoluteLength)
+    {
+        return _CursorPosition(coord);
+    }
+
+    // CUU and CUD stop at the margins rather than scrolling, and we're
+    //      staying inside the viewport, so neither moves any text.
+    if (dy < 0)
+    {
+        RETURN_IF_FAILED(_CursorUp(gsl::narrow_cast<short>(-dy)));
+    }
+    else if (dy > 0)
+    {
+        RETURN_IF_FAILED(_CursorDown(gsl::narrow_cast<short>(dy)));
+    }
+
+    if (dx == 0)
+    {
+        return S_OK;
+    }
+    else if (coord.X == 0)
+    {
+        return _Write("\r");
+    }
+    else if (dx == -1)
+    {
+        return _Write("\b");
+    }
+    return dx > 0 ?
+               _CursorForward(gsl::narrow_cast<short>(dx)) :
+               _CursorBackward(gsl::narrow_cast<short>(-dx));
+}
+
 // Routine Description:
 // - Scrolls the existing data on the in-memory frame by the scroll region
 //      deltas we have collectively received through the Invalidate methods
@@ -328,6 +411,10 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
     const short dy = _scrollDelta.Y;
     const short absDy = static_cast<short>(abs(dy));
 
+    // The terminal is about to move every row, so the last frame we sent no
+    //      longer lines up with the screen.
+    _ClearShadow();
+
     HRESULT hr = S_OK;
     if (dy < 0)
     {
@@ -435,6 +522,8 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // We have no idea where this text lands on the screen.
+    _ClearShadow();
     return _fUseAsciiOnly ?
                VtEngine::_WriteTerminalAscii(wstr) :
                VtEngine::_WriteTerminalUtf8(wstr);
@@ -66,6 +66,7 @@ namespace Microsoft::Console::Render
         bool _nextCursorIsVisible;
 
         [[nodiscard]] HRESULT _MoveCursor(const COORD coord) noexcept override;
+        [[nodiscard]] HRESULT _CursorPositionShortest(const COORD coord) noexcept;
 
         [[nodiscard]] HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
 
@@ -154,6 +154,12 @@ using namespace Microsoft::Console::Render;
         _invalidRect = Viewport::Union(_invalidRect, invalid);
     }
 
+    try
+    {
+        _InvalidRowsCombine(invalid);
+    }
+    CATCH_RETURN();
+
     // Ensure invalid areas remain within bounds of window.
     RETURN_IF_FAILED(_InvalidRestrict());
 
@@ -178,6 +184,7 @@ using namespace Microsoft::Console::Render;
             // Add the scrolled invalid rectangle to what was left behind to get the new invalid area.
             // This is the equivalent of adding in the "update rectangle" that we would get out of ScrollWindowEx/ScrollDC.
             _invalidRect = Viewport::Union(_invalidRect, newInvalid);
+            _InvalidRowsOffset(*pCoord);
 
             // Ensure invalid areas remain within bounds of window.
             RETURN_IF_FAILED(_InvalidRestrict());
@@ -204,3 +211,63 @@ using namespace Microsoft::Console::Render;
 
     return S_OK;
 }
+
+// Routine Description:
+// - Helper to add the given rectangle to the dirty span of each row it covers.
+// Expects EXCLUSIVE rectangles.
+// Arguments:
+// - invalid - A viewport containing the character region that should be
+//      repainted on the next frame
+// Return Value:
+// - <none>
+void VtEngine::_InvalidRowsCombine(const Viewport invalid)
+{
+    // Only the part within the window matters, see _InvalidRestrict.
+    const auto bounded = Viewport::Intersect(invalid, _lastViewport.ToOrigin());
+    if (bounded.Width() <= 0 || bounded.Height() <= 0)
+    {
+        return;
+    }
+
+    if (_invalidRows.size() < static_cast<size_t>(bounded.BottomExclusive()))
+    {
+        _invalidRows.resize(bounded.BottomExclusive(), { SHORT{ 0 }, SHORT{ 0 } });
+    }
+
+    for (auto row = bounded.Top(); row < bounded.BottomExclusive(); ++row)
+    {
+        auto& span = _invalidRows.at(row);
+        if (span.first >= span.second)
+        {
+            span = { bounded.Left(), bounded.RightExclusive() };
+        }
+        else
+        {
+            span.first = std::min(span.first, bounded.Left());
+            span.second = std::max(span.second, bounded.RightExclusive());
+        }
+    }
+}
+
+// Routine Description:
+// - Helper to move the dirty spans of each row by the given offset such as when a
+//      scroll operation occurs. Like _InvalidOffset, the rows that are scrolled
+//      away from stay dirty as well.
+// Arguments:
+// - delta - Distances by which we should move the invalid region in response to a scroll
+// Return Value:
+// - <none>
+void VtEngine::_InvalidRowsOffset(const COORD delta)
+{
+    const auto previous = _invalidRows;
+    for (size_t row = 0; row < previous.size(); ++row)
+    {
+        const auto& span = previous.at(row);
+        if (span.first < span.second)
+        {
+            const COORD origin{ gsl::narrow<SHORT>(span.first + delta.X), gsl::narrow<SHORT>(row + delta.Y) };
+            const auto moved = Viewport::FromDimensions(origin, { gsl::narrow<SHORT>(span.second - span.first), 1 });
+            _InvalidRowsCombine(moved);
+        }
+    }
+}
@@ -41,6 +41,18 @@ SMALL_RECT VtEngine::GetDirtyRectInChars()
     return S_FALSE;
 }
 
+// Routine Description:
+// - Gets how many bytes of VT we've produced since we were created, including
+//      the ones still waiting in our buffer to be flushed.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of bytes written.
+size_t VtEngine::GetBytesWritten() const noexcept
+{
+    return _bytesWritten;
+}
+
 // Routine Description:
 // - Performs a "CombineRect" with the "OR" operation.
 // - Basically extends the existing rect outward to also encompass the passed-in region.
@@ -82,3 +94,21 @@ bool VtEngine::_WillWriteSingleChar() const
 
     return noScrollDelta && invalidIsOneChar && (invalidIsNext || invalidIsLast);
 }
+
+// Method Description:
+// - Counts the decimal digits needed to print a number, to work out how long
+//      a sequence with that number as a parameter will be.
+// Arguments:
+// - value - the number to print
+// Return Value:
+// - The number of digits in value.
+size_t VtEngine::_DecimalDigits(size_t value) noexcept
+{
+    size_t digits = 1;
+    while (value >= 10)
+    {
+        value /= 10;
+        ++digits;
+    }
+    return digits;
+}
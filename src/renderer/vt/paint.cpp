@@ -51,6 +51,7 @@ using namespace Microsoft::Console::Types;
     _trace.TraceEndPaint();
 
     _invalidRect = Viewport::Empty();
+    _invalidRows.clear();
     _fInvalidRectUsed = false;
     _scrollDelta = { 0 };
     _clearedAllThisFrame = false;
@@ -61,12 +62,15 @@ using namespace Microsoft::Console::Types;
     // If we've circled the buffer this frame, move our virtual top upwards.
     // We do this at the END of the frame, so that during the paint, we still
     //      use the original virtual top.
+    // The terminal scrolled its contents up a row when the buffer circled, so
+    //      the last frame we sent no longer lines up with the screen.
     if (_circled)
     {
         if (_virtualTop > 0)
         {
             _virtualTop--;
         }
+        _ClearShadow();
     }
     _circled = false;
 
@@ -333,9 +337,15 @@ using namespace Microsoft::Console::Types;
 // - coord - character coordinate target to render within viewport
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_PaintAsciiBufferLine(std::basic_string_view<Cluster> const clusters,
-                                                      const COORD coord) noexcept
+[[nodiscard]] HRESULT VtEngine::_PaintAsciiBufferLine(std::basic_string_view<Cluster> clusters,
+                                                      COORD coord) noexcept
 {
+    // Only send the part of the line that actually changed.
+    if (!_TrimToInvalidRow(clusters, coord))
+    {
+        return S_OK;
+    }
+
     try
     {
         RETURN_IF_FAILED(_MoveCursor(coord));
@@ -360,6 +370,281 @@ using namespace Microsoft::Console::Types;
     CATCH_RETURN();
 }
 
+// Routine Description:
+// - Narrows a line of clusters about to be painted down to the part that lies
+//      within the dirty span of its row. A cluster that straddles the edge of
+//      the span is kept whole.
+// - If nothing was recorded for this frame (for example when we're painting
+//      because we cleared the whole screen), the line is left as it is.
+// Arguments:
+// - clusters - On input, the clusters of the line. On output, the dirty ones.
+// - coord - On input, where the line starts. On output, where the dirty clusters start.
+// Return Value:
+// - false if no part of the line needs to be painted.
+bool VtEngine::_TrimToInvalidRow(std::basic_string_view<Cluster>& clusters, COORD& coord) const noexcept
+{
+    if (_invalidRows.empty() || _clearedAllThisFrame)
+    {
+        return true;
+    }
+
+    if (coord.Y < 0 || static_cast<size_t>(coord.Y) >= _invalidRows.size())
+    {
+        return false;
+    }
+
+    const auto& span = _invalidRows[coord.Y];
+
+    // Skip the clusters that end before the span starts...
+    size_t first = 0;
+    auto column = coord.X;
+    while (first < clusters.size() && column + static_cast<SHORT>(clusters[first].GetColumns()) <= span.first)
+    {
+        column += static_cast<SHORT>(clusters[first].GetColumns());
+        ++first;
+    }
+    const auto start = column;
+
+    // ...and those that start after it ends.
+    auto last = first;
+    while (last < clusters.size() && column < span.second)
+    {
+        column += static_cast<SHORT>(clusters[last].GetColumns());
+        ++last;
+    }
+
+    if (first == last)
+    {
+        return false;
+    }
+
+    clusters = clusters.substr(first, last - first);
+    coord.X = start;
+    return true;
+}
+
+// Routine Description:
+// - When frame diffing, narrows a line of clusters about to be painted down to
+//      the part that differs from what we last sent to the terminal. Cells
+//      that match at the start and the end of the line are dropped.
+// Arguments:
+// - clusters - On input, the clusters of the line. On output, the changed ones.
+// - coord - On input, where the line starts. On output, where the changed clusters start.
+// Return Value:
+// - false if the terminal is already showing the whole line.
+bool VtEngine::_TrimToShadow(std::basic_string_view<Cluster>& clusters, COORD& coord) const noexcept
+{
+    if (!_frameDiffing || _shadow.empty())
+    {
+        return true;
+    }
+
+    size_t first = 0;
+    COORD start = coord;
+    while (first < clusters.size() && _IsInShadow(til::at(clusters, first), start))
+    {
+        ++first;
+        ++start.X;
+    }
+
+    if (first == clusters.size())
+    {
+        return false;
+    }
+
+    int end = coord.X;
+    for (const auto& cluster : clusters)
+    {
+        end += static_cast<int>(cluster.GetColumns());
+    }
+
+    auto last = clusters.size();
+    while (last > first && _IsInShadow(til::at(clusters, last - 1), { gsl::narrow_cast<SHORT>(end - 1), coord.Y }))
+    {
+        --last;
+        --end;
+    }
+
+    clusters = clusters.substr(first, last - first);
+    coord = start;
+    return true;
+}
+
+// Routine Description:
+// - When frame diffing, looks for a run of cells in the middle of the line
+//      that the terminal is already showing, and that's cheaper to jump over
+//      with CUF than to send again. If there is one, the line is split in
+//      front of it, so the two sides can be painted separately.
+// Arguments:
+// - clusters - On input, the clusters of the line. On output, the clusters in
+//      front of the run.
+// - coord - where the line starts
+// - rest - On output, the clusters from the start of the run to the end of the line.
+// - restCoord - On output, where rest starts.
+// Return Value:
+// - true if the line was split.
+bool VtEngine::_SplitAtShadow(std::basic_string_view<Cluster>& clusters,
+                              const COORD coord,
+                              std::basic_string_view<Cluster>& rest,
+                              COORD& restCoord) const noexcept
+{
+    // A line that's new at the bottom of the screen is blank, whatever the
+    //      shadow says.
+    if (!_frameDiffing || _shadow.empty() || _newBottomLine)
+    {
+        return false;
+    }
+
+    COORD position = coord;
+    size_t runStart = 0;
+    SHORT runColumn = 0;
+    size_t runCells = 0;
+    size_t runBytes = 0;
+    for (size_t i = 0; i < clusters.size(); ++i)
+    {
+        const auto& cluster = til::at(clusters, i);
+        if (_IsInShadow(cluster, position))
+        {
+            if (runCells == 0)
+            {
+                runStart = i;
+                runColumn = position.X;
+                runBytes = 0;
+            }
+            ++runCells;
+
+            // Cells in the shadow hold a single UTF-16 code unit.
+            const auto wch = cluster.GetText().front();
+            runBytes += wch < 0x80 ? 1 : (wch < 0x800 ? 2 : 3);
+        }
+        else
+        {
+            if (runCells != 0 && runStart != 0 && runBytes > 3 + _DecimalDigits(runCells))
+            {
+                rest = clusters.substr(runStart);
+                restCoord = { runColumn, coord.Y };
+                clusters = clusters.substr(0, runStart);
+                return true;
+            }
+            runCells = 0;
+        }
+        position.X += gsl::narrow_cast<SHORT>(cluster.GetColumns());
+    }
+    return false;
+}
+
+// Routine Description:
+// - Returns true if the terminal already shows the given cluster at the given
+//      position, painted with the current brush.
+// - All of the clusters of a line are painted with the current brush, so a
+//      cell only matches if it was also painted with that brush.
+// Arguments:
+// - cluster - the cluster about to be painted
+// - position - the cell it's about to be painted in
+// Return Value:
+// - true if painting the cluster there would change nothing.
+bool VtEngine::_IsInShadow(const Cluster& cluster, const COORD position) const noexcept
+{
+    const auto width = _lastViewport.Width();
+    const auto text = cluster.GetText();
+    if (position.X < 0 ||
+        position.X >= width ||
+        position.Y < 0 ||
+        position.Y >= _lastViewport.Height() ||
+        text.size() != 1 ||
+        cluster.GetColumns() != 1)
+    {
+        return false;
+    }
+
+    const auto index = static_cast<size_t>(position.Y) * width + position.X;
+    if (index >= _shadow.size())
+    {
+        return false;
+    }
+
+    const auto& cell = til::at(_shadow, index);
+    return cell.known && cell.wch == text.front() && cell.brush == _shadowBrush;
+}
+
+// Routine Description:
+// - Records the line we just painted into the shadow of the last frame, so
+//      the next frame can skip the cells that haven't changed.
+// Arguments:
+// - clusters - the clusters of the line we painted
+// - coord - where the line starts
+// - columnsWritten - how many columns of the line we actually wrote as text
+// - trailingKnown - true if we're sure of what's displayed in the columns
+//      after those, either because we wrote spaces, or erased them.
+// Return Value:
+// - <none>
+void VtEngine::_UpdateShadow(std::basic_string_view<Cluster> const clusters,
+                             const COORD coord,
+                             const size_t columnsWritten,
+                             const bool trailingKnown)
+{
+    const auto width = _lastViewport.Width();
+    const auto height = _lastViewport.Height();
+    if (coord.Y < 0 || coord.Y >= height)
+    {
+        return;
+    }
+
+    const auto cells = static_cast<size_t>(width) * height;
+    if (_shadow.size() != cells)
+    {
+        _shadow.assign(cells, ShadowCell{});
+    }
+
+    const auto row = _shadow.data() + static_cast<size_t>(coord.Y) * width;
+    size_t offset = 0;
+    for (const auto& cluster : clusters)
+    {
+        const auto text = cluster.GetText();
+        const auto columns = cluster.GetColumns();
+        const bool written = offset + columns <= columnsWritten;
+        const bool known = (written || trailingKnown) && text.size() == 1 && columns == 1;
+        for (size_t i = 0; i < columns; ++i, ++offset)
+        {
+            const auto column = coord.X + static_cast<int>(offset);
+            if (column >= 0 && column < width)
+            {
+                row[column] = { known ? text.front() : UNICODE_NULL, _shadowBrush, known };
+            }
+        }
+    }
+}
+
+// Routine Description:
+// - Remembers the brush the next text will be painted with, for the shadow of
+//      the last frame.
+// Arguments:
+// - colorForeground - The RGB Color to use to paint the foreground text.
+// - colorBackground - The RGB Color to use to paint the background of the text.
+// - legacyColorAttribute - A console attributes bit field specifying the brush colors.
+// - extendedAttrs - extended text attributes (italic, underline, etc.) to use.
+// Return Value:
+// - <none>
+void VtEngine::_SetShadowBrush(const COLORREF colorForeground,
+                               const COLORREF colorBackground,
+                               const WORD legacyColorAttribute,
+                               const ExtendedAttributes extendedAttrs) noexcept
+{
+    _shadowBrush = { colorForeground, colorBackground, legacyColorAttribute, extendedAttrs };
+}
+
+// Routine Description:
+// - Forgets everything we know about what the terminal is displaying. Called
+//      whenever we emit something that moves or erases cells wholesale.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::_ClearShadow() noexcept
+{
+    _shadow.clear();
+}
+
 // Routine Description:
 // - Draws one line of the buffer to the screen. Writes the characters to the
 //      pipe, encoded in UTF-8.
@@ -368,14 +653,32 @@ using namespace Microsoft::Console::Types;
 // - coord - character coordinate target to render within viewport
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
-[[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(std::basic_string_view<Cluster> const clusters,
-                                                     const COORD coord) noexcept
+[[nodiscard]] HRESULT VtEngine::_PaintUtf8BufferLine(std::basic_string_view<Cluster> clusters,
+                                                     COORD coord) noexcept
 {
     if (coord.Y < _virtualTop)
     {
         return S_OK;
     }
 
+    // Only send the part of the line that actually changed.
+    if (!_TrimToInvalidRow(clusters, coord))
+    {
+        return S_OK;
+    }
+
+    // Don't resend cells the terminal is already displaying.
+    if (!_TrimToShadow(clusters, coord))
+    {
+        return S_OK;
+    }
+
+    // If there are unchanged cells in the middle of the line too, paint the
+    //      cells in front of them now, and the rest after jumping over them.
+    std::basic_string_view<Cluster> rest;
+    COORD restCoord{};
+    const bool split = _SplitAtShadow(clusters, coord, rest, restCoord);
+
     RETURN_IF_FAILED(_MoveCursor(coord));
 
     std::wstring unclusteredString;
@@ -509,10 +812,36 @@ using namespace Microsoft::Console::Types;
         }
     }
 
+    if (_frameDiffing)
+    {
+        // ECH blanks cells with the current background and no other
+        //      attributes, so we only know what they look like when the brush
+        //      has none to begin with.
+        const bool plainBrush = _shadowBrush.extendedAttrs == ExtendedAttributes::Normal &&
+                                WI_IsFlagClear(_shadowBrush.legacyAttr, COMMON_LVB_UNDERSCORE);
+        const bool trailingKnown = !removeSpaces ||
+                                   (useEraseChar && plainBrush) ||
+                                   (_newBottomLine && !optimalToUseECH);
+        try
+        {
+            _UpdateShadow(clusters, coord, columnsActual, trailingKnown);
+        }
+        catch (...)
+        {
+            LOG_CAUGHT_EXCEPTION();
+            _ClearShadow();
+        }
+    }
+
     // If we previously though that this was a new bottom line, it certainly
     //      isn't new any longer.
     _newBottomLine = false;
 
+    if (split)
+    {
+        return _PaintUtf8BufferLine(rest, restCoord);
+    }
+
     return S_OK;
 }
 
@@ -36,6 +36,7 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     _lastWasBold(false),
     _lastViewport(initialViewport),
     _invalidRect(Viewport::Empty()),
+    _invalidRows(),
     _fInvalidRectUsed(false),
     _lastRealCursor({ 0 }),
     _lastText({ 0 }),
@@ -70,13 +71,49 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 // - Writes the characters to our file handle. If we're building the unit tests,
 //      we can instead write to the test callback, in order to avoid needing to
 //      set up pipes and threads for unit tests.
+// - When frame diffing, back-to-back SGR sequences are held back and sent
+//      together as a single sequence once something else is written.
 // Arguments:
 // - str: The buffer to write to the pipe. Might have nulls in it.
 // Return Value:
 // - S_OK or suitable HRESULT error from writing pipe.
 [[nodiscard]] HRESULT VtEngine::_Write(std::string_view const str) noexcept
+{
+    if (_frameDiffing)
+    {
+        if (_IsGraphicsRendition(str))
+        {
+            try
+            {
+                // Each SGR parameter applies in turn, so "\x1b[1m\x1b[31m" and
+                //      "\x1b[1;31m" do the same. An empty list means 0, and
+                //      still does when it's joined with others.
+                if (_graphicsRenditionPending)
+                {
+                    _pendingGraphicsRendition.push_back(';');
+                }
+                _pendingGraphicsRendition.append(str.substr(2, str.size() - 3));
+                _graphicsRenditionPending = true;
+                return S_OK;
+            }
+            CATCH_RETURN();
+        }
+        RETURN_IF_FAILED(_FlushGraphicsRendition());
+    }
+    return _WriteImmediately(str);
+}
+
+// Method Description:
+// - Writes the characters to our file handle, or the test callback, without
+//      holding anything back. See _Write.
+// Arguments:
+// - str: The buffer to write to the pipe. Might have nulls in it.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_WriteImmediately(std::string_view const str) noexcept
 {
     _trace.TraceString(str);
+    _bytesWritten += str.size();
 #ifdef UNIT_TESTING
     if (_usingTestCallback)
     {
@@ -106,6 +143,8 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
 [[nodiscard]] HRESULT VtEngine::_Flush() noexcept
 {
+    RETURN_IF_FAILED(_FlushGraphicsRendition());
+
 #ifdef UNIT_TESTING
     if (_hFile.get() == INVALID_HANDLE_VALUE)
     {
@@ -133,10 +172,51 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
     return S_OK;
 }
 
+// Method Description:
+// - Returns true if the given string is exactly one SGR sequence, with only
+//      numeric parameters.
+// Arguments:
+// - str: The string about to be written.
+// Return Value:
+// - true if str can be merged with the SGR sequences around it.
+bool VtEngine::_IsGraphicsRendition(std::string_view const str) noexcept
+{
+    if (str.size() < 3 || str.front() != '\x1b' || str[1] != '[' || str.back() != 'm')
+    {
+        return false;
+    }
+    return str.substr(2, str.size() - 3).find_first_not_of("0123456789;") == std::string_view::npos;
+}
+
+// Method Description:
+// - Writes the SGR sequences held back by _Write, as a single sequence.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_FlushGraphicsRendition() noexcept
+{
+    if (!_graphicsRenditionPending)
+    {
+        return S_OK;
+    }
+
+    _graphicsRenditionPending = false;
+    try
+    {
+        const auto seq = "\x1b[" + _pendingGraphicsRendition + "m";
+        _pendingGraphicsRendition.clear();
+        return _WriteImmediately(seq);
+    }
+    CATCH_RETURN();
+}
+
 // Method Description:
 // - Wrapper for ITerminalOutputConnection. See _Write.
 [[nodiscard]] HRESULT VtEngine::WriteTerminalUtf8(const std::string_view str) noexcept
 {
+    // We have no idea where this text lands on the screen.
+    _ClearShadow();
     return _Write(str);
 }
 
@@ -262,6 +342,9 @@ VtEngine::VtEngine(_In_ wil::unique_hfile pipe,
 
     if ((oldView.Height() != newView.Height()) || (oldView.Width() != newView.Width()))
     {
+        // The terminal reflows or crops its screen as it sees fit.
+        _ClearShadow();
+
         // Don't emit a resize event if we've requested it be suppressed
         if (!_suppressResizeRepaint)
         {
@@ -456,3 +539,18 @@ void VtEngine::EndResizeRequest()
 {
     _inResizeRequest = false;
 }
+
+// Method Description:
+// - Turns frame diffing on or off. When it's on, we keep a shadow of the last
+//      frame we sent, and only send the cells of each line that differ from
+//      it. We also pick the shortest cursor moves, and merge SGR sequences.
+// Arguments:
+// - enabled - true to diff frames against the last frame sent.
+// Return Value:
+// - <none>
+void VtEngine::SetFrameDiffing(const bool enabled) noexcept
+{
+    LOG_IF_FAILED(_FlushGraphicsRendition());
+    _frameDiffing = enabled;
+    _ClearShadow();
+}
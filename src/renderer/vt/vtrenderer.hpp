@@ -91,6 +91,7 @@ namespace Microsoft::Console::Render
         SMALL_RECT GetDirtyRectInChars() override;
         [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
         [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+        size_t GetBytesWritten() const noexcept override;
 
         [[nodiscard]] HRESULT SuppressResizeRepaint() noexcept;
 
@@ -105,9 +106,39 @@ namespace Microsoft::Console::Render
         void BeginResizeRequest();
         void EndResizeRequest();
 
+        void SetFrameDiffing(const bool enabled) noexcept;
+
     protected:
+        // The attributes the terminal will apply to the next text we write.
+        struct ShadowBrush
+        {
+            COLORREF fg;
+            COLORREF bg;
+            WORD legacyAttr;
+            ExtendedAttributes extendedAttrs;
+
+            constexpr bool operator==(const ShadowBrush& other) const noexcept
+            {
+                return fg == other.fg &&
+                       bg == other.bg &&
+                       legacyAttr == other.legacyAttr &&
+                       extendedAttrs == other.extendedAttrs;
+            }
+        };
+
+        // What we believe the terminal is currently displaying in one cell.
+        // Cells we can't vouch for (wide glyphs, surrogate pairs, or cells we
+        // left to a clear) are not known, and never match.
+        struct ShadowCell
+        {
+            wchar_t wch;
+            ShadowBrush brush;
+            bool known;
+        };
+
         wil::unique_hfile _hFile;
         std::string _buffer;
+        size_t _bytesWritten{ 0 };
 
         const Microsoft::Console::IDefaultColorProvider& _colorProvider;
 
@@ -118,6 +149,10 @@ namespace Microsoft::Console::Render
         Microsoft::Console::Types::Viewport _lastViewport;
         Microsoft::Console::Types::Viewport _invalidRect;
 
+        // The columns [first, second) of each row of the viewport that need to be repainted.
+        // _invalidRect is the bounding box of all of these.
+        std::vector<std::pair<SHORT, SHORT>> _invalidRows;
+
         bool _fInvalidRectUsed;
         COORD _lastRealCursor;
         COORD _lastText;
@@ -144,7 +179,20 @@ namespace Microsoft::Console::Render
         Microsoft::Console::VirtualTerminal::RenderTracing _trace;
         bool _inResizeRequest{ false };
 
+        // When frame diffing, _shadow holds the last frame we sent, row-major
+        // over _lastViewport. It's empty when we know nothing about the screen.
+        // _pendingGraphicsRendition holds the parameters of the SGR sequences
+        // we haven't sent yet, so that they go out as one.
+        bool _frameDiffing{ false };
+        ShadowBrush _shadowBrush{};
+        std::vector<ShadowCell> _shadow;
+        std::string _pendingGraphicsRendition;
+        bool _graphicsRenditionPending{ false };
+
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
+        [[nodiscard]] HRESULT _WriteImmediately(std::string_view const str) noexcept;
+        static bool _IsGraphicsRendition(std::string_view const str) noexcept;
+        [[nodiscard]] HRESULT _FlushGraphicsRendition() noexcept;
         [[nodiscard]] HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
 
@@ -152,7 +200,26 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _InvalidCombine(const Microsoft::Console::Types::Viewport invalid) noexcept;
         [[nodiscard]] HRESULT _InvalidOffset(const COORD* const ppt) noexcept;
         [[nodiscard]] HRESULT _InvalidRestrict() noexcept;
+        void _InvalidRowsCombine(const Microsoft::Console::Types::Viewport invalid);
+        void _InvalidRowsOffset(const COORD delta);
+        bool _TrimToInvalidRow(std::basic_string_view<Cluster>& clusters, COORD& coord) const noexcept;
+        bool _TrimToShadow(std::basic_string_view<Cluster>& clusters, COORD& coord) const noexcept;
+        bool _SplitAtShadow(std::basic_string_view<Cluster>& clusters,
+                            const COORD coord,
+                            std::basic_string_view<Cluster>& rest,
+                            COORD& restCoord) const noexcept;
+        bool _IsInShadow(const Cluster& cluster, const COORD position) const noexcept;
+        void _UpdateShadow(std::basic_string_view<Cluster> const clusters,
+                           const COORD coord,
+                           const size_t columnsWritten,
+                           const bool trailingKnown);
+        void _SetShadowBrush(const COLORREF colorForeground,
+                             const COLORREF colorBackground,
+                             const WORD legacyColorAttribute,
+                             const ExtendedAttributes extendedAttrs) noexcept;
+        void _ClearShadow() noexcept;
         bool _AllIsInvalid() const;
+        static size_t _DecimalDigits(size_t value) noexcept;
 
         [[nodiscard]] HRESULT _StopCursorBlinking() noexcept;
         [[nodiscard]] HRESULT _StartCursorBlinking() noexcept;
@@ -163,6 +230,9 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _DeleteLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _InsertLine(const short sLines) noexcept;
         [[nodiscard]] HRESULT _CursorForward(const short chars) noexcept;
+        [[nodiscard]] HRESULT _CursorBackward(const short chars) noexcept;
+        [[nodiscard]] HRESULT _CursorUp(const short lines) noexcept;
+        [[nodiscard]] HRESULT _CursorDown(const short lines) noexcept;
         [[nodiscard]] HRESULT _EraseCharacter(const short chars) noexcept;
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
@@ -211,11 +281,11 @@ namespace Microsoft::Console::Render
 
         bool _WillWriteSingleChar() const;
 
-        [[nodiscard]] HRESULT _PaintUtf8BufferLine(std::basic_string_view<Cluster> const clusters,
-                                                   const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _PaintUtf8BufferLine(std::basic_string_view<Cluster> clusters,
+                                                   COORD coord) noexcept;
 
-        [[nodiscard]] HRESULT _PaintAsciiBufferLine(std::basic_string_view<Cluster> const clusters,
-                                                    const COORD coord) noexcept;
+        [[nodiscard]] HRESULT _PaintAsciiBufferLine(std::basic_string_view<Cluster> clusters,
+                                                    COORD coord) noexcept;
 
         [[nodiscard]] HRESULT _WriteTerminalUtf8(const std::wstring_view str) noexcept;
         [[nodiscard]] HRESULT _WriteTerminalAscii(const std::wstring_view str) noexcept;
@@ -150,14 +150,14 @@
 
     std::unique_ptr<IWaitRoutine> waiter;
     HRESULT hr;
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
+    std::vector<INPUT_RECORD> outRecords;
     size_t const eventsToRead = cRecords;
     if (a->Unicode)
     {
         if (fIsPeek)
         {
             hr = m->_pApiRoutines->PeekConsoleInputWImpl(*pInputBuffer,
-                                                         outEvents,
+                                                         outRecords,
                                                          eventsToRead,
                                                          *pInputReadHandleData,
                                                          waiter);
@@ -165,7 +165,7 @@
         else
         {
             hr = m->_pApiRoutines->ReadConsoleInputWImpl(*pInputBuffer,
-                                                         outEvents,
+                                                         outRecords,
                                                          eventsToRead,
                                                          *pInputReadHandleData,
                                                          waiter);
@@ -176,7 +176,7 @@
         if (fIsPeek)
         {
             hr = m->_pApiRoutines->PeekConsoleInputAImpl(*pInputBuffer,
-                                                         outEvents,
+                                                         outRecords,
                                                          eventsToRead,
                                                          *pInputReadHandleData,
                                                          waiter);
@@ -184,7 +184,7 @@
         else
         {
             hr = m->_pApiRoutines->ReadConsoleInputAImpl(*pInputBuffer,
-                                                         outEvents,
+                                                         outRecords,
                                                          eventsToRead,
                                                          *pInputReadHandleData,
                                                          waiter);
@@ -193,10 +193,10 @@
 
     // We must return the number of records in the message payload (to alert the client)
     // as well as in the message headers (below in SetReplyInfomration) to alert the driver.
-    LOG_IF_FAILED(SizeTToULong(outEvents.size(), &a->NumRecords));
+    LOG_IF_FAILED(SizeTToULong(outRecords.size(), &a->NumRecords));
 
     size_t cbWritten;
-    LOG_IF_FAILED(SizeTMult(outEvents.size(), sizeof(INPUT_RECORD), &cbWritten));
+    LOG_IF_FAILED(SizeTMult(outRecords.size(), sizeof(INPUT_RECORD), &cbWritten));
 
     if (nullptr != waiter.get())
     {
@@ -228,15 +228,7 @@
     {
         try
         {
-            for (size_t i = 0; i < cRecords; ++i)
-            {
-                if (outEvents.empty())
-                {
-                    break;
-                }
-                rgRecords[i] = outEvents.front()->ToInputRecord();
-                outEvents.pop_front();
-            }
+            std::copy_n(outRecords.cbegin(), std::min(cRecords, outRecords.size()), rgRecords);
         }
         CATCH_RETURN();
     }
@@ -30,6 +30,7 @@ class INPUT_READ_HANDLE_DATA;
 #include "IWaitRoutine.h"
 #include <deque>
 #include <memory>
+#include <vector>
 #include "../types/inc/IInputEvent.hpp"
 #include "../types/inc/viewport.hpp"
 
@@ -65,25 +66,25 @@ public:
                                                                     ULONG& events) noexcept = 0;
 
     [[nodiscard]] virtual HRESULT PeekConsoleInputAImpl(IConsoleInputObject& context,
-                                                        std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                        std::vector<INPUT_RECORD>& outRecords,
                                                         const size_t eventsToRead,
                                                         INPUT_READ_HANDLE_DATA& readHandleState,
                                                         std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]] virtual HRESULT PeekConsoleInputWImpl(IConsoleInputObject& context,
-                                                        std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                        std::vector<INPUT_RECORD>& outRecords,
                                                         const size_t eventsToRead,
                                                         INPUT_READ_HANDLE_DATA& readHandleState,
                                                         std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]] virtual HRESULT ReadConsoleInputAImpl(IConsoleInputObject& context,
-                                                        std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                        std::vector<INPUT_RECORD>& outRecords,
                                                         const size_t eventsToRead,
                                                         INPUT_READ_HANDLE_DATA& readHandleState,
                                                         std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
 
     [[nodiscard]] virtual HRESULT ReadConsoleInputWImpl(IConsoleInputObject& context,
-                                                        std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+                                                        std::vector<INPUT_RECORD>& outRecords,
                                                         const size_t eventsToRead,
                                                         INPUT_READ_HANDLE_DATA& readHandleState,
                                                         std::unique_ptr<IWaitRoutine>& waiter) noexcept = 0;
@@ -13,6 +13,14 @@
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::VirtualTerminal;
 
+// Enough key records for a full read of typed or pasted input to reuse them,
+// without keeping what the largest paste needed for the rest of the session.
+// Anything bigger is only given back once that many writes in a row got by
+// with s_MaxKeptKeyRecords, so a paste that arrives in several large pieces
+// doesn't reallocate the records for each one.
+static constexpr size_t s_MaxKeptKeyRecords = 16 * 1024;
+static constexpr size_t s_SmallWritesBeforeRelease = 8;
+
 // takes ownership of pConApi
 InteractDispatch::InteractDispatch(std::unique_ptr<ConGetSet> pConApi) :
     _pConApi(std::move(pConApi))
@@ -52,7 +60,12 @@ bool InteractDispatch::WriteCtrlC()
 
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
-//      that will faithfully represent the input by CharToKeyEvents.
+//      that will faithfully represent the input by CharToKeyRecords.
+//  All of the keystrokes are written with a single call, and the records are
+//      kept between calls, so pasting a lot of text doesn't allocate anything
+//      per character. More than s_MaxKeptKeyRecords records are only kept
+//      while large writes keep coming, so one large paste doesn't hold on to
+//      its memory afterwards.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
@@ -68,18 +81,29 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     bool success = _pConApi->GetConsoleOutputCP(codepage);
     if (success)
     {
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        // The records keep their capacity from the last write. They aren't
+        // reserved up front, since some characters take a modifier or a whole
+        // alt+numpad sequence and a guess would just be reallocated again.
+        _keyRecords.clear();
 
         for (const auto& wch : string)
         {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(wch, codepage);
-
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
+            CharToKeyRecords(wch, codepage, _keyRecords);
         }
 
-        success = WriteInput(keyEvents);
+        size_t written = 0;
+        success = _pConApi->PrivateWriteConsoleInputRecords(_keyRecords, written);
+
+        if (_keyRecords.size() > s_MaxKeptKeyRecords)
+        {
+            _smallWrites = 0;
+        }
+        else if (_keyRecords.capacity() > s_MaxKeptKeyRecords && ++_smallWrites >= s_SmallWritesBeforeRelease)
+        {
+            _keyRecords.clear();
+            _keyRecords.shrink_to_fit();
+            _smallWrites = 0;
+        }
     }
     return success;
 }
@@ -170,13 +194,14 @@ bool InteractDispatch::MoveCursor(const size_t row, const size_t col)
     if (success)
     {
         // First retrieve some information about the buffer
-        CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-        csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
-        success = _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+        COORD cursorPosition{ 0 };
+        SMALL_RECT viewport{ 0 };
+        COORD bufferSize{ 0 };
+        success = _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize);
 
         if (success)
         {
-            COORD coordCursor = csbiex.dwCursorPosition;
+            COORD coordCursor = cursorPosition;
 
             // Safely convert the size_t positions we were given into shorts (which is the size the console deals with)
             success = SUCCEEDED(SizeTToShort(rowFixed, &coordCursor.Y)) &&
@@ -185,14 +210,14 @@ bool InteractDispatch::MoveCursor(const size_t row, const size_t col)
             if (success)
             {
                 // Set the line and column values as offsets from the viewport edge. Use safe math to prevent overflow.
-                success = SUCCEEDED(ShortAdd(coordCursor.Y, csbiex.srWindow.Top, &coordCursor.Y)) &&
-                          SUCCEEDED(ShortAdd(coordCursor.X, csbiex.srWindow.Left, &coordCursor.X));
+                success = SUCCEEDED(ShortAdd(coordCursor.Y, viewport.Top, &coordCursor.Y)) &&
+                          SUCCEEDED(ShortAdd(coordCursor.X, viewport.Left, &coordCursor.X));
 
                 if (success)
                 {
                     // Apply boundary tests to ensure the cursor isn't outside the viewport rectangle.
-                    coordCursor.Y = std::clamp(coordCursor.Y, csbiex.srWindow.Top, gsl::narrow<SHORT>(csbiex.srWindow.Bottom - 1));
-                    coordCursor.X = std::clamp(coordCursor.X, csbiex.srWindow.Left, gsl::narrow<SHORT>(csbiex.srWindow.Right - 1));
+                    coordCursor.Y = std::clamp(coordCursor.Y, viewport.Top, gsl::narrow<SHORT>(viewport.Bottom - 1));
+                    coordCursor.X = std::clamp(coordCursor.X, viewport.Left, gsl::narrow<SHORT>(viewport.Right - 1));
 
                     // Finally, attempt to set the adjusted cursor position back into the console.
                     success = _pConApi->SetConsoleCursorPosition(coordCursor);
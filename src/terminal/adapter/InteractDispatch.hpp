@@ -34,5 +34,7 @@ namespace Microsoft::Console::VirtualTerminal
 
     private:
         std::unique_ptr<ConGetSet> _pConApi;
+        std::vector<INPUT_RECORD> _keyRecords;
+        size_t _smallWrites = 0; // writes in a row that needed far less than _keyRecords holds
     };
 }
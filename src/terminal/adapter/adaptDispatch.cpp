@@ -172,18 +172,19 @@ bool AdaptDispatch::_CursorMovePosition(const Offset rowOffset, const Offset col
     bool success = true;
 
     // First retrieve some information about the buffer
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
     if (success)
     {
         // Calculate the viewport boundaries as inclusive values.
-        // srWindow is exclusive so we need to subtract 1 from the bottom.
-        const int viewportTop = csbiex.srWindow.Top;
-        const int viewportBottom = csbiex.srWindow.Bottom - 1;
+        // The viewport is exclusive so we need to subtract 1 from the bottom.
+        const int viewportTop = viewport.Top;
+        const int viewportBottom = viewport.Bottom - 1;
 
         // Calculate the absolute margins of the scrolling area.
         const int topMargin = viewportTop + _scrollMargins.Top;
@@ -192,8 +193,8 @@ bool AdaptDispatch::_CursorMovePosition(const Offset rowOffset, const Offset col
 
         // For relative movement, the given offsets will be relative to
         // the current cursor position.
-        int row = csbiex.dwCursorPosition.Y;
-        int col = csbiex.dwCursorPosition.X;
+        int row = cursorPosition.Y;
+        int col = cursorPosition.X;
 
         // But if the row is absolute, it will be relative to the top of the
         // viewport, or the top margin, depending on the origin mode.
@@ -213,7 +214,7 @@ bool AdaptDispatch::_CursorMovePosition(const Offset rowOffset, const Offset col
         // The row is constrained within the viewport's vertical boundaries,
         // while the column is constrained by the buffer width.
         row = std::clamp(row + rowOffset.Value, viewportTop, viewportBottom);
-        col = std::clamp(col + colOffset.Value, 0, csbiex.dwSize.X - 1);
+        col = std::clamp(col + colOffset.Value, 0, bufferSize.X - 1);
 
         // If the operation needs to be clamped inside the margins, or the origin
         // mode is relative (which always requires margin clamping), then the row
@@ -228,11 +229,11 @@ bool AdaptDispatch::_CursorMovePosition(const Offset rowOffset, const Offset col
             // to the bottom margin. See
             // ScreenBufferTests::CursorUpDownOutsideMargins for a test of that
             // behavior.
-            if (csbiex.dwCursorPosition.Y >= topMargin)
+            if (cursorPosition.Y >= topMargin)
             {
                 row = std::max(row, topMargin);
             }
-            if (csbiex.dwCursorPosition.Y <= bottomMargin)
+            if (cursorPosition.Y <= bottomMargin)
             {
                 row = std::min(row, bottomMargin);
             }
@@ -315,11 +316,12 @@ bool AdaptDispatch::CursorPosition(const size_t line, const size_t column)
 bool AdaptDispatch::CursorSaveState()
 {
     // First retrieve some information about the buffer
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    bool success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
     TextAttribute attributes;
     success = success && (_pConApi->PrivateGetTextAttributes(attributes));
@@ -328,8 +330,8 @@ bool AdaptDispatch::CursorSaveState()
     {
         // The cursor is given to us by the API as relative to the whole buffer.
         // But in VT speak, the cursor row should be relative to the current viewport top.
-        COORD coordCursor = csbiex.dwCursorPosition;
-        coordCursor.Y -= csbiex.srWindow.Top;
+        COORD coordCursor = cursorPosition;
+        coordCursor.Y -= viewport.Top;
 
         // VT is also 1 based, not 0 based, so correct by 1.
         auto& savedCursorState = _savedCursorState.at(_usingAltBuffer);
@@ -410,14 +412,15 @@ bool AdaptDispatch::_InsertDeleteHelper(const size_t count, const bool isInsert)
     RETURN_BOOL_IF_FALSE(SUCCEEDED(SizeTToShort(count, &distance)));
 
     // get current cursor, attributes
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
     RETURN_BOOL_IF_FALSE(_pConApi->MoveToBottom());
-    RETURN_BOOL_IF_FALSE(_pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    RETURN_BOOL_IF_FALSE(_pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
-    const auto cursor = csbiex.dwCursorPosition;
+    const auto cursor = cursorPosition;
     // Rectangle to cut out of the existing buffer. This is inclusive.
     // It will be clipped to the buffer boundaries so SHORT_MAX gives us the full buffer width.
     SMALL_RECT srScroll;
@@ -480,13 +483,15 @@ bool AdaptDispatch::DeleteCharacter(const size_t count)
 // - Internal helper to erase one particular line of the buffer. Either from beginning to the cursor, from the cursor to the end, or the entire line.
 // - Used by both erase line (used just once) and by erase screen (used in a loop) to erase a portion of the buffer.
 // Arguments:
-// - csbiex - Pointer to the console screen buffer that we will be erasing (and getting cursor data from within)
+// - cursorPosition - The position of the cursor in the buffer
+// - bufferSize - The size of the buffer we will be erasing
 // - eraseType - Enumeration mode of which kind of erase to perform: beginning to cursor, cursor to end, or entire line.
 // - lineId - The line number (array index value, starts at 0) of the line to operate on within the buffer.
 //           - This is not aware of circular buffer. Line 0 is always the top visible line if you scrolled the whole way up the window.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool AdaptDispatch::_EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex,
+bool AdaptDispatch::_EraseSingleLineHelper(const COORD cursorPosition,
+                                           const COORD bufferSize,
                                            const DispatchTypes::EraseType eraseType,
                                            const size_t lineId) const
 {
@@ -505,7 +510,7 @@ bool AdaptDispatch::_EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX& c
         coordStartPosition.X = 0; // from beginning and the whole line start from the left most edge of the buffer.
         break;
     case DispatchTypes::EraseType::ToEnd:
-        coordStartPosition.X = csbiex.dwCursorPosition.X; // from the current cursor position (including it)
+        coordStartPosition.X = cursorPosition.X; // from the current cursor position (including it)
         break;
     }
 
@@ -516,12 +521,12 @@ bool AdaptDispatch::_EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX& c
     {
     case DispatchTypes::EraseType::FromBeginning:
         // +1 because if cursor were at the left edge, the length would be 0 and we want to paint at least the 1 character the cursor is on.
-        nLength = csbiex.dwCursorPosition.X + 1;
+        nLength = cursorPosition.X + 1;
         break;
     case DispatchTypes::EraseType::ToEnd:
     case DispatchTypes::EraseType::All:
         // Remember the .X value is 1 farther than the right most column in the buffer. Therefore no +1.
-        nLength = csbiex.dwSize.X - coordStartPosition.X;
+        nLength = bufferSize.X - coordStartPosition.X;
         break;
     }
 
@@ -540,15 +545,16 @@ bool AdaptDispatch::_EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX& c
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::EraseCharacters(const size_t numChars)
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
-    bool success = _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
+    bool success = _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize);
 
     if (success)
     {
-        const COORD startPosition = csbiex.dwCursorPosition;
+        const COORD startPosition = cursorPosition;
 
-        const SHORT remainingSpaces = csbiex.dwSize.X - startPosition.X;
+        const SHORT remainingSpaces = bufferSize.X - startPosition.X;
         const size_t actualRemaining = gsl::narrow_cast<size_t>((remainingSpaces < 0) ? 0 : remainingSpaces);
         // erase at max the number of characters remaining in the line from the current position.
         const auto eraseLength = (numChars <= actualRemaining) ? numChars : actualRemaining;
@@ -585,11 +591,12 @@ bool AdaptDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
         return _EraseAll();
     }
 
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    bool success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
     if (success)
     {
@@ -606,9 +613,9 @@ bool AdaptDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
         if (eraseType == DispatchTypes::EraseType::FromBeginning)
         {
             // For beginning and all, erase all complete lines before (above vertically) from the cursor position.
-            for (SHORT startLine = csbiex.srWindow.Top; startLine < csbiex.dwCursorPosition.Y; startLine++)
+            for (SHORT startLine = viewport.Top; startLine < cursorPosition.Y; startLine++)
             {
-                success = _EraseSingleLineHelper(csbiex, DispatchTypes::EraseType::All, startLine);
+                success = _EraseSingleLineHelper(cursorPosition, bufferSize, DispatchTypes::EraseType::All, startLine);
 
                 if (!success)
                 {
@@ -620,7 +627,7 @@ bool AdaptDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
         if (success)
         {
             // 2. Cursor Line
-            success = _EraseSingleLineHelper(csbiex, eraseType, csbiex.dwCursorPosition.Y);
+            success = _EraseSingleLineHelper(cursorPosition, bufferSize, eraseType, cursorPosition.Y);
         }
 
         if (success)
@@ -630,9 +637,9 @@ bool AdaptDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
             {
                 // For beginning and all, erase all complete lines after (below vertically) the cursor position.
                 // Remember that the viewport bottom value is 1 beyond the viewable area of the viewport.
-                for (SHORT startLine = csbiex.dwCursorPosition.Y + 1; startLine < csbiex.srWindow.Bottom; startLine++)
+                for (SHORT startLine = cursorPosition.Y + 1; startLine < viewport.Bottom; startLine++)
                 {
-                    success = _EraseSingleLineHelper(csbiex, DispatchTypes::EraseType::All, startLine);
+                    success = _EraseSingleLineHelper(cursorPosition, bufferSize, DispatchTypes::EraseType::All, startLine);
 
                     if (!success)
                     {
@@ -654,13 +661,14 @@ bool AdaptDispatch::EraseInDisplay(const DispatchTypes::EraseType eraseType)
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::EraseInLine(const DispatchTypes::EraseType eraseType)
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
-    bool success = _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
+    bool success = _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize);
 
     if (success)
     {
-        success = _EraseSingleLineHelper(csbiex, eraseType, csbiex.dwCursorPosition.Y);
+        success = _EraseSingleLineHelper(cursorPosition, bufferSize, eraseType, cursorPosition.Y);
     }
 
     return success;
@@ -708,19 +716,20 @@ bool AdaptDispatch::DeviceAttributes()
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::_CursorPositionReport() const
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    bool success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
     if (success)
     {
         // First pull the cursor position relative to the entire buffer out of the console.
-        COORD coordCursorPos = csbiex.dwCursorPosition;
+        COORD coordCursorPos = cursorPosition;
 
         // Now adjust it for its position in respect to the current viewport top.
-        coordCursorPos.Y -= csbiex.srWindow.Top;
+        coordCursorPos.Y -= viewport.Top;
 
         // NOTE: 1,1 is the top-left corner of the viewport in VT-speak, so add 1.
         coordCursorPos.X++;
@@ -795,11 +804,12 @@ bool AdaptDispatch::_ScrollMovement(const ScrollDirection scrollDirection, const
     if (success)
     {
         // get current cursor
-        CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-        csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+        COORD cursorPosition{ 0 };
+        SMALL_RECT viewport{ 0 };
+        COORD bufferSize{ 0 };
         // Make sure to reset the viewport (with MoveToBottom )to where it was
         //      before the user scrolled the console output
-        success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+        success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
         if (success)
         {
@@ -808,13 +818,13 @@ bool AdaptDispatch::_ScrollMovement(const ScrollDirection scrollDirection, const
             SMALL_RECT srScreen;
             srScreen.Left = 0;
             srScreen.Right = SHORT_MAX;
-            srScreen.Top = csbiex.srWindow.Top;
-            srScreen.Bottom = csbiex.srWindow.Bottom - 1; // srWindow is exclusive, hence the - 1
+            srScreen.Top = viewport.Top;
+            srScreen.Bottom = viewport.Bottom - 1; // viewport is exclusive, hence the - 1
             // Clip to the DECSTBM margin boundaries
             if (_scrollMargins.Top < _scrollMargins.Bottom)
             {
-                srScreen.Top = csbiex.srWindow.Top + _scrollMargins.Top;
-                srScreen.Bottom = csbiex.srWindow.Top + _scrollMargins.Bottom;
+                srScreen.Top = viewport.Top + _scrollMargins.Top;
+                srScreen.Bottom = viewport.Top + _scrollMargins.Bottom;
             }
 
             // Paste coordinate for cut text above
@@ -1121,11 +1131,12 @@ bool AdaptDispatch::SetOriginMode(const bool relativeMode) noexcept
 bool AdaptDispatch::_DoSetTopBottomScrollingMargins(const size_t topMargin,
                                                     const size_t bottomMargin)
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = (_pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex));
+    bool success = (_pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize));
 
     // so notes time: (input -> state machine out -> adapter out -> conhost internal)
     // having only a top param is legal         ([3;r   -> 3,0   -> 3,h  -> 3,h,true)
@@ -1139,7 +1150,7 @@ bool AdaptDispatch::_DoSetTopBottomScrollingMargins(const size_t topMargin,
         success = SUCCEEDED(SizeTToShort(topMargin, &actualTop)) && SUCCEEDED(SizeTToShort(bottomMargin, &actualBottom));
         if (success)
         {
-            const SHORT screenHeight = csbiex.srWindow.Bottom - csbiex.srWindow.Top;
+            const SHORT screenHeight = viewport.Bottom - viewport.Top;
             // The default top margin is line 1
             if (actualTop == 0)
             {
@@ -1518,17 +1529,18 @@ bool AdaptDispatch::HardReset()
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::ScreenAlignmentPattern()
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = _pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+    bool success = _pConApi->MoveToBottom() && _pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize);
 
     if (success)
     {
         // Fill the screen with the letter E using the default attributes.
-        auto fillPosition = COORD{ 0, csbiex.srWindow.Top };
-        const auto fillLength = (csbiex.srWindow.Bottom - csbiex.srWindow.Top) * csbiex.dwSize.X;
+        auto fillPosition = COORD{ 0, viewport.Top };
+        const auto fillLength = (viewport.Bottom - viewport.Top) * bufferSize.X;
         success = _pConApi->PrivateFillRegion(fillPosition, fillLength, L'E', false);
         // Reset the meta/extended attributes (but leave the colors unchanged).
         success = success && _pConApi->PrivateSetLegacyAttributes(0, false, false, true);
@@ -1558,17 +1570,18 @@ bool AdaptDispatch::ScreenAlignmentPattern()
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::_EraseScrollback()
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
-    csbiex.cbSize = sizeof(csbiex);
+    COORD cursorPosition{ 0 };
+    SMALL_RECT viewport{ 0 };
+    COORD bufferSize{ 0 };
     // Make sure to reset the viewport (with MoveToBottom )to where it was
     //      before the user scrolled the console output
-    bool success = (_pConApi->GetConsoleScreenBufferInfoEx(csbiex) && _pConApi->MoveToBottom());
+    bool success = (_pConApi->PrivateGetCursorAndViewport(cursorPosition, viewport, bufferSize) && _pConApi->MoveToBottom());
     if (success)
     {
-        const SMALL_RECT screen = csbiex.srWindow;
+        const SMALL_RECT screen = viewport;
         const SHORT height = screen.Bottom - screen.Top;
         FAIL_FAST_IF(!(height > 0));
-        const COORD cursor = csbiex.dwCursorPosition;
+        const COORD cursor = cursorPosition;
 
         // Rectangle to cut out of the existing buffer
         // It will be clipped to the buffer boundaries so SHORT_MAX gives us the full buffer width.
@@ -1586,7 +1599,7 @@ bool AdaptDispatch::_EraseScrollback()
         if (success)
         {
             // Clear everything after the viewport.
-            const DWORD totalAreaBelow = csbiex.dwSize.X * (csbiex.dwSize.Y - height);
+            const DWORD totalAreaBelow = bufferSize.X * (bufferSize.Y - height);
             const COORD coordBelowStartPosition = { 0, height };
             // Again we need to use the default attributes, hence standardFillAttrs is false.
             success = _pConApi->PrivateFillRegion(coordBelowStartPosition, totalAreaBelow, L' ', false);
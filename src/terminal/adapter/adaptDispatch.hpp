@@ -131,7 +131,8 @@ namespace Microsoft::Console::VirtualTerminal
         };
 
         bool _CursorMovePosition(const Offset rowOffset, const Offset colOffset, const bool clampInMargins) const;
-        bool _EraseSingleLineHelper(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex,
+        bool _EraseSingleLineHelper(const COORD cursorPosition,
+                                    const COORD bufferSize,
                                     const DispatchTypes::EraseType eraseType,
                                     const size_t lineId) const;
         void _SetGraphicsOptionHelper(const DispatchTypes::GraphicsOptions opt, WORD& attr);
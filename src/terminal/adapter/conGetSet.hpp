@@ -29,6 +29,8 @@ namespace Microsoft::Console::VirtualTerminal
     public:
         virtual bool GetConsoleCursorInfo(CONSOLE_CURSOR_INFO& cursorInfo) const = 0;
         virtual bool GetConsoleScreenBufferInfoEx(CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) const = 0;
+        // Only the cursor, viewport (exclusive, like srWindow) and buffer size, without the rest of the info above.
+        virtual bool PrivateGetCursorAndViewport(COORD& cursorPosition, SMALL_RECT& viewport, COORD& bufferSize) const = 0;
         virtual bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& screenBufferInfo) = 0;
         virtual bool SetConsoleCursorInfo(const CONSOLE_CURSOR_INFO& cursorInfo) = 0;
         virtual bool SetConsoleCursorPosition(const COORD position) = 0;
@@ -52,6 +54,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                                size_t& eventsWritten) = 0;
+        virtual bool PrivateWriteConsoleInputRecords(const gsl::span<const INPUT_RECORD> records,
+                                                     size_t& eventsWritten) = 0;
         virtual bool SetConsoleWindowInfo(const bool absolute,
                                           const SMALL_RECT& window) = 0;
         virtual bool PrivateSetCursorKeysMode(const bool applicationMode) = 0;
@@ -6,6 +6,8 @@
 #include "..\..\inc\consoletaeftemplates.hpp"
 
 #include "adaptDispatch.hpp"
+#include "InteractDispatch.hpp"
+#include "../../types/inc/convert.hpp"
 
 using namespace WEX::Common;
 using namespace WEX::Logging;
@@ -72,6 +74,19 @@ public:
 
         return _getConsoleScreenBufferInfoExResult;
     }
+    bool PrivateGetCursorAndViewport(COORD& cursorPosition, SMALL_RECT& viewport, COORD& bufferSize) const override
+    {
+        Log::Comment(L"PrivateGetCursorAndViewport MOCK returning data...");
+
+        if (_getConsoleScreenBufferInfoExResult)
+        {
+            cursorPosition = _cursorPos;
+            viewport = _viewport;
+            bufferSize = _bufferSize;
+        }
+
+        return _getConsoleScreenBufferInfoExResult;
+    }
     bool SetConsoleScreenBufferInfoEx(const CONSOLE_SCREEN_BUFFER_INFOEX& sbiex) override
     {
         Log::Comment(L"SetConsoleScreenBufferInfoEx MOCK returning data...");
@@ -332,6 +347,23 @@ public:
         return _privateWriteConsoleInputWResult;
     }
 
+    bool PrivateWriteConsoleInputRecords(const gsl::span<const INPUT_RECORD> records,
+                                         size_t& eventsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleInputRecords MOCK called...");
+
+        if (_privateWriteConsoleInputWResult)
+        {
+            // wrap the records we were given into local storage so we can test against them
+            Log::Comment(NoThrowString().Format(L"Copying %zu input records into local storage...", records.size()));
+
+            _events = IInputEvent::Create(records);
+            eventsWritten = _events.size();
+        }
+
+        return _privateWriteConsoleInputWResult;
+    }
+
     bool PrivatePrependConsoleInput(std::deque<std::unique_ptr<IInputEvent>>& events,
                                     size_t& eventsWritten) override
     {
@@ -2264,6 +2296,78 @@ public:
         VERIFY_IS_FALSE(_pDispatch.get()->SetColorTableEntry(15, testColor));
     }
 
+    TEST_METHOD(WriteStringMatchesCharToKeyEvents)
+    {
+        Log::Comment(L"Starting test...");
+
+        auto api = std::make_unique<TestGetSet>();
+        TestGetSet* const testGetSet = api.get();
+        InteractDispatch dispatch{ std::move(api) };
+
+        testGetSet->PrepData();
+        testGetSet->_getConsoleOutputCPResult = true;
+        testGetSet->_expectedOutputCP = CP_USA;
+
+        // Lower and upper case letters are typed on the keyboard, the latter
+        // with shift. The plus-minus sign isn't on the keyboard, so it has to
+        // be typed on the numpad: it's 241 in codepage 437.
+        const std::wstring_view string{ L"aB\x00b1" };
+
+        const auto key = [](const bool down, const WORD vk, const WORD scanCode, const wchar_t wch, const DWORD modifiers) {
+            KEY_EVENT_RECORD record{};
+            record.bKeyDown = down;
+            record.wRepeatCount = 1;
+            record.wVirtualKeyCode = vk;
+            record.wVirtualScanCode = scanCode;
+            record.uChar.UnicodeChar = wch;
+            record.dwControlKeyState = modifiers;
+            return record;
+        };
+        const std::vector<KEY_EVENT_RECORD> expected{
+            key(true, 'A', 0x1e, L'a', 0),
+            key(false, 'A', 0x1e, L'a', 0),
+
+            key(true, VK_SHIFT, 0x2a, UNICODE_NULL, SHIFT_PRESSED),
+            key(true, 'B', 0x30, L'B', SHIFT_PRESSED),
+            key(false, 'B', 0x30, L'B', SHIFT_PRESSED),
+            key(false, VK_SHIFT, 0x2a, UNICODE_NULL, 0),
+
+            key(true, VK_MENU, 0x38, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(true, VK_NUMPAD2, 0x50, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(false, VK_NUMPAD2, 0x50, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(true, VK_NUMPAD4, 0x4b, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(false, VK_NUMPAD4, 0x4b, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(true, VK_NUMPAD1, 0x4f, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(false, VK_NUMPAD1, 0x4f, UNICODE_NULL, LEFT_ALT_PRESSED),
+            key(false, VK_MENU, 0x38, L'\x00b1', 0),
+        };
+
+        Log::Comment(L"Test 1: 'a' is typed as is, 'B' with shift, and the plus-minus sign as alt+241 on the numpad.");
+        VERIFY_IS_TRUE(dispatch.WriteString(string));
+        VERIFY_ARE_EQUAL(expected.size(), testGetSet->_events.size());
+        for (size_t i = 0; i < expected.size(); i++)
+        {
+            Log::Comment(NoThrowString().Format(L"Record %zu", i));
+            VERIFY_ARE_EQUAL(InputEventType::KeyEvent, testGetSet->_events.at(i)->EventType());
+            const auto& keyEvent = static_cast<const KeyEvent&>(*testGetSet->_events.at(i));
+            const auto& record = expected.at(i);
+            VERIFY_ARE_EQUAL(!!record.bKeyDown, keyEvent.IsKeyDown());
+            VERIFY_ARE_EQUAL(record.wRepeatCount, keyEvent.GetRepeatCount());
+            VERIFY_ARE_EQUAL(record.wVirtualKeyCode, keyEvent.GetVirtualKeyCode());
+            VERIFY_ARE_EQUAL(record.wVirtualScanCode, keyEvent.GetVirtualScanCode());
+            VERIFY_ARE_EQUAL(record.uChar.UnicodeChar, keyEvent.GetCharData());
+            VERIFY_ARE_EQUAL(record.dwControlKeyState, keyEvent.GetActiveModifierKeys());
+        }
+
+        Log::Comment(L"Test 2: A second string replaces the records of the first.");
+        VERIFY_IS_TRUE(dispatch.WriteString(L"a"));
+        VERIFY_ARE_EQUAL(2u, testGetSet->_events.size());
+
+        Log::Comment(L"Test 3: Nothing is written if the codepage can't be read.");
+        testGetSet->_getConsoleOutputCPResult = false;
+        VERIFY_IS_FALSE(dispatch.WriteString(string));
+    }
+
 private:
     TestGetSet* _testGetSet; // non-ownership pointer
     std::unique_ptr<AdaptDispatch> _pDispatch;
@@ -303,7 +303,7 @@ bool OutputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
     size_t clearType = 0;
     unsigned int function = 0;
     DispatchTypes::EraseType eraseType = DispatchTypes::EraseType::ToEnd;
-    std::vector<DispatchTypes::GraphicsOptions> graphicsOptions;
+    GraphicsOptionsList graphicsOptions;
     DispatchTypes::AnsiStatusType deviceStatusType = static_cast<DispatchTypes::AnsiStatusType>(0); // there is no default status type.
     size_t repeatCount = 0;
     // This is all the args after the first arg, and the count of args not including the first one.
@@ -574,7 +574,7 @@ bool OutputStateMachineEngine::_IntermediateQuestionMarkDispatch(const wchar_t w
 {
     bool success = false;
 
-    std::vector<DispatchTypes::PrivateModeParams> privateModeParams;
+    PrivateModeParamsList privateModeParams;
     // Ensure that there was the right number of params
     switch (wchAction)
     {
@@ -821,7 +821,7 @@ bool OutputStateMachineEngine::ActionSs3Dispatch(const wchar_t /*wch*/,
 // Return Value:
 // - True if we successfully retrieved an array of valid graphics options from the parameters we've stored. False otherwise.
 bool OutputStateMachineEngine::_GetGraphicsOptions(const std::basic_string_view<size_t> parameters,
-                                                   std::vector<DispatchTypes::GraphicsOptions>& options) const
+                                                   GraphicsOptionsList& options) const
 {
     bool success = false;
 
@@ -1124,7 +1124,7 @@ bool OutputStateMachineEngine::_GetDeviceStatusOperation(const std::basic_string
 // Return Value:
 // - True if we successfully retrieved an array of private mode params from the parameters we've stored. False otherwise.
 bool OutputStateMachineEngine::_GetPrivateModeParams(const std::basic_string_view<size_t> parameters,
-                                                     std::vector<DispatchTypes::PrivateModeParams>& privateModes) const
+                                                     PrivateModeParamsList& privateModes) const
 {
     bool success = false;
     // Can't just set nothing at all
@@ -15,6 +15,7 @@ Abstract:
 #include "../adapter/termDispatch.hpp"
 #include "telemetry.hpp"
 #include "IStateMachineEngine.hpp"
+#include "stateMachine.hpp"
 #include "../../inc/ITerminalOutputConnection.hpp"
 
 namespace Microsoft::Console::VirtualTerminal
@@ -150,8 +151,9 @@ namespace Microsoft::Console::VirtualTerminal
         };
 
         static constexpr DispatchTypes::GraphicsOptions DefaultGraphicsOption = DispatchTypes::GraphicsOptions::Off;
+        using GraphicsOptionsList = til::some<DispatchTypes::GraphicsOptions, StateMachine::MaxParameterCount>;
         bool _GetGraphicsOptions(const std::basic_string_view<size_t> parameters,
-                                 std::vector<DispatchTypes::GraphicsOptions>& options) const;
+                                 GraphicsOptionsList& options) const;
 
         static constexpr DispatchTypes::EraseType DefaultEraseType = DispatchTypes::EraseType::ToEnd;
         bool _GetEraseOperation(const std::basic_string_view<size_t> parameters,
@@ -182,8 +184,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _VerifyDeviceAttributesParams(const std::basic_string_view<size_t> parameters) const noexcept;
 
+        using PrivateModeParamsList = til::some<DispatchTypes::PrivateModeParams, StateMachine::MaxParameterCount>;
         bool _GetPrivateModeParams(const std::basic_string_view<size_t> parameters,
-                                   std::vector<DispatchTypes::PrivateModeParams>& privateModes) const;
+                                   PrivateModeParamsList& privateModes) const;
 
         static constexpr size_t DefaultTopMargin = 0;
         static constexpr size_t DefaultBottomMargin = 0;
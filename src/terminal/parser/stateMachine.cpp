@@ -7,6 +7,10 @@
 
 #include "ascii.hpp"
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 //Takes ownership of the pEngine.
@@ -16,8 +20,12 @@ StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine) :
     _trace(Microsoft::Console::VirtualTerminal::ParserTracing()),
     _intermediates{},
     _parameters{},
+    _parameterLimitReached(false),
     _oscString{},
-    _processingIndividually(false)
+    _processingIndividually(false),
+    _utf8Buffer{},
+    _utf8Partials{},
+    _utf8PartialsLength{ 0 }
 {
     _ActionClear();
 }
@@ -147,18 +155,6 @@ static constexpr bool _isCsiDelimiter(const wchar_t wch) noexcept
     return wch == L';'; // 0x3B
 }
 
-// Routine Description:
-// - Determines if a character is a valid parameter value
-//   Parameters must be numerical digits.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isCsiParamValue(const wchar_t wch) noexcept
-{
-    return wch >= L'0' && wch <= L'9'; // 0x30 - 0x39
-}
-
 // Routine Description:
 // - Determines if a character is a private range marker for a control sequence.
 //   Private range markers indicate vendor-specific behavior.
@@ -208,56 +204,6 @@ static constexpr bool _isOscIndicator(const wchar_t wch) noexcept
     return wch == L']'; // 0x5D
 }
 
-// Routine Description:
-// - Determines if a character is a delimiter between two parameters in a "operating system control sequence"
-//   This occurs in the middle of a control sequence after escape and OscIndicator have been recognized,
-//   after the paramater indicating which OSC action to take.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isOscDelimiter(const wchar_t wch) noexcept
-{
-    return wch == L';'; // 0x3B
-}
-
-// Routine Description:
-// - Determines if a character is a valid parameter value for an OSC String,
-//     that is, the indicator of which OSC action to take.
-//   Parameters must be numerical digits.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isOscParamValue(const wchar_t wch) noexcept
-{
-    return _isNumber(wch); // 0x30 - 0x39
-}
-
-// Routine Description:
-// - Determines if a character should be initiate the end of an OSC sequence.
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isOscTerminationInitiator(const wchar_t wch) noexcept
-{
-    return wch == AsciiChars::ESC;
-}
-
-// Routine Description:
-// - Determines if a character should be ignored in a operating system control sequence
-// Arguments:
-// - wch - Character to check.
-// Return Value:
-// - True if it is. False if it isn't.
-static constexpr bool _isOscInvalid(const wchar_t wch) noexcept
-{
-    return wch <= L'\x17' ||
-           wch == L'\x19' ||
-           (wch >= L'\x1c' && wch <= L'\x1f');
-}
-
 // Routine Description:
 // - Determines if a character is "operating system control string" termination indicator.
 //   This signals the end of an OSC string collection.
@@ -284,6 +230,58 @@ static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 
 #pragma warning(pop)
 
+// Routine Description:
+// - Finds the first character in the string that is actionable from the ground state.
+// - Printable text is by far the most common input, so on x86/x64 we test 8 characters
+//   at a time with SSE2 and only fall back to testing individual characters for the tail.
+// Arguments:
+// - string - Characters to scan.
+// Return Value:
+// - The index of the first actionable character, or the size of the string if there is none.
+static size_t _findActionableFromGround(const std::wstring_view string) noexcept
+{
+    size_t i = 0;
+
+#if defined(_M_IX86) || defined(_M_X64)
+    const auto lastC0 = _mm_set1_epi16(static_cast<short>(AsciiChars::US));
+    const auto del = _mm_set1_epi16(static_cast<short>(AsciiChars::DEL));
+    const auto c1Csi = _mm_set1_epi16(static_cast<short>(L'\x9b'));
+    const auto zero = _mm_setzero_si128();
+
+    for (; i + 8 <= string.size(); i += 8)
+    {
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. We're scanning the view in fixed size blocks.
+#pragma warning(suppress : 26490) // Don't use reinterpret_cast. The intrinsic requires it.
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(string.data() + i));
+
+        // There is no unsigned 16-bit compare in SSE2, but a saturating subtract
+        // only yields 0 when the character is less than or equal to US.
+        const auto isC0 = _mm_cmpeq_epi16(_mm_subs_epu16(chunk, lastC0), zero);
+        const auto isDel = _mm_cmpeq_epi16(chunk, del);
+        const auto isC1Csi = _mm_cmpeq_epi16(chunk, c1Csi);
+
+        const auto mask = _mm_movemask_epi8(_mm_or_si128(isC0, _mm_or_si128(isDel, isC1Csi)));
+        if (mask != 0)
+        {
+            unsigned long bit = 0;
+            _BitScanForward(&bit, static_cast<unsigned long>(mask));
+            // The mask has two bits for every 16-bit character.
+            return i + bit / 2;
+        }
+    }
+#endif
+
+    for (; i < string.size(); ++i)
+    {
+        if (_isActionableFromGround(til::at(string, i)))
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
 // Routine Description:
 // - Triggers the Execute action to indicate that the listener should immediately respond to a C0 control character.
 // Arguments:
@@ -380,8 +378,11 @@ void StateMachine::_ActionCollect(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Collect");
 
-    // store collect data
-    _intermediates.push_back(wch);
+    // store collect data, dropping anything beyond the maximum we keep.
+    if (_intermediates.size() < _intermediates.max_size())
+    {
+        _intermediates.push_back(wch);
+    }
 }
 
 // Routine Description:
@@ -406,10 +407,18 @@ void StateMachine::_ActionParam(const wchar_t wch)
     //      eg "\x1b[0;;m" should be three "0" params
     if (wch == L';')
     {
-        // Move to next param.
-        _parameters.push_back(0);
+        // Move to next param. Once we're out of space, the remaining params
+        // of this sequence are ignored rather than merged into the last one.
+        if (_parameters.size() < _parameters.max_size())
+        {
+            _parameters.push_back(0);
+        }
+        else
+        {
+            _parameterLimitReached = true;
+        }
     }
-    else
+    else if (!_parameterLimitReached)
     {
         // Accumulate the character given into the last (current) parameter
         _AccumulateTo(wch, _parameters.back());
@@ -430,6 +439,7 @@ void StateMachine::_ActionClear()
     _intermediates.clear();
 
     _parameters.clear();
+    _parameterLimitReached = false;
 
     _oscString.clear();
     _oscParameter = 0;
@@ -698,460 +708,366 @@ void StateMachine::_EnterSs3Param() noexcept
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the Ground state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Handle a C1 Control Sequence Introducer
-//   3. Print all other characters
+// - Determines the class of a character for the purposes of the state transition table.
+//   Every character in a class triggers exactly the same action and transition in every
+//   state, so the table only needs one column per class instead of one per character.
 // Arguments:
-// - wch - Character that triggered the event
+// - wch - Character to classify.
 // Return Value:
-// - <none>
-void StateMachine::_EventGround(const wchar_t wch)
+// - The character class of wch.
+constexpr StateMachine::VTCharClasses StateMachine::_ClassifyCharacter(const wchar_t wch) noexcept
 {
-    _trace.TraceOnEvent(L"Ground");
-    if (_isC0Code(wch) || _isDelete(wch))
+    if (wch == AsciiChars::CAN || wch == AsciiChars::SUB)
     {
-        _ActionExecute(wch);
+        return VTCharClasses::Cancel;
     }
-    else if (_isC1Csi(wch))
+    else if (_isEscape(wch))
     {
-        _EnterCsiEntry();
+        return VTCharClasses::Escape;
     }
-    else
+    else if (wch == AsciiChars::BEL)
     {
-        _ActionPrint(wch);
+        return VTCharClasses::Bell;
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the Escape state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Enter Control Sequence state
-//   5. Dispatch an Escape action.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventEscape(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Escape");
-    if (_isC0Code(wch))
+    else if (_isC0Code(wch))
     {
-        if (_engine->DispatchControlCharsFromEscape())
-        {
-            _ActionExecuteFromEscape(wch);
-            _EnterGround();
-        }
-        else
-        {
-            _ActionExecute(wch);
-        }
+        return VTCharClasses::C0;
     }
     else if (_isDelete(wch))
     {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        if (_engine->DispatchIntermediatesFromEscape())
-        {
-            _ActionEscDispatch(wch);
-            _EnterGround();
-        }
-        else
-        {
-            _ActionCollect(wch);
-            _EnterEscapeIntermediate();
-        }
-    }
-    else if (_isCsiIndicator(wch))
-    {
-        _EnterCsiEntry();
-    }
-    else if (_isOscIndicator(wch))
-    {
-        _EnterOscParam();
-    }
-    else if (_isSs3Indicator(wch))
-    {
-        _EnterSs3Entry();
-    }
-    else
-    {
-        _ActionEscDispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the EscapeIntermediate state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Dispatch an Escape action.
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"EscapeIntermediate");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
+        return VTCharClasses::Delete;
     }
     else if (_isIntermediate(wch))
     {
-        _ActionCollect(wch);
+        return VTCharClasses::Intermediate;
     }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else
+    else if (_isNumber(wch))
     {
-        _ActionEscDispatch(wch);
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiEntry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Collect Control Sequence Private markers
-//   7. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiEntry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiEntry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
+        return VTCharClasses::Digit;
     }
     else if (_isCsiInvalid(wch))
     {
-        _EnterCsiIgnore();
+        return VTCharClasses::Colon;
     }
-    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
+    else if (_isCsiDelimiter(wch))
     {
-        _ActionParam(wch);
-        _EnterCsiParam();
+        return VTCharClasses::Semicolon;
     }
     else if (_isCsiPrivateMarker(wch))
     {
-        _ActionCollect(wch);
-        _EnterCsiParam();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+        return VTCharClasses::PrivateMarker;
     }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIntermediate state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventCsiIntermediate(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiIntermediate");
-    if (_isC0Code(wch))
+    else if (_isCsiIndicator(wch))
     {
-        _ActionExecute(wch);
+        return VTCharClasses::CsiIndicator;
     }
-    else if (_isIntermediate(wch))
+    else if (_isOscIndicator(wch))
     {
-        _ActionCollect(wch);
+        return VTCharClasses::OscIndicator;
     }
-    else if (_isDelete(wch))
+    else if (_isSs3Indicator(wch))
     {
-        _ActionIgnore();
+        return VTCharClasses::Ss3Indicator;
     }
-    else if (_isCsiParamValue(wch) || _isCsiInvalid(wch) || _isCsiDelimiter(wch) || _isCsiPrivateMarker(wch))
+    else if (_isC1Csi(wch))
     {
-        _EnterCsiIgnore();
+        return VTCharClasses::C1Csi;
     }
-    else
+    else if (_isOscTerminator(wch))
     {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+        return VTCharClasses::C1St;
     }
+    return VTCharClasses::Printable;
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiIgnore state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Return to Ground
+// - Builds the lookup table mapping every 7-bit and C1 character to its character class.
+//   Any character beyond the C1 range is printable.
 // Arguments:
-// - wch - Character that triggered the event
-// Return Value:
 // - <none>
-void StateMachine::_EventCsiIgnore(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"CsiIgnore");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiParamValue(wch) || _isCsiInvalid(wch) || _isCsiDelimiter(wch) || _isCsiPrivateMarker(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        _EnterGround();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
-//   6. Dispatch a control sequence with parameters for action
-// Arguments:
-// - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventCsiParam(const wchar_t wch)
+// - The character class table.
+constexpr StateMachine::VTCharClassTable StateMachine::_BuildCharClassTable() noexcept
 {
-    _trace.TraceOnEvent(L"CsiParam");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
+    VTCharClassTable table{};
+    for (size_t i = 0; i < table.size(); ++i)
     {
-        _ActionParam(wch);
-    }
-    else if (_isIntermediate(wch))
-    {
-        _ActionCollect(wch);
-        _EnterCsiIntermediate();
-    }
-    else if (_isCsiInvalid(wch) || _isCsiPrivateMarker(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
-        _ActionCsiDispatch(wch);
-        _EnterGround();
+        table.at(i) = _ClassifyCharacter(static_cast<wchar_t>(i));
     }
+    return table;
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Collect numeric values into an Osc Param
-//   2. Move to the OscString state on a delimiter
-//   3. Ignore everything else.
+// - Builds the state transition table. For every state and character class it stores the
+//   action to take and, optionally, the state to enter afterwards.
+//   The design is based on the DEC ANSI parser at http://vt100.net/emu/dec_ansi_parser
+//   with the same extensions (SS3, OSC parameters) our per-state event handlers had.
 // Arguments:
-// - wch - Character that triggered the event
-// Return Value:
 // - <none>
-void StateMachine::_EventOscParam(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscParam");
-    if (_isOscTerminator(wch))
-    {
-        _EnterGround();
-    }
-    else if (_isOscParamValue(wch))
-    {
-        _ActionOscParam(wch);
-    }
-    else if (_isOscDelimiter(wch))
-    {
-        _EnterOscString();
-    }
-    else
-    {
-        _ActionIgnore();
-    }
-}
-
-// Routine Description:
-// - Processes a character event into a Action that occurs while in the OscParam state.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-//   2. If we see a ESC, enter the OscTermination state. We'll wait for one
-//      more character before we dispatch the string.
-//   3. Ignore OscInvalid characters.
-//   4. Collect everything else into the OscString
-// Arguments:
-// - wch - Character that triggered the event
 // Return Value:
-// - <none>
-void StateMachine::_EventOscString(const wchar_t wch)
+// - The state transition table.
+constexpr StateMachine::VTTransitionTable StateMachine::_BuildTransitionTable() noexcept
 {
-    _trace.TraceOnEvent(L"OscString");
-    if (_isOscTerminator(wch))
-    {
-        _ActionOscDispatch(wch);
-        _EnterGround();
-    }
-    else if (_isOscTerminationInitiator(wch))
-    {
-        _EnterOscTermination();
-    }
-    else if (_isOscInvalid(wch))
-    {
-        _ActionIgnore();
-    }
-    else
-    {
-        // add this character to our OSC string
-        _ActionOscPut(wch);
-    }
-}
+    using S = VTStates;
+    using C = VTCharClasses;
+    using A = VTActions;
 
-// Routine Description:
-// - Handle the two-character termination of a OSC sequence.
-//   Events in this state will:
-//   1. Trigger the OSC action associated with the param on an OscTerminator
-// Arguments:
-// - wch - Character that triggered the event
-// Return Value:
-// - <none>
-void StateMachine::_EventOscTermination(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"OscTermination");
+    VTTransitionTable table{};
 
-    _ActionOscDispatch(wch);
-    _EnterGround();
-}
+    // Fills the given classes of a state with an action that doesn't change state.
+    const auto stay = [&](const S state, const A action, const std::initializer_list<C> classes) noexcept {
+        for (const auto cls : classes)
+        {
+            table.at(static_cast<size_t>(state)).at(static_cast<size_t>(cls)) = { action, false, state };
+        }
+    };
+
+    // Fills the given classes of a state with an action followed by entering a new state.
+    const auto enter = [&](const S state, const A action, const S next, const std::initializer_list<C> classes) noexcept {
+        for (const auto cls : classes)
+        {
+            table.at(static_cast<size_t>(state)).at(static_cast<size_t>(cls)) = { action, true, next };
+        }
+    };
+
+    // Fills every class of a state with an action followed by entering a new state.
+    const auto enterAll = [&](const S state, const A action, const S next) noexcept {
+        for (auto& transition : table.at(static_cast<size_t>(state)))
+        {
+            transition = { action, true, next };
+        }
+    };
+
+    // Fills every class of a state with an action that doesn't change state.
+    const auto stayAll = [&](const S state, const A action) noexcept {
+        for (auto& transition : table.at(static_cast<size_t>(state)))
+        {
+            transition = { action, false, state };
+        }
+    };
+
+    // Ground
+    stayAll(S::Ground, A::Print);
+    stay(S::Ground, A::Execute, { C::C0, C::Bell, C::Delete });
+    enter(S::Ground, A::None, S::CsiEntry, { C::C1Csi });
+
+    // Escape
+    enterAll(S::Escape, A::EscDispatch, S::Ground);
+    stay(S::Escape, A::EscapeExecute, { C::C0, C::Bell });
+    stay(S::Escape, A::Ignore, { C::Delete });
+    stay(S::Escape, A::EscapeCollect, { C::Intermediate });
+    enter(S::Escape, A::None, S::CsiEntry, { C::CsiIndicator });
+    enter(S::Escape, A::None, S::OscParam, { C::OscIndicator });
+    enter(S::Escape, A::None, S::Ss3Entry, { C::Ss3Indicator });
+
+    // EscapeIntermediate
+    enterAll(S::EscapeIntermediate, A::EscDispatch, S::Ground);
+    stay(S::EscapeIntermediate, A::Execute, { C::C0, C::Bell });
+    stay(S::EscapeIntermediate, A::Collect, { C::Intermediate });
+    stay(S::EscapeIntermediate, A::Ignore, { C::Delete });
+
+    // CsiEntry
+    enterAll(S::CsiEntry, A::CsiDispatch, S::Ground);
+    stay(S::CsiEntry, A::Execute, { C::C0, C::Bell });
+    stay(S::CsiEntry, A::Ignore, { C::Delete });
+    enter(S::CsiEntry, A::Collect, S::CsiIntermediate, { C::Intermediate });
+    enter(S::CsiEntry, A::None, S::CsiIgnore, { C::Colon });
+    enter(S::CsiEntry, A::Param, S::CsiParam, { C::Digit, C::Semicolon });
+    enter(S::CsiEntry, A::Collect, S::CsiParam, { C::PrivateMarker });
+
+    // CsiIntermediate
+    enterAll(S::CsiIntermediate, A::CsiDispatch, S::Ground);
+    stay(S::CsiIntermediate, A::Execute, { C::C0, C::Bell });
+    stay(S::CsiIntermediate, A::Collect, { C::Intermediate });
+    stay(S::CsiIntermediate, A::Ignore, { C::Delete });
+    enter(S::CsiIntermediate, A::None, S::CsiIgnore, { C::Digit, C::Colon, C::Semicolon, C::PrivateMarker });
+
+    // CsiIgnore
+    enterAll(S::CsiIgnore, A::None, S::Ground);
+    stay(S::CsiIgnore, A::Execute, { C::C0, C::Bell });
+    stay(S::CsiIgnore, A::Ignore, { C::Delete, C::Intermediate, C::Digit, C::Colon, C::Semicolon, C::PrivateMarker });
+
+    // CsiParam
+    enterAll(S::CsiParam, A::CsiDispatch, S::Ground);
+    stay(S::CsiParam, A::Execute, { C::C0, C::Bell });
+    stay(S::CsiParam, A::Ignore, { C::Delete });
+    stay(S::CsiParam, A::Param, { C::Digit, C::Semicolon });
+    enter(S::CsiParam, A::Collect, S::CsiIntermediate, { C::Intermediate });
+    enter(S::CsiParam, A::None, S::CsiIgnore, { C::Colon, C::PrivateMarker });
+
+    // OscParam
+    stayAll(S::OscParam, A::Ignore);
+    enter(S::OscParam, A::None, S::Ground, { C::Bell, C::C1St });
+    stay(S::OscParam, A::OscParam, { C::Digit });
+    enter(S::OscParam, A::None, S::OscString, { C::Semicolon });
+
+    // OscString
+    stayAll(S::OscString, A::OscPut);
+    enter(S::OscString, A::OscDispatch, S::Ground, { C::Bell, C::C1St });
+    stay(S::OscString, A::Ignore, { C::C0 });
+
+    // OscTermination
+    enterAll(S::OscTermination, A::OscDispatch, S::Ground);
+
+    // Ss3Entry
+    enterAll(S::Ss3Entry, A::Ss3Dispatch, S::Ground);
+    stay(S::Ss3Entry, A::Execute, { C::C0, C::Bell });
+    stay(S::Ss3Entry, A::Ignore, { C::Delete });
+    // It's safe for us to go into the CSI ignore here, because both SS3 and
+    //      CSI sequences ignore characters the same way.
+    enter(S::Ss3Entry, A::None, S::CsiIgnore, { C::Colon });
+    enter(S::Ss3Entry, A::Param, S::Ss3Param, { C::Digit, C::Semicolon });
+
+    // Ss3Param
+    enterAll(S::Ss3Param, A::Ss3Dispatch, S::Ground);
+    stay(S::Ss3Param, A::Execute, { C::C0, C::Bell });
+    stay(S::Ss3Param, A::Ignore, { C::Delete });
+    stay(S::Ss3Param, A::Param, { C::Digit, C::Semicolon });
+    enter(S::Ss3Param, A::None, S::CsiIgnore, { C::Colon, C::PrivateMarker });
+
+    // "Anywhere" transitions. CAN and SUB abort any sequence, and ESC always
+    // starts a new one - except in the OSC string state, where it can be used
+    // to terminate the string.
+    for (size_t state = 0; state < table.size(); ++state)
+    {
+        table.at(state).at(static_cast<size_t>(C::Cancel)) = { A::Execute, true, S::Ground };
+        table.at(state).at(static_cast<size_t>(C::Escape)) = { A::None, true, S::Escape };
+    }
+    enter(S::OscString, A::None, S::OscTermination, { C::Escape });
+
+    return table;
+}
+
+const StateMachine::VTCharClassTable StateMachine::s_charClasses = StateMachine::_BuildCharClassTable();
+const StateMachine::VTTransitionTable StateMachine::s_transitions = StateMachine::_BuildTransitionTable();
+
+// Names of each of the states, used for tracing the events handled in them.
+static constexpr std::array<std::wstring_view, 12> s_stateNames{
+    L"Ground",
+    L"Escape",
+    L"EscapeIntermediate",
+    L"CsiEntry",
+    L"CsiIntermediate",
+    L"CsiIgnore",
+    L"CsiParam",
+    L"OscParam",
+    L"OscString",
+    L"OscTermination",
+    L"Ss3Entry",
+    L"Ss3Param",
+};
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the Ss3Entry state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
-//  SS3 sequences are structurally the same as CSI sequences, just with a
-//      different initiation. It's safe to reuse CSI's functions for
-//      determining if a character is a parameter, delimiter, or invalid.
+// - Moves the state machine into the given state, running its entry actions.
 // Arguments:
-// - wch - Character that triggered the event
+// - state - The state to enter.
 // Return Value:
 // - <none>
-void StateMachine::_EventSs3Entry(const wchar_t wch)
-{
-    _trace.TraceOnEvent(L"Ss3Entry");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
-    {
-        _ActionIgnore();
-    }
-    else if (_isCsiInvalid(wch))
-    {
-        // It's safe for us to go into the CSI ignore here, because both SS3 and
-        //      CSI sequences ignore characters the same way.
-        _EnterCsiIgnore();
-    }
-    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
-    {
-        _ActionParam(wch);
-        _EnterSs3Param();
-    }
-    else
-    {
-        _ActionSs3Dispatch(wch);
-        _EnterGround();
+void StateMachine::_EnterState(const VTStates state)
+{
+    switch (state)
+    {
+    case VTStates::Ground:
+        return _EnterGround();
+    case VTStates::Escape:
+        return _EnterEscape();
+    case VTStates::EscapeIntermediate:
+        return _EnterEscapeIntermediate();
+    case VTStates::CsiEntry:
+        return _EnterCsiEntry();
+    case VTStates::CsiIntermediate:
+        return _EnterCsiIntermediate();
+    case VTStates::CsiIgnore:
+        return _EnterCsiIgnore();
+    case VTStates::CsiParam:
+        return _EnterCsiParam();
+    case VTStates::OscParam:
+        return _EnterOscParam();
+    case VTStates::OscString:
+        return _EnterOscString();
+    case VTStates::OscTermination:
+        return _EnterOscTermination();
+    case VTStates::Ss3Entry:
+        return _EnterSs3Entry();
+    case VTStates::Ss3Param:
+        return _EnterSs3Param();
+    default:
+        return;
     }
 }
 
 // Routine Description:
-// - Processes a character event into an Action that occurs while in the CsiParam state.
-//   Events in this state will:
-//   1. Execute C0 control characters
-//   2. Ignore Delete characters
-//   3. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   4. Store parameter data
-//   5. Dispatch a control sequence with parameters for action
+// - Runs the given action from the state transition table.
 // Arguments:
-// - wch - Character that triggered the event
+// - action - The action to run.
+// - wch - Character that triggered the action
 // Return Value:
-// - <none>
-void StateMachine::_EventSs3Param(const wchar_t wch)
+// - True if the table's transition should be followed. False if the action already
+//   decided the next state on its own.
+bool StateMachine::_ActionFromTable(const VTActions action, const wchar_t wch)
 {
-    _trace.TraceOnEvent(L"Ss3Param");
-    if (_isC0Code(wch))
-    {
-        _ActionExecute(wch);
-    }
-    else if (_isDelete(wch))
+    switch (action)
     {
+    case VTActions::None:
+        break;
+    case VTActions::Ignore:
         _ActionIgnore();
-    }
-    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
-    {
+        break;
+    case VTActions::Execute:
+        _ActionExecute(wch);
+        break;
+    case VTActions::Print:
+        _ActionPrint(wch);
+        break;
+    case VTActions::Collect:
+        _ActionCollect(wch);
+        break;
+    case VTActions::Param:
         _ActionParam(wch);
-    }
-    else if (_isCsiInvalid(wch) || _isCsiPrivateMarker(wch))
-    {
-        _EnterCsiIgnore();
-    }
-    else
-    {
+        break;
+    case VTActions::EscDispatch:
+        _ActionEscDispatch(wch);
+        break;
+    case VTActions::CsiDispatch:
+        _ActionCsiDispatch(wch);
+        break;
+    case VTActions::OscParam:
+        _ActionOscParam(wch);
+        break;
+    case VTActions::OscPut:
+        _ActionOscPut(wch);
+        break;
+    case VTActions::OscDispatch:
+        _ActionOscDispatch(wch);
+        break;
+    case VTActions::Ss3Dispatch:
         _ActionSs3Dispatch(wch);
-        _EnterGround();
+        break;
+    case VTActions::EscapeExecute:
+        if (_engine->DispatchControlCharsFromEscape())
+        {
+            _ActionExecuteFromEscape(wch);
+            _EnterGround();
+        }
+        else
+        {
+            _ActionExecute(wch);
+        }
+        return false;
+    case VTActions::EscapeCollect:
+        if (_engine->DispatchIntermediatesFromEscape())
+        {
+            _ActionEscDispatch(wch);
+            _EnterGround();
+        }
+        else
+        {
+            _ActionCollect(wch);
+            _EnterEscapeIntermediate();
+        }
+        return false;
     }
+    return true;
 }
 
 // Routine Description:
@@ -1164,53 +1080,25 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
 {
     _trace.TraceCharInput(wch);
 
-    // Process "from anywhere" events first.
-    if (wch == AsciiChars::CAN ||
-        wch == AsciiChars::SUB)
+    const auto charClass = wch < s_charClasses.size() ? til::at(s_charClasses, wch) : VTCharClasses::Printable;
+    const auto& transition = til::at(til::at(s_transitions, static_cast<size_t>(_state)), static_cast<size_t>(charClass));
+
+    // The "from anywhere" events aren't handled by the current state, so they
+    //      aren't traced as one of its events.
+    const bool fromAnywhere = wch == AsciiChars::CAN ||
+                              wch == AsciiChars::SUB ||
+                              (_isEscape(wch) && _state != VTStates::OscString);
+    if (!fromAnywhere)
     {
-        _ActionExecute(wch);
-        _EnterGround();
+        _trace.TraceOnEvent(til::at(s_stateNames, static_cast<size_t>(_state)));
     }
-    else if (_isEscape(wch) && _state != VTStates::OscString)
+
+    if (_ActionFromTable(transition.action, wch) && transition.enter)
     {
-        // Don't go to escape from the OSC string state - ESC can be used to
-        //      terminate OSC strings.
-        _EnterEscape();
-    }
-    else
-    {
-        // Then pass to the current state as an event
-        switch (_state)
-        {
-        case VTStates::Ground:
-            return _EventGround(wch);
-        case VTStates::Escape:
-            return _EventEscape(wch);
-        case VTStates::EscapeIntermediate:
-            return _EventEscapeIntermediate(wch);
-        case VTStates::CsiEntry:
-            return _EventCsiEntry(wch);
-        case VTStates::CsiIntermediate:
-            return _EventCsiIntermediate(wch);
-        case VTStates::CsiIgnore:
-            return _EventCsiIgnore(wch);
-        case VTStates::CsiParam:
-            return _EventCsiParam(wch);
-        case VTStates::OscParam:
-            return _EventOscParam(wch);
-        case VTStates::OscString:
-            return _EventOscString(wch);
-        case VTStates::OscTermination:
-            return _EventOscTermination(wch);
-        case VTStates::Ss3Entry:
-            return _EventSs3Entry(wch);
-        case VTStates::Ss3Param:
-            return _EventSs3Param(wch);
-        default:
-            return;
-        }
+        _EnterState(transition.nextState);
     }
 }
+
 // Method Description:
 // - Pass the current string we're processing through to the engine. It may eat
 //      the string, it may write it straight to the input unmodified, it might
@@ -1267,14 +1155,15 @@ void StateMachine::ProcessString(const std::wstring_view string)
         }
         else
         {
-            if (_isActionableFromGround(string.at(current))) // If the current char is the start of an escape sequence, or should be executed in ground state...
+            // Skip over the whole printable run in one go, up to the next char that
+            // is the start of an escape sequence or should be executed in ground state.
+            current += _findActionableFromGround(string.substr(current));
+
+            if (current < string.size())
             {
-                if (!_run.empty())
+                if (current > start)
                 {
-                    // Because the _run above is composed INCLUDING current, we must
-                    // trim it off here since we just determined it's actionable
-                    // and only pass through everything before it.
-                    const auto allLeadingUpTo = _run.substr(0, _run.size() - 1);
+                    const auto allLeadingUpTo = string.substr(start, current - start);
 
                     _engine->ActionPrintString(allLeadingUpTo); // ... print all the chars leading up to it as part of the run...
                     _trace.DispatchPrintRunTrace(allLeadingUpTo);
@@ -1282,11 +1171,6 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
                 _processingIndividually = true; // begin processing future characters individually...
                 start = current;
-                continue;
-            }
-            else
-            {
-                ++current; // Otherwise, add this char to the current run to be printed.
             }
         }
     }
@@ -1368,6 +1252,100 @@ void StateMachine::ProcessString(const std::wstring_view string)
     }
 }
 
+// Routine Description:
+// - Returns how many bytes a UTF-8 sequence starting with the given byte takes up.
+// Arguments:
+// - lead - The first byte of the sequence.
+// Return Value:
+// - The length of the sequence, or 0 if the byte can't start a multi-byte sequence.
+static constexpr size_t _utf8SequenceLength(const char lead) noexcept
+{
+    const auto byte = static_cast<unsigned char>(lead);
+    if (byte >= 0xC2 && byte <= 0xDF)
+    {
+        return 2;
+    }
+    if (byte >= 0xE0 && byte <= 0xEF)
+    {
+        return 3;
+    }
+    if (byte >= 0xF0 && byte <= 0xF4)
+    {
+        return 4;
+    }
+    return 0;
+}
+
+static constexpr bool _isUtf8Continuation(const char byte) noexcept
+{
+    return (static_cast<unsigned char>(byte) & 0xC0) == 0x80;
+}
+
+// Routine Description:
+// - Helper for entry to the state machine with UTF-8 encoded text, like the bytes read from a pty.
+// - The bytes are decoded into a buffer that's reused from call to call and then processed
+//   like ProcessString, so printable runs reach ActionPrintString without another copy.
+// - A code point cut off at the end of the bytes is held back until the next call completes it.
+//   Ill-formed UTF-8 is replaced with U+FFFD the same way til::u8u16 does it.
+// Arguments:
+// - bytes - UTF-8 encoded characters to operate upon
+// Return Value:
+// - <none>
+void StateMachine::ProcessUtf8(const std::string_view bytes)
+{
+    auto input = bytes;
+
+    // Take as many continuation bytes as the code point from the previous call is missing.
+    if (_utf8PartialsLength != 0)
+    {
+        const auto length = _utf8SequenceLength(_utf8Partials.front());
+        while (_utf8PartialsLength < length && !input.empty() && _isUtf8Continuation(input.front()))
+        {
+            til::at(_utf8Partials, _utf8PartialsLength++) = input.front();
+            input.remove_prefix(1);
+        }
+
+        if (_utf8PartialsLength < length && input.empty())
+        {
+            // Still not complete. Wait for more.
+            return;
+        }
+    }
+
+    // Hold back a code point that's cut off at the end. Only the last 3 bytes can be part of one.
+    size_t partialLength = 0;
+    for (size_t back = 1; back <= std::min<size_t>(3, input.size()); ++back)
+    {
+        const auto byte = input.at(input.size() - back);
+        if (!_isUtf8Continuation(byte))
+        {
+            if (_utf8SequenceLength(byte) > back)
+            {
+                partialLength = back;
+            }
+            break;
+        }
+    }
+
+    // Decoding never yields more UTF-16 code units than there are UTF-8 code units.
+    const auto complete = input.substr(0, input.size() - partialLength);
+    _utf8Buffer.resize(_utf8PartialsLength + complete.size());
+
+    size_t decoded = 0;
+    if (_utf8PartialsLength != 0)
+    {
+        decoded += til::details::u8u16transcode({ _utf8Partials.data(), _utf8PartialsLength }, _utf8Buffer.data());
+        _utf8PartialsLength = 0;
+    }
+#pragma warning(suppress : 26481) // Don't use pointer arithmetic. The buffer was sized for both parts above.
+    decoded += til::details::u8u16transcode(complete, _utf8Buffer.data() + decoded);
+
+    std::copy(input.cend() - partialLength, input.cend(), _utf8Partials.begin());
+    _utf8PartialsLength = partialLength;
+
+    ProcessString({ _utf8Buffer.data(), decoded });
+}
+
 // Routine Description:
 // - Wherever the state machine is, whatever it's going, go back to ground.
 //     This is used by conhost to "jiggle the handle" - when VT support is
@@ -17,6 +17,7 @@ Abstract:
 #include "IStateMachineEngine.hpp"
 #include "telemetry.hpp"
 #include "tracing.hpp"
+#include <array>
 #include <memory>
 
 namespace Microsoft::Console::VirtualTerminal
@@ -29,10 +30,20 @@ namespace Microsoft::Console::VirtualTerminal
 #endif
 
     public:
+        // DEC STD 070 only requires 16 parameters, but we allow twice that so that
+        // sequences like SGR with several extended colors still fit. Parameters
+        // beyond this limit are ignored.
+        static constexpr size_t MaxParameterCount = 32;
+
+        // A valid sequence never has more than a couple of intermediates. Extra ones are
+        // dropped, and since no engine accepts that many the sequence turns into a no-op.
+        static constexpr size_t MaxIntermediateCount = 4;
+
         StateMachine(std::unique_ptr<IStateMachineEngine> engine);
 
         void ProcessCharacter(const wchar_t wch);
         void ProcessString(const std::wstring_view string);
+        void ProcessUtf8(const std::string_view bytes);
 
         void ResetState() noexcept;
 
@@ -70,19 +81,6 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterSs3Entry();
         void _EnterSs3Param() noexcept;
 
-        void _EventGround(const wchar_t wch);
-        void _EventEscape(const wchar_t wch);
-        void _EventEscapeIntermediate(const wchar_t wch);
-        void _EventCsiEntry(const wchar_t wch);
-        void _EventCsiIntermediate(const wchar_t wch);
-        void _EventCsiIgnore(const wchar_t wch);
-        void _EventCsiParam(const wchar_t wch);
-        void _EventOscParam(const wchar_t wch);
-        void _EventOscString(const wchar_t wch);
-        void _EventOscTermination(const wchar_t wch);
-        void _EventSs3Entry(const wchar_t wch);
-        void _EventSs3Param(const wchar_t wch);
-
         void _AccumulateTo(const wchar_t wch, size_t& value);
 
         enum class VTStates
@@ -101,6 +99,73 @@ namespace Microsoft::Console::VirtualTerminal
             Ss3Param
         };
 
+        // Characters are grouped into classes that behave identically in every
+        // state, so the transition table only needs one column per class.
+        enum class VTCharClasses
+        {
+            C0,
+            Bell,
+            Cancel,
+            Escape,
+            Intermediate,
+            Digit,
+            Colon,
+            Semicolon,
+            PrivateMarker,
+            CsiIndicator,
+            OscIndicator,
+            Ss3Indicator,
+            Printable,
+            Delete,
+            C1Csi,
+            C1St
+        };
+
+        enum class VTActions
+        {
+            None,
+            Ignore,
+            Execute,
+            Print,
+            Collect,
+            Param,
+            EscDispatch,
+            CsiDispatch,
+            OscParam,
+            OscPut,
+            OscDispatch,
+            Ss3Dispatch,
+            // The Escape state defers to the engine to decide whether these
+            // dispatch immediately or continue the sequence.
+            EscapeExecute,
+            EscapeCollect
+        };
+
+        struct VTTransition
+        {
+            VTActions action;
+            bool enter;
+            VTStates nextState;
+        };
+
+        static constexpr size_t s_stateCount = static_cast<size_t>(VTStates::Ss3Param) + 1;
+        static constexpr size_t s_charClassCount = static_cast<size_t>(VTCharClasses::C1St) + 1;
+
+        // Every character up to and including the C1 range has its class looked up,
+        // anything above that is printable.
+        using VTCharClassTable = std::array<VTCharClasses, 0xA0>;
+        using VTTransitionTable = std::array<std::array<VTTransition, s_charClassCount>, s_stateCount>;
+
+        static constexpr VTCharClasses _ClassifyCharacter(const wchar_t wch) noexcept;
+        static constexpr VTCharClassTable _BuildCharClassTable() noexcept;
+        static constexpr VTTransitionTable _BuildTransitionTable() noexcept;
+
+        static const VTCharClassTable s_charClasses;
+        static const VTTransitionTable s_transitions;
+
+        void _EnterState(const VTStates state);
+        bool _ActionFromTable(const VTActions action, const wchar_t wch);
+
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
 
         std::unique_ptr<IStateMachineEngine> _engine;
@@ -109,8 +174,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::wstring_view _run;
 
-        std::vector<wchar_t> _intermediates;
-        std::vector<size_t> _parameters;
+        til::some<wchar_t, MaxIntermediateCount> _intermediates;
+        til::some<size_t, MaxParameterCount> _parameters;
+        bool _parameterLimitReached;
 
         std::wstring _oscString;
         size_t _oscParameter;
@@ -118,5 +184,13 @@ namespace Microsoft::Console::VirtualTerminal
         // This is tracked per state machine instance so that separate calls to Process*
         //   can start and finish a sequence.
         bool _processingIndividually;
+
+        // UTF-8 input is decoded into this buffer, which is kept between calls so that
+        // it only grows to the largest chunk seen instead of being allocated for each one.
+        std::wstring _utf8Buffer;
+
+        // The bytes of a code point that was cut off at the end of the previous UTF-8 chunk.
+        std::array<char, 4> _utf8Partials;
+        size_t _utf8PartialsLength;
     };
 }
@@ -312,6 +312,52 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestCsiMaxParamCount)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Output a sequence with 100 parameters");
+        mach.ProcessCharacter(AsciiChars::ESC);
+        mach.ProcessCharacter(L'[');
+        for (size_t i = 0; i < 100; i++)
+        {
+            if (i > 0)
+            {
+                mach.ProcessCharacter(L';');
+            }
+            mach.ProcessCharacter(static_cast<wchar_t>(L'0' + i % 10));
+        }
+
+        Log::Comment(L"Only the first MaxParameterCount are kept, the rest are ignored");
+        VERIFY_ARE_EQUAL(StateMachine::MaxParameterCount, mach._parameters.size());
+        for (size_t i = 0; i < mach._parameters.size(); i++)
+        {
+            VERIFY_ARE_EQUAL(i % 10, mach._parameters.at(i));
+        }
+        mach.ProcessCharacter(L'J');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
+    TEST_METHOD(TestCsiMaxIntermediateCount)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        mach.ProcessCharacter(AsciiChars::ESC);
+        mach.ProcessCharacter(L'[');
+        for (size_t i = 0; i < 10; i++)
+        {
+            mach.ProcessCharacter(L'$');
+            VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIntermediate);
+        }
+        VERIFY_ARE_EQUAL(StateMachine::MaxIntermediateCount, mach._intermediates.size());
+        mach.ProcessCharacter(L'p');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
     TEST_METHOD(TestCsiIgnore)
     {
         auto dispatch = std::make_unique<DummyDispatch>();
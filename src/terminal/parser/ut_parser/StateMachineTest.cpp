@@ -111,6 +111,9 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(PassThroughUnhandled);
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
+    TEST_METHOD(PrintRunStopsAtActionableCharacter);
+    TEST_METHOD(Utf8PrintsAndDispatches);
+    TEST_METHOD(Utf8CarriesPartialsBetweenCalls);
 };
 
 void StateMachineTest::TwoStateMachinesDoNotInterfereWithEachother()
@@ -182,3 +185,78 @@ void StateMachineTest::BulkTextPrint()
     // Then ensure the entire buffered run was printed all at once back to us.
     VERIFY_ARE_EQUAL(String(L"12345 Hello World"), String(engine.printed.c_str()));
 }
+
+void StateMachineTest::PrintRunStopsAtActionableCharacter()
+{
+    // Printable runs are scanned several characters at a time, so make sure the run
+    // is cut at exactly the right place wherever the actionable character lands.
+    const std::wstring_view actionable{ L"\x1b\r\x7f\x9b\x0", 5 };
+    const std::wstring printable{ L"abcdefgh \x80\x9a\x9c\x209b\xff9b\xffff!~\x20\x21\x7e\xe9\x4e2d" };
+
+    for (const auto wch : actionable)
+    {
+        for (size_t offset = 0; offset <= printable.size(); ++offset)
+        {
+            auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+            // this dance is required because StateMachine presumes to take ownership of its engine.
+            auto& engine{ *enginePtr.get() };
+            StateMachine machine{ std::move(enginePtr) };
+
+            auto input = printable.substr(0, offset);
+            input.push_back(wch);
+            machine.ProcessString(input);
+
+            VERIFY_ARE_EQUAL(String(printable.substr(0, offset).c_str()), String(engine.printed.c_str()));
+        }
+    }
+}
+
+void StateMachineTest::Utf8PrintsAndDispatches()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // o with diaeresis, the euro sign and a CJK ideograph outside of the BMP, then a sequence.
+    machine.ProcessUtf8("\xC3\xB6\xE2\x82\xAC\xF0\xA4\xBD\x9C\x1b[12;34m");
+    VERIFY_ARE_EQUAL(String(L"\x00f6\x20ac\xd853\xdf5c"), String(engine.printed.c_str()));
+    VERIFY_ARE_EQUAL((std::vector<size_t>{ 12u, 34u }), engine.csiParams);
+
+    // Ill-formed input is replaced, not dropped.
+    machine.ProcessUtf8("a\xFF" "b");
+    VERIFY_ARE_EQUAL(String(L"a\xfffd" L"b"), String(engine.printed.c_str()));
+}
+
+void StateMachineTest::Utf8CarriesPartialsBetweenCalls()
+{
+    const std::string_view text{ "x\xE2\x82\xAC\xF0\xA4\xBD\x9Cy" };
+    const std::wstring expected{ L"x\x20ac\xd853\xdf5cy" };
+
+    // Split the bytes at every position and make sure the halves make up the same text.
+    for (size_t split = 0; split <= text.size(); ++split)
+    {
+        auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+        auto& engine{ *enginePtr.get() };
+        StateMachine machine{ std::move(enginePtr) };
+
+        machine.ProcessUtf8(text.substr(0, split));
+        auto printed = engine.printed;
+        engine.printed.clear();
+
+        machine.ProcessUtf8(text.substr(split));
+        printed += engine.printed;
+
+        VERIFY_ARE_EQUAL(String(expected.c_str()), String(printed.c_str()));
+    }
+
+    // A code point that never gets completed turns into U+FFFD once something else follows.
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    machine.ProcessUtf8("\xE2\x82");
+    VERIFY_ARE_EQUAL(0u, engine.printed.size());
+    machine.ProcessUtf8("z");
+    VERIFY_ARE_EQUAL(String(L"\xfffdz"), String(engine.printed.c_str()));
+}
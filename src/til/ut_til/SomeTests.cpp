@@ -125,6 +125,21 @@ class SomeTests
         VERIFY_THROWS(s.push_back(12), std::out_of_range);
     }
 
+    TEST_METHOD(Clear)
+    {
+        til::some<int, 2> s;
+        s.push_back(12);
+        s.push_back(24);
+        VERIFY_ARE_EQUAL(2u, s.size());
+
+        s.clear();
+        VERIFY_IS_TRUE(s.empty());
+
+        s.push_back(36);
+        VERIFY_ARE_EQUAL(1u, s.size());
+        VERIFY_ARE_EQUAL(36, s[0]);
+    }
+
     TEST_METHOD(Empty)
     {
         til::some<int, 2> s;
@@ -159,6 +174,11 @@ class SomeTests
 
         VERIFY_ARE_EQUAL(one, s.front());
         VERIFY_ARE_EQUAL(two, s.back());
+
+        const auto three = 3;
+        s.back() = three;
+        VERIFY_ARE_EQUAL(three, s.back());
+        VERIFY_ARE_EQUAL(three, s[1]);
     }
 
     TEST_METHOD(Indexing)
@@ -16,6 +16,8 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU16ToU8);
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
+    TEST_METHOD(TestU8ToU16AcrossBlocks);
+    TEST_METHOD(TestU8ToU16Invalid);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -110,6 +112,48 @@ void Utf8Utf16ConvertTests::TestU8ToU16Partials()
     VERIFY_ARE_EQUAL(u16StringComp, u16Out2);
 }
 
+void Utf8Utf16ConvertTests::TestU8ToU16AcrossBlocks()
+{
+    // ASCII is converted in blocks. Move a few multi-byte characters across every position
+    // of a block to make sure that the conversion picks up right where the ASCII ends.
+    const std::string multiByte{ "\xC3\xB6\xE2\x82\xAC\xF0\xA4\xBD\x9C" };
+    const std::wstring multiByteComp{ L"\x00f6\x20ac\xd853\xdf5c" };
+
+    for (size_t offset = 0; offset < 40; ++offset)
+    {
+        const auto u8String = std::string(offset, 'a') + multiByte + std::string(40, 'z');
+        const auto u16StringComp = std::wstring(offset, L'a') + multiByteComp + std::wstring(40, L'z');
+
+        std::wstring u16Out{};
+        const HRESULT hRes{ til::u8u16(u8String, u16Out) };
+        VERIFY_ARE_EQUAL(S_OK, hRes);
+        VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+    }
+}
+
+void Utf8Utf16ConvertTests::TestU8ToU16Invalid()
+{
+    // Each maximal subpart of an ill-formed sequence becomes one U+FFFD.
+    const std::vector<std::pair<std::string, std::wstring>> testData{
+        { "\xC0\x80", L"\xfffd\xfffd" }, // overlong NUL, C0 can't start a sequence
+        { "\xE0\x80", L"\xfffd\xfffd" }, // overlong, 80 can't follow E0
+        { "\xE2\x82" "A", L"\xfffd" L"A" }, // truncated EURO SIGN
+        { "\xED\xA0\x80", L"\xfffd\xfffd\xfffd" }, // encoded surrogate
+        { "\xF4\x90\x80\x80", L"\xfffd\xfffd\xfffd\xfffd" }, // beyond U+10FFFF
+        { "\xF0\xA4\xBD" "a", L"\xfffd" L"a" }, // truncated 4 byte sequence
+        { "\x80\xBF", L"\xfffd\xfffd" }, // continuation bytes without a lead byte
+        { "\xFE\xFF", L"\xfffd\xfffd" }, // never valid in UTF-8
+    };
+
+    for (const auto& [u8String, u16StringComp] : testData)
+    {
+        std::wstring u16Out{};
+        const HRESULT hRes{ til::u8u16(u8String, u16Out) };
+        VERIFY_ARE_EQUAL(S_OK, hRes);
+        VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+    }
+}
+
 void Utf8Utf16ConvertTests::TestU16ToU8Partials()
 {
     const std::wstring u16String1{
@@ -0,0 +1,184 @@
+﻿// TEST TOOL U8U16Test
+// Performance tests for the conversions and measurements the console itself uses on text, timed over
+// the natural language samples next to this file. Unlike the functions in U8U16Test.cpp, these are
+// the til::u8u16 and CodepointWidthDetector implementations that ship.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <wil/common.h>
+#include <wil/result.h>
+#include <gsl/gsl>
+
+#include "til/u8u16convert.h"
+#include "CodepointWidthDetector.hpp"
+
+// helper functions, see main.cpp
+double GetDuration();
+void PrintHeader(const char* const funcName);
+
+// CodepointWidthDetector is linked from the types library, which sends these through the
+// ServiceLocator. There's no console here, so call the platform functions directly.
+UINT VTRedirMapVirtualKeyW(_In_ UINT uCode, _In_ UINT uMapType)
+{
+    return MapVirtualKeyW(uCode, uMapType);
+}
+
+SHORT VTRedirVkKeyScanW(_In_ WCHAR ch)
+{
+    return VkKeyScanW(ch);
+}
+
+SHORT VTRedirGetKeyState(_In_ int nVirtKey)
+{
+    return GetKeyState(nVirtKey);
+}
+
+// returns the content of the file, repeated count times
+static std::string LoadCorpus(const std::string& fileName, size_t count)
+{
+    std::ostringstream u8Ss{};
+    std::ostringstream buf{};
+    buf << std::ifstream{ fileName }.rdbuf();
+    std::fill_n(std::ostream_iterator<const char*>{ u8Ss }, count, buf.str().c_str());
+    return u8Ss.str();
+}
+
+void CompTilNaturalLang_WholeString(const std::string& fileName)
+{
+    std::string head{ __func__ };
+    head += " - " + fileName;
+    PrintHeader(head.c_str());
+    const std::string u8Str{ LoadCorpus(fileName, 300000u) };
+
+    GetDuration();
+    std::unique_ptr<wchar_t[]> u16Buffer{ std::make_unique<wchar_t[]>(u8Str.length()) };
+    const int length = MultiByteToWideChar(CP_UTF8, 0, u8Str.data(), static_cast<int>(u8Str.length()), u16Buffer.get(), static_cast<int>(u8Str.length()));
+    double duration = GetDuration();
+    u16Buffer.reset();
+    std::cout << " MultiByteToWideChar length " << length << " elapsed " << duration << std::endl;
+
+    GetDuration();
+    std::wstring u16Str{};
+    const HRESULT hRes = til::u8u16(u8Str, u16Str);
+    duration = GetDuration();
+    std::cout << " til::u8u16          length " << u16Str.length() << " elapsed " << duration << " HRESULT " << hRes << std::endl;
+}
+
+void CompTilNaturalLang_Chunks(const std::string& fileName)
+{
+    std::string head{ __func__ };
+    head += " - " + fileName;
+    PrintHeader(head.c_str());
+    const std::string u8Str{ LoadCorpus(fileName, 300000u) };
+
+    // Conpty gets its input in whatever pieces the pipe hands over, so the chunks are cut at a
+    // fixed number of bytes. A chunk may end in the middle of a code point, which is why the
+    // platform function gets its own chunks, cut at code point boundaries.
+    constexpr const size_t chunkSize{ 16u };
+    std::vector<std::string_view> wholeCodePoints{};
+    for (size_t idx = 0u; idx < u8Str.length();)
+    {
+        size_t end = std::min(idx + chunkSize, u8Str.length());
+        while (end < u8Str.length() && (static_cast<unsigned char>(u8Str[end]) & 0b11'000000) == 0b10'000000)
+        {
+            ++end;
+        }
+        wholeCodePoints.emplace_back(&u8Str[idx], end - idx);
+        idx = end;
+    }
+
+    int lenTotalMB2WC{};
+    size_t lenTotalU8U16{};
+    size_t lenTotalU8U16State{};
+    double durTotalMB2WC{};
+    double durTotalU8U16{};
+    double durTotalU8U16State{};
+
+    GetDuration();
+    std::unique_ptr<wchar_t[]> u16Buffer{ std::make_unique<wchar_t[]>(chunkSize * 2) };
+    durTotalMB2WC += GetDuration();
+
+    for (const auto chunk : wholeCodePoints)
+    {
+        GetDuration();
+        lenTotalMB2WC += MultiByteToWideChar(CP_UTF8, 0, chunk.data(), static_cast<int>(chunk.length()), u16Buffer.get(), static_cast<int>(chunkSize * 2));
+        durTotalMB2WC += GetDuration();
+    }
+
+    GetDuration();
+    std::wstring u16StrOut{};
+    durTotalU8U16 += GetDuration();
+
+    for (const auto chunk : wholeCodePoints)
+    {
+        GetDuration();
+        LOG_IF_FAILED(til::u8u16(chunk, u16StrOut));
+        durTotalU8U16 += GetDuration();
+        lenTotalU8U16 += u16StrOut.length();
+    }
+
+    GetDuration();
+    til::u8state state{};
+    durTotalU8U16State += GetDuration();
+
+    for (size_t idx = 0u; idx < u8Str.length(); idx += chunkSize)
+    {
+        const std::string_view chunk{ &u8Str[idx], std::min(chunkSize, u8Str.length() - idx) };
+        GetDuration();
+        LOG_IF_FAILED(til::u8u16(chunk, u16StrOut, state));
+        durTotalU8U16State += GetDuration();
+        lenTotalU8U16State += u16StrOut.length();
+    }
+
+    std::cout << " MultiByteToWideChar        length " << lenTotalMB2WC << " elapsed " << durTotalMB2WC << std::endl;
+    std::cout << " til::u8u16                 length " << lenTotalU8U16 << " elapsed " << durTotalU8U16 << std::endl;
+    std::cout << " til::u8u16 with u8state    length " << lenTotalU8U16State << " elapsed " << durTotalU8U16State << std::endl;
+}
+
+void CompColumnWidths(const std::string& fileName)
+{
+    std::string head{ __func__ };
+    head += " - " + fileName;
+    PrintHeader(head.c_str());
+    const std::wstring u16Str{ til::u8u16(LoadCorpus(fileName, 30000u)) };
+    const CodepointWidthDetector widthDetector{};
+
+    // one lookup for each code point, the way the text buffer asked before GetColumnWidths existed
+    GetDuration();
+    size_t columnsEach{};
+    for (size_t i = 0u; i < u16Str.length(); ++i)
+    {
+        std::wstring_view glyph{ &u16Str[i], 1u };
+        if (IS_HIGH_SURROGATE(u16Str[i]) && i + 1u < u16Str.length() && IS_LOW_SURROGATE(u16Str[i + 1u]))
+        {
+            glyph = { &u16Str[i], 2u };
+            ++i;
+        }
+        columnsEach += widthDetector.IsWide(glyph) ? 2u : 1u;
+    }
+    double duration = GetDuration();
+    std::cout << " IsWide per code point columns " << columnsEach << " elapsed " << duration << std::endl;
+
+    GetDuration();
+    std::vector<BYTE> widths{};
+    const size_t columns = widthDetector.GetColumnWidths(u16Str, widths);
+    duration = GetDuration();
+    std::cout << " GetColumnWidths       columns " << columns << " elapsed " << duration << std::endl;
+}
@@ -35,6 +35,11 @@ double GetDuration();
 ptrdiff_t RandomIndex(ptrdiff_t length);
 void PrintHeader(const char* const funcName);
 
+// test functions of the implementations the console uses, see TilTest.cpp
+void CompTilNaturalLang_WholeString(const std::string& fileName);
+void CompTilNaturalLang_Chunks(const std::string& fileName);
+void CompColumnWidths(const std::string& fileName);
+
 // test functions
 void WideCharToMultiByte_WholeString(std::wstring_view testU16)
 {
@@ -519,6 +524,25 @@ int main()
     CompNaturalLang_Chunks("ru.txt");
     CompNaturalLang_Chunks("zh.txt");
 
+    std::cout << "\n\n### til::u8u16 ###" << std::endl;
+
+    CompTilNaturalLang_WholeString("en.txt");
+    CompTilNaturalLang_WholeString("fr.txt");
+    CompTilNaturalLang_WholeString("ru.txt");
+    CompTilNaturalLang_WholeString("zh.txt");
+
+    CompTilNaturalLang_Chunks("en.txt");
+    CompTilNaturalLang_Chunks("fr.txt");
+    CompTilNaturalLang_Chunks("ru.txt");
+    CompTilNaturalLang_Chunks("zh.txt");
+
+    std::cout << "\n\n### Column Widths ###" << std::endl;
+
+    CompColumnWidths("en.txt");
+    CompColumnWidths("fr.txt");
+    CompColumnWidths("ru.txt");
+    CompColumnWidths("zh.txt");
+
     FreeLibrary(ntdll);
     return 0;
 }
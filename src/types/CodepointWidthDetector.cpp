@@ -14,11 +14,6 @@ namespace
         CodepointWidth width;
     };
 
-    static bool operator<(const UnicodeRange& range, const unsigned int searchTerm) noexcept
-    {
-        return range.upperBound < searchTerm;
-    }
-
     static constexpr std::array<UnicodeRange, 285> s_wideAndAmbiguousTable{
         // generated from http://www.unicode.org/Public/UCD/latest/ucd/EastAsianWidth.txt
         // anything not present here is presumed to be Narrow.
@@ -308,6 +303,133 @@ namespace
         UnicodeRange{ 0xf0000, 0xffffd, CodepointWidth::Ambiguous },
         UnicodeRange{ 0x100000, 0x10fffd, CodepointWidth::Ambiguous }
     };
+
+    // The ranges above are expanded at compile time into a two stage table, so a lookup is
+    // two array reads instead of a binary search. The codepoints are split into pages of 256.
+    // The first stage maps each page to a leaf, the second stage holds the width of every
+    // codepoint in a leaf, 2 bits each. Most pages have the same width throughout, so they
+    // all share one of three uniform leaves and only the pages where ranges start or end
+    // get a leaf of their own.
+    static constexpr unsigned int s_pageShift = 8;
+    static constexpr unsigned int s_codepointsPerPage = 1u << s_pageShift;
+    static constexpr unsigned int s_pageCount = 0x110000 >> s_pageShift;
+    static constexpr uint16_t s_uniformLeafCount = 3; // one each for Narrow, Wide and Ambiguous
+    static constexpr uint16_t s_mixedPage = 0xffff;
+
+    using WidthLeaf = std::array<uint8_t, s_codepointsPerPage / 4>;
+
+    // Returns the width for pages that only hold codepoints of one width
+    // and s_mixedPage for the others.
+    constexpr std::array<uint16_t, s_pageCount> classifyPages() noexcept
+    {
+        std::array<uint16_t, s_pageCount> pages{}; // Narrow until a range says otherwise
+        for (const auto& range : s_wideAndAmbiguousTable)
+        {
+            for (auto page = range.lowerBound >> s_pageShift; page <= range.upperBound >> s_pageShift; ++page)
+            {
+                const auto first = page << s_pageShift;
+                const auto last = first + s_codepointsPerPage - 1;
+                const auto covered = range.lowerBound <= first && range.upperBound >= last;
+                pages[page] = covered ? static_cast<uint16_t>(range.width) : s_mixedPage;
+            }
+        }
+        return pages;
+    }
+
+    constexpr size_t countMixedPages() noexcept
+    {
+        const auto pages = classifyPages();
+        size_t count = 0;
+        for (const auto page : pages)
+        {
+            if (page == s_mixedPage)
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    struct WidthTable final
+    {
+        std::array<uint16_t, s_pageCount> pages;
+        std::array<WidthLeaf, s_uniformLeafCount + countMixedPages()> leaves;
+    };
+
+    constexpr WidthTable generateWidthTable() noexcept
+    {
+        WidthTable table{};
+
+        for (uint16_t width = 0; width < s_uniformLeafCount; ++width)
+        {
+            for (size_t i = 0; i < table.leaves[width].size(); ++i)
+            {
+                table.leaves[width][i] = static_cast<uint8_t>(width * 0b01010101);
+            }
+        }
+
+        table.pages = classifyPages();
+        auto nextLeaf = s_uniformLeafCount;
+        for (auto& page : table.pages)
+        {
+            if (page == s_mixedPage)
+            {
+                page = nextLeaf++;
+            }
+        }
+
+        // Mixed leaves start out Narrow. Fill in the part of each range that falls on one of them.
+        for (const auto& range : s_wideAndAmbiguousTable)
+        {
+            for (auto page = range.lowerBound >> s_pageShift; page <= range.upperBound >> s_pageShift; ++page)
+            {
+                const auto leaf = table.pages[page];
+                if (leaf < s_uniformLeafCount)
+                {
+                    continue;
+                }
+
+                const auto first = std::max(range.lowerBound, page << s_pageShift);
+                const auto last = std::min(range.upperBound, (page << s_pageShift) + s_codepointsPerPage - 1);
+                for (auto codepoint = first; codepoint <= last; ++codepoint)
+                {
+                    const auto index = (codepoint & (s_codepointsPerPage - 1)) >> 2;
+                    const auto shift = (codepoint & 3) * 2;
+                    table.leaves[leaf][index] |= static_cast<uint8_t>(static_cast<unsigned int>(range.width) << shift);
+                }
+            }
+        }
+
+        return table;
+    }
+
+    static constexpr WidthTable s_widthTable = generateWidthTable();
+
+    constexpr CodepointWidth lookupWidth(const unsigned int codepoint) noexcept
+    {
+        if (codepoint >= s_pageCount << s_pageShift)
+        {
+            return CodepointWidth::Narrow;
+        }
+
+        const auto& leaf = s_widthTable.leaves[s_widthTable.pages[codepoint >> s_pageShift]];
+        const auto bits = leaf[(codepoint & (s_codepointsPerPage - 1)) >> 2] >> ((codepoint & 3) * 2);
+        return static_cast<CodepointWidth>(bits & 3);
+    }
+
+    static_assert(lookupWidth(0x41) == CodepointWidth::Narrow);
+    static_assert(lookupWidth(0xa1) == CodepointWidth::Ambiguous);
+    static_assert(lookupWidth(0x3000) == CodepointWidth::Wide);
+    static_assert(lookupWidth(0x2fffd) == CodepointWidth::Wide);
+    static_assert(lookupWidth(0x2fffe) == CodepointWidth::Narrow);
+    static_assert(lookupWidth(0x10fffd) == CodepointWidth::Ambiguous);
+
+    // Whether the glyph is exactly one codepoint, as opposed to a codepoint followed by modifiers.
+    constexpr bool isSingleCodepoint(const std::wstring_view glyph) noexcept
+    {
+        return glyph.size() == 1 ||
+               (glyph.size() == 2 && IS_HIGH_SURROGATE(glyph.front()) && IS_LOW_SURROGATE(glyph.back()));
+    }
 }
 
 // Routine Description:
@@ -331,17 +453,7 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
         return CodepointWidth::Invalid;
     }
 
-    const auto codepoint = _extractCodepoint(glyph);
-    const auto it = std::lower_bound(s_wideAndAmbiguousTable.begin(), s_wideAndAmbiguousTable.end(), codepoint);
-
-    // For characters that are not _in_ the table, lower_bound will return the nearest item that is.
-    // We must check its bounds to make sure that our hit was a true hit.
-    if (it != s_wideAndAmbiguousTable.end() && codepoint >= it->lowerBound && codepoint <= it->upperBound)
-    {
-        return it->width;
-    }
-
-    return CodepointWidth::Narrow;
+    return lookupWidth(_extractCodepoint(glyph));
 }
 
 // Routine Description:
@@ -405,6 +517,53 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
     }
 }
 
+// Routine Description:
+// - measures how many columns each character of a string takes up, in one pass.
+// - this gives the same answers as calling IsWide on each codepoint of the text.
+// Arguments:
+// - text - the utf16 encoded text to measure
+// - widths - on output, holds one entry for each code unit of text: 1 or 2 for the
+//            first code unit of each codepoint and 0 for the trailing half of a surrogate pair.
+// Return Value:
+// - the number of columns the whole text takes up
+size_t CodepointWidthDetector::GetColumnWidths(const std::wstring_view text, std::vector<BYTE>& widths) const
+{
+    widths.clear();
+    widths.reserve(text.size());
+
+    size_t columns = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const auto wch = til::at(text, i);
+
+        // Printable ASCII is always narrow. Don't bother with the lookups for it.
+        if (wch >= 0x20 && wch <= 0x7e)
+        {
+            widths.push_back(1);
+            ++columns;
+            continue;
+        }
+
+        auto glyph = text.substr(i, 1);
+        if (IS_HIGH_SURROGATE(wch) && i + 1 < text.size() && IS_LOW_SURROGATE(til::at(text, i + 1)))
+        {
+            glyph = text.substr(i, 2);
+        }
+
+        const BYTE width = IsWide(glyph) ? 2 : 1;
+        widths.push_back(width);
+        columns += width;
+
+        if (glyph.size() == 2)
+        {
+            widths.push_back(0);
+            ++i;
+        }
+    }
+
+    return columns;
+}
+
 // Routine Description:
 // - checks if codepoint is wide using fallback methods.
 // Arguments:
@@ -448,20 +607,22 @@ bool CodepointWidthDetector::_lookupIsWide(const std::wstring_view glyph) const
 // - true if codepoint is wide or false if it is narrow
 bool CodepointWidthDetector::_checkFallbackViaCache(const std::wstring_view glyph) const
 {
-    const std::wstring findMe{ glyph };
-
-    // TODO: Cache needs to be emptied when font changes.
-    const auto it = _fallbackCache.find(findMe);
-    if (it == _fallbackCache.end())
+    // The cache is keyed by codepoint. A glyph with modifiers after its codepoint could
+    // measure differently than the codepoint alone, and is rare enough to just ask every time.
+    if (!isSingleCodepoint(glyph))
     {
-        auto result = _pfnFallbackMethod(glyph);
-        _fallbackCache.insert_or_assign(findMe, result);
-        return result;
+        return _pfnFallbackMethod(glyph);
     }
-    else
+
+    const auto codepoint = _extractCodepoint(glyph);
+    if (const auto cached = _fallbackCache.Find(codepoint))
     {
-        return it->second;
+        return cached.value();
     }
+
+    const auto result = _pfnFallbackMethod(glyph);
+    _fallbackCache.Insert(codepoint, result);
+    return result;
 }
 
 // Routine Description:
@@ -514,5 +675,99 @@ void CodepointWidthDetector::SetFallbackMethod(std::function<bool(const std::wst
 // - <none>
 void CodepointWidthDetector::NotifyFontChanged() const noexcept
 {
-    _fallbackCache.clear();
+    _fallbackCache.Clear();
+}
+
+CodepointWidthDetector::FallbackCache::FallbackCache() noexcept :
+    _slots{},
+    _size{ 0 }
+{
+}
+
+// Routine Description:
+// - looks up what the fallback said about a codepoint
+// Arguments:
+// - codepoint - the codepoint to look for
+// Return Value:
+// - whether the codepoint is wide, or nullopt if the cache doesn't know it
+std::optional<bool> CodepointWidthDetector::FallbackCache::Find(const unsigned int codepoint) const noexcept
+{
+    if (_slots.empty())
+    {
+        return std::nullopt;
+    }
+
+    // The cache is never more than half full, so there's always an empty slot to stop at.
+    const auto mask = _slots.size() - 1;
+    for (auto i = codepoint & mask;; i = (i + 1) & mask)
+    {
+        const auto& slot = til::at(_slots, i);
+        if (slot.codepoint == codepoint)
+        {
+            return slot.wide;
+        }
+        if (slot.codepoint == s_emptySlot)
+        {
+            return std::nullopt;
+        }
+    }
+}
+
+// Routine Description:
+// - remembers what the fallback said about a codepoint
+// Arguments:
+// - codepoint - the codepoint that was measured
+// - wide - whether it was wide
+void CodepointWidthDetector::FallbackCache::Insert(const unsigned int codepoint, const bool wide)
+{
+    if ((_size + 1) * 2 > _slots.size())
+    {
+        _grow();
+    }
+
+    const auto mask = _slots.size() - 1;
+    for (auto i = codepoint & mask;; i = (i + 1) & mask)
+    {
+        auto& slot = til::at(_slots, i);
+        if (slot.codepoint == s_emptySlot)
+        {
+            slot.codepoint = codepoint;
+            ++_size;
+        }
+        if (slot.codepoint == codepoint)
+        {
+            slot.wide = wide;
+            return;
+        }
+    }
+}
+
+// Routine Description:
+// - forgets everything, but keeps the slots around for the next font
+void CodepointWidthDetector::FallbackCache::Clear() noexcept
+{
+    std::fill(_slots.begin(), _slots.end(), Slot{ s_emptySlot, false });
+    _size = 0;
+}
+
+size_t CodepointWidthDetector::FallbackCache::Size() const noexcept
+{
+    return _size;
+}
+
+// Routine Description:
+// - doubles the number of slots and puts every entry back in its new place
+void CodepointWidthDetector::FallbackCache::_grow()
+{
+    const auto capacity = std::max<size_t>(s_initialCapacity, _slots.size() * 2);
+    auto old = std::exchange(_slots, std::vector<Slot>(capacity, Slot{ s_emptySlot, false }));
+    _size = 0;
+
+    for (const auto& slot : old)
+    {
+        if (slot.codepoint != s_emptySlot)
+        {
+            Insert(slot.codepoint, slot.wide);
+        }
+    }
 }
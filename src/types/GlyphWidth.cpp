@@ -25,6 +25,14 @@ bool IsGlyphFullWidth(const wchar_t wch) noexcept
     return widthDetector.IsWide(wch);
 }
 
+// Function Description:
+// - measures the column widths of every character of the text at once.
+//      See CodepointWidthDetector::GetColumnWidths
+size_t GetGlyphColumnWidths(const std::wstring_view text, std::vector<BYTE>& widths)
+{
+    return widthDetector.GetColumnWidths(text, widths);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
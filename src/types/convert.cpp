@@ -132,8 +132,72 @@ static const WORD leftShiftScanCode = 0x2A;
     return cchTarget;
 }
 
+// Routine Description:
+// - builds a single key event record
+// Arguments:
+// - keyDown - true for a key press, false for a key release
+// - virtualKey - the virtual key code of the key
+// - virtualScanCode - the scan code of the key
+// - wch - the character the key produces
+// - modifiers - the control key state that accompanies the key
+// Return Value:
+// - an INPUT_RECORD holding the key event
+static INPUT_RECORD _MakeKeyRecord(const bool keyDown,
+                                   const WORD virtualKey,
+                                   const WORD virtualScanCode,
+                                   const wchar_t wch,
+                                   const DWORD modifiers) noexcept
+{
+    INPUT_RECORD record{};
+    record.EventType = KEY_EVENT;
+    record.Event.KeyEvent.bKeyDown = keyDown;
+    record.Event.KeyEvent.wRepeatCount = 1;
+    record.Event.KeyEvent.wVirtualKeyCode = virtualKey;
+    record.Event.KeyEvent.wVirtualScanCode = virtualScanCode;
+    record.Event.KeyEvent.uChar.UnicodeChar = wch;
+    record.Event.KeyEvent.dwControlKeyState = modifiers;
+    return record;
+}
+
+// Routine Description:
+// - wraps key event records into KeyEvents
+// Arguments:
+// - records - the key event records to wrap
+// Return Value:
+// - deque of KeyEvents holding the same keys as records
+static std::deque<std::unique_ptr<KeyEvent>> _ToKeyEvents(const std::vector<INPUT_RECORD>& records)
+{
+    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    for (const auto& record : records)
+    {
+        keyEvents.push_back(std::make_unique<KeyEvent>(record.Event.KeyEvent));
+    }
+    return keyEvents;
+}
+
 std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
                                                       const unsigned int codepage)
+{
+    std::vector<INPUT_RECORD> records;
+    CharToKeyRecords(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into the key event records that type it, and appends
+// them to records. Unlike CharToKeyEvents, nothing is allocated per key, so
+// callers converting a lot of text can reuse one vector for all of it.
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage used if the char has to be typed on the numpad
+// - records - the vector the key event records are appended to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void CharToKeyRecords(const wchar_t wch,
+                      const unsigned int codepage,
+                      std::vector<INPUT_RECORD>& records)
 {
     const short invalidKey = -1;
     short keyState = VkKeyScanW(wch);
@@ -152,19 +216,16 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
         }
     }
 
-    std::deque<std::unique_ptr<KeyEvent>> convertedEvents;
     if (keyState == invalidKey)
     {
         // if VkKeyScanW fails (char is not in kbd layout), we must
         // emulate the key being input through the numpad
-        convertedEvents = SynthesizeNumpadEvents(wch, codepage);
+        SynthesizeNumpadRecords(wch, codepage, records);
     }
     else
     {
-        convertedEvents = SynthesizeKeyboardEvents(wch, keyState);
+        SynthesizeKeyboardRecords(wch, keyState, records);
     }
-
-    return convertedEvents;
 }
 
 // Routine Description:
@@ -177,79 +238,91 @@ std::deque<std::unique_ptr<KeyEvent>> CharToKeyEvents(const wchar_t wch,
 // Note:
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch, const short keyState)
+{
+    std::vector<INPUT_RECORD> records;
+    SynthesizeKeyboardRecords(wch, keyState, records);
+    return _ToKeyEvents(records);
+}
+
+// Routine Description:
+// - converts a wchar_t into the key event records that type it on the
+// keyboard, and appends them to records
+// Arguments:
+// - wch - the wchar_t to convert
+// - keyState - the virtual key and modifiers for wch, as VkKeyScanW returns them
+// - records - the vector the key event records are appended to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeKeyboardRecords(const wchar_t wch,
+                               const short keyState,
+                               std::vector<INPUT_RECORD>& records)
 {
     const byte modifierState = HIBYTE(keyState);
 
     bool altGrSet = false;
     bool shiftSet = false;
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
 
     // add modifier key event if necessary
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
         altGrSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
+        records.push_back(_MakeKeyRecord(true,
+                                         static_cast<WORD>(VK_MENU),
+                                         altScanCode,
+                                         UNICODE_NULL,
+                                         (ENHANCED_KEY | LEFT_CTRL_PRESSED | RIGHT_ALT_PRESSED)));
     }
     else if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
         shiftSet = true;
-        keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       SHIFT_PRESSED));
+        records.push_back(_MakeKeyRecord(true,
+                                         static_cast<WORD>(VK_SHIFT),
+                                         leftShiftScanCode,
+                                         UNICODE_NULL,
+                                         SHIFT_PRESSED));
     }
 
     const auto vk = LOBYTE(keyState);
     const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(vk, MAPVK_VK_TO_VSC));
-    KeyEvent keyEvent{ true, 1, LOBYTE(keyState), virtualScanCode, wch, 0 };
 
     // add modifier flags if necessary
+    DWORD modifiers = 0;
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::ShiftPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::Shift);
+        WI_SetFlag(modifiers, SHIFT_PRESSED);
     }
     if (WI_IsFlagSet(modifierState, VkKeyScanModState::CtrlPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::LeftCtrl);
+        WI_SetFlag(modifiers, LEFT_CTRL_PRESSED);
     }
     if (WI_AreAllFlagsSet(modifierState, VkKeyScanModState::CtrlAndAltPressed))
     {
-        keyEvent.ActivateModifierKey(ModifierKeyState::RightAlt);
+        WI_SetFlag(modifiers, RIGHT_ALT_PRESSED);
     }
 
     // add key event down and up
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
-    keyEvent.SetKeyDown(false);
-    keyEvents.push_back(std::make_unique<KeyEvent>(keyEvent));
+    records.push_back(_MakeKeyRecord(true, vk, virtualScanCode, wch, modifiers));
+    records.push_back(_MakeKeyRecord(false, vk, virtualScanCode, wch, modifiers));
 
     // add modifier key up event
     if (altGrSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_MENU),
-                                                       altScanCode,
-                                                       UNICODE_NULL,
-                                                       ENHANCED_KEY));
+        records.push_back(_MakeKeyRecord(false,
+                                         static_cast<WORD>(VK_MENU),
+                                         altScanCode,
+                                         UNICODE_NULL,
+                                         ENHANCED_KEY));
     }
     else if (shiftSet)
     {
-        keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                       1ui16,
-                                                       static_cast<WORD>(VK_SHIFT),
-                                                       leftShiftScanCode,
-                                                       UNICODE_NULL,
-                                                       0));
+        records.push_back(_MakeKeyRecord(false,
+                                         static_cast<WORD>(VK_SHIFT),
+                                         leftShiftScanCode,
+                                         UNICODE_NULL,
+                                         0));
     }
-
-    return keyEvents;
 }
 
 // Routine Description:
@@ -264,19 +337,34 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeKeyboardEvents(const wchar_t wch
 // - will throw exception on error
 std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch, const unsigned int codepage)
 {
-    std::deque<std::unique_ptr<KeyEvent>> keyEvents;
+    std::vector<INPUT_RECORD> records;
+    SynthesizeNumpadRecords(wch, codepage, records);
+    return _ToKeyEvents(records);
+}
 
+// Routine Description:
+// - converts a wchar_t into the key event records that type it using
+// Alt + numpad, and appends them to records
+// Arguments:
+// - wch - the wchar_t to convert
+// - codepage - the codepage whose value for wch is typed on the numpad
+// - records - the vector the key event records are appended to
+// Return Value:
+// - <none>
+// Note:
+// - will throw exception on error
+void SynthesizeNumpadRecords(const wchar_t wch,
+                             const unsigned int codepage,
+                             std::vector<INPUT_RECORD>& records)
+{
     //alt keydown
-    keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   UNICODE_NULL,
-                                                   LEFT_ALT_PRESSED));
-
-    const int radix = 10;
-    std::wstring wstr{ wch };
-    const auto convertedChars = ConvertToA(codepage, wstr);
+    records.push_back(_MakeKeyRecord(true,
+                                     static_cast<WORD>(VK_MENU),
+                                     altScanCode,
+                                     UNICODE_NULL,
+                                     LEFT_ALT_PRESSED));
+
+    const auto convertedChars = ConvertToA(codepage, { &wch, 1 });
     if (convertedChars.size() == 1)
     {
         // It is OK if the char is "signed -1", we want to interpret that as "unsigned 255" for the
@@ -300,29 +388,25 @@ std::deque<std::unique_ptr<KeyEvent>> SynthesizeNumpadEvents(const wchar_t wch,
             const WORD virtualKey = ch - '0' + VK_NUMPAD0;
             const WORD virtualScanCode = gsl::narrow<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
 
-            keyEvents.push_back(std::make_unique<KeyEvent>(true,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
-            keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                           1ui16,
-                                                           virtualKey,
-                                                           virtualScanCode,
-                                                           UNICODE_NULL,
-                                                           LEFT_ALT_PRESSED));
+            records.push_back(_MakeKeyRecord(true,
+                                             virtualKey,
+                                             virtualScanCode,
+                                             UNICODE_NULL,
+                                             LEFT_ALT_PRESSED));
+            records.push_back(_MakeKeyRecord(false,
+                                             virtualKey,
+                                             virtualScanCode,
+                                             UNICODE_NULL,
+                                             LEFT_ALT_PRESSED));
         }
     }
 
     // alt keyup
-    keyEvents.push_back(std::make_unique<KeyEvent>(false,
-                                                   1ui16,
-                                                   static_cast<WORD>(VK_MENU),
-                                                   altScanCode,
-                                                   wch,
-                                                   0));
-    return keyEvents;
+    records.push_back(_MakeKeyRecord(false,
+                                     static_cast<WORD>(VK_MENU),
+                                     altScanCode,
+                                     wch,
+                                     0));
 }
 
 // Routine Description:
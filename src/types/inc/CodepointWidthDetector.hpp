@@ -33,6 +33,7 @@ public:
     CodepointWidth GetWidth(const std::wstring_view glyph) const;
     bool IsWide(const std::wstring_view glyph) const;
     bool IsWide(const wchar_t wch) const noexcept;
+    size_t GetColumnWidths(const std::wstring_view text, std::vector<BYTE>& widths) const;
     void SetFallbackMethod(std::function<bool(const std::wstring_view)> pfnFallback);
     void NotifyFontChanged() const noexcept;
 
@@ -45,6 +46,35 @@ private:
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
 
-    mutable std::map<std::wstring, bool> _fallbackCache;
+    // Remembers what the fallback method said about ambiguous codepoints until the font changes.
+    // It's a flat table of slots keyed by codepoint, found by linear probing from the codepoint's
+    // own position, so a lookup doesn't allocate or chase pointers.
+    class FallbackCache final
+    {
+    public:
+        FallbackCache() noexcept;
+
+        std::optional<bool> Find(const unsigned int codepoint) const noexcept;
+        void Insert(const unsigned int codepoint, const bool wide);
+        void Clear() noexcept;
+        size_t Size() const noexcept;
+
+    private:
+        struct Slot
+        {
+            unsigned int codepoint;
+            bool wide;
+        };
+
+        static constexpr unsigned int s_emptySlot = UINT_MAX; // well past the last codepoint
+        static constexpr size_t s_initialCapacity = 64; // must be a power of 2
+
+        std::vector<Slot> _slots;
+        size_t _size;
+
+        void _grow();
+    };
+
+    mutable FallbackCache _fallbackCache;
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
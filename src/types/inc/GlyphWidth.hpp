@@ -11,8 +11,10 @@ Abstract:
 
 #include <functional>
 #include <string_view>
+#include <vector>
 
 bool IsGlyphFullWidth(const std::wstring_view glyph);
 bool IsGlyphFullWidth(const wchar_t wch) noexcept;
+size_t GetGlyphColumnWidths(const std::wstring_view text, std::vector<BYTE>& widths);
 void SetGlyphWidthFallback(std::function<bool(std::wstring_view)> pfnFallback);
 void NotifyGlyphWidthFontChanged() noexcept;